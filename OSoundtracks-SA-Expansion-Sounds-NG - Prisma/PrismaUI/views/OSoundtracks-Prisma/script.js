@@ -18,6 +18,7 @@ let nowPlayingState = {
 };
 let liveVisibilityTimer = null;
 let lastNowPlayingTrack = '';
+let reportedTrack = '';
 // UI COMPONENTS
 let lastLoadedAuthor = null;
 let isMusicPaused       = false;
@@ -480,9 +481,14 @@ window.updateNowPlaying = function(data) {
                 
                 if (trackInfo && trackInfo.duration) {
                     startProgressSimulation(d.track, trackInfo.duration);
+                    seekProgressSimulation(d.progress);
+                } else {
+                    // No listed duration: the next progress tick starts the simulation.
+                    stopProgressSimulation();
                 }
             }
         }
+        reportedTrack = d.track;
         
         if (d.author && d.system && d.author !== lastLoadedAuthor) {
             findAndSetAlbumImage(d.track, d.author, d.system);
@@ -494,12 +500,48 @@ window.updateNowPlaying = function(data) {
         }
         triggerLiveVisibility(d.track);
     } else {
+        reportedTrack = '';
         stopProgressSimulation();
         setPlayerCover(null);
         onMusicStopped();
     }
 };
 
+// Moves the running simulation to a 0-1 fraction of the track, e.g. when the view opens
+// mid-track.
+function seekProgressSimulation(fraction) {
+    if (!playerState.isPlaying || !(fraction > 0)) return;
+    
+    playerState.currentSeconds = Math.min(Math.floor(fraction * playerState.totalSeconds), playerState.totalSeconds);
+    
+    const currentTimeEl = document.getElementById('playerCurrentTime');
+    const progressFill = document.getElementById('playerProgressFill');
+    
+    if (currentTimeEl) currentTimeEl.textContent = formatTime(playerState.currentSeconds);
+    if (progressFill) progressFill.style.width = Math.min(fraction * 100, 100) + '%';
+}
+
+// Periodic position from the Sound Player; re-syncs the local one-second simulation, or
+// starts it from the reported duration for tracks the track list has no duration for.
+window.updateNowPlayingProgress = function(position, duration) {
+    if (!playerState.isPlaying) {
+        if (!reportedTrack || !(duration > 0)) return;
+        startProgressSimulation(reportedTrack, formatTime(Math.round(duration)));
+        if (!playerState.isPlaying) return;
+    }
+    
+    if (duration > 0) playerState.totalSeconds = Math.round(duration);
+    playerState.currentSeconds = Math.floor(position);
+    
+    const currentTimeEl = document.getElementById('playerCurrentTime');
+    const progressFill = document.getElementById('playerProgressFill');
+    
+    if (currentTimeEl) currentTimeEl.textContent = formatTime(playerState.currentSeconds);
+    if (progressFill && playerState.totalSeconds > 0) {
+        progressFill.style.width = Math.min((playerState.currentSeconds / playerState.totalSeconds) * 100, 100) + '%';
+    }
+};
+
 var gifBtn = null;
 var gifFreeze = null;
 
@@ -1181,6 +1223,9 @@ function refreshLogs() {
     
     if (window.onGetLogs) {
         window.onGetLogs(currentLogFile);
+    } else if (currentLogFile === 'latency') {
+        const content = document.getElementById('logsContent');
+        if (content) content.innerHTML = '<span class="log-warning">Latency stats require the Sound Player. C++ integration required.</span>';
     } else {
         let logPath = 'Assets/Logs/OSoundtracks-Prisma.log';
         if (currentLogFile === 'menus') {
@@ -1,4 +1,5 @@
 #include "PrismaUI_API.h"
+#include "OSoundtracks_API.h"
 #include "bass.h"
 
 #include <windows.h>
@@ -9,6 +10,7 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
@@ -114,6 +116,10 @@ static FnAuthorPreview   g_fnAuthorPreview   = nullptr;
 static FnGetSpecificTrack g_fnGetSpecificTrack = nullptr;
 static FnGetSpecificStatus g_fnGetSpecificStatus = nullptr;
 static FnGetActiveSystem g_fnGetActiveSystem = nullptr;
+static OSoundtracksAPI::GetNowPlayingFn g_fnGetNowPlaying = nullptr;
+static OSoundtracksAPI::RegisterNowPlayingListenerFn g_fnRegisterNowPlayingListener = nullptr;
+static OSoundtracksAPI::GetLatencyStatsFn g_fnGetLatencyStats = nullptr;
+static OSoundtracksAPI::GetVoiceStatsFn g_fnGetVoiceStats = nullptr;
 static bool              g_playerFunctionsLoaded = false;
 
 static PrismaView g_HealingView = 0;
@@ -151,77 +157,144 @@ void LoadSoundPlayerFunctions() {
     g_fnGetSpecificTrack = (FnGetSpecificTrack)GetProcAddress(dll, "OSoundtracks_GetSpecificTrack");
     g_fnGetSpecificStatus = (FnGetSpecificStatus)GetProcAddress(dll, "OSoundtracks_GetSpecificStatus");
     g_fnGetActiveSystem = (FnGetActiveSystem)GetProcAddress(dll, "OSoundtracks_GetActiveSystem");
+    g_fnGetNowPlaying = (OSoundtracksAPI::GetNowPlayingFn)GetProcAddress(dll, "OSoundtracks_GetNowPlaying");
+    g_fnRegisterNowPlayingListener = (OSoundtracksAPI::RegisterNowPlayingListenerFn)GetProcAddress(dll, "OSoundtracks_RegisterNowPlayingListener");
+    g_fnGetLatencyStats = (OSoundtracksAPI::GetLatencyStatsFn)GetProcAddress(dll, "OSoundtracks_GetLatencyStats");
+    g_fnGetVoiceStats = (OSoundtracksAPI::GetVoiceStatsFn)GetProcAddress(dll, "OSoundtracks_GetVoiceStats");
     g_playerFunctionsLoaded = true;
     logger::info("Sound-Player functions loaded");
 }
 
-static std::atomic<bool> g_nowPlayingTimerActive{false};
-static std::thread g_nowPlayingThread;
-static bool g_isShuttingDown = false;
-
 static std::string g_lastTrack, g_lastAuthor, g_lastSystem;
 static int g_lastStatus = -1;
 
 // NOW PLAYING LOGIC
+// The Sound Player calls OnNowPlayingChanged from its notifier thread whenever a track,
+// status or active system changes, plus a low-rate progress tick while something plays.
+// Nothing polls the Sound Player. The DOM-ready push runs on another thread, so both
+// paths update the g_last* fields and invoke the view under g_nowPlayingMutex.
+static std::mutex g_nowPlayingMutex;
+static bool g_nowPlayingSubscribed = false;
+
+const char* NowPlayingStatusText(int status) {
+    if (status == OSoundtracksAPI::kPlaying) return "playing";
+    if (status == OSoundtracksAPI::kPaused) return "paused";
+    return "stopped";
+}
+
+// The channel the view follows for the active system, or nullptr when nothing plays.
+const OSoundtracksAPI::ChannelState* NowPlayingChannel(const OSoundtracksAPI::NowPlaying& state, std::string& systemStr) {
+    if (state.activeSystem == OSoundtracksAPI::kSystemSoundMenuKey) {
+        systemStr = "SoundMenuKey";
+        return &state.channels[OSoundtracksAPI::kChannelSoundMenuKey];
+    }
+    if (state.activeSystem == OSoundtracksAPI::kSystemSoundKey) {
+        systemStr = "SoundKey";
+        const auto* specific = &state.channels[OSoundtracksAPI::kChannelSpecific];
+        return specific->status != OSoundtracksAPI::kStopped ? specific : &state.channels[OSoundtracksAPI::kChannelBase];
+    }
+    systemStr = "none";
+    return nullptr;
+}
+
+// Caller holds g_nowPlayingMutex.
+void InvokeNowPlaying(const std::string& trackStr, const std::string& authorStr, const std::string& statusText,
+                      const std::string& systemStr, float progress) {
+    if (trackStr != g_lastTrack || authorStr != g_lastAuthor || 
+        systemStr != g_lastSystem || statusText != NowPlayingStatusText(g_lastStatus)) {
+        logger::info("[NowPlaying] {}, track='{}', author='{}', system='{}'",
+            statusText, trackStr, authorStr, systemStr);
+    }
+
+    std::stringstream ss;
+    ss << "updateNowPlaying({\"track\":\"" << trackStr
+       << "\",\"author\":\"" << authorStr
+       << "\",\"status\":\"" << statusText
+       << "\",\"system\":\"" << systemStr
+       << "\",\"progress\":" << progress << "})";
+    PrismaUI->Invoke(g_HealingView, ss.str().c_str());
+}
+
+void OnNowPlayingChanged(const OSoundtracksAPI::NowPlaying* state, uint32_t events, void*) {
+    if (!g_HealingView || !state || state->version != OSoundtracksAPI::kNowPlayingVersion) return;
+
+    std::lock_guard<std::mutex> lock(g_nowPlayingMutex);
+    std::string systemStr;
+    const OSoundtracksAPI::ChannelState* channel = NowPlayingChannel(*state, systemStr);
+    int status = channel ? channel->status : OSoundtracksAPI::kStopped;
+    float position = channel ? channel->position : 0.0f;
+    float duration = channel ? channel->duration : 0.0f;
+
+    if (events & (OSoundtracksAPI::kEventTrack | OSoundtracksAPI::kEventStatus | OSoundtracksAPI::kEventSystem)) {
+        std::string trackStr = channel ? channel->track : "";
+        std::string authorStr = channel ? channel->author : "";
+        InvokeNowPlaying(trackStr, authorStr, NowPlayingStatusText(status), systemStr,
+                         duration > 0.0f ? position / duration : 0.0f);
+        g_lastTrack = trackStr;
+        g_lastAuthor = authorStr;
+        g_lastSystem = systemStr;
+        g_lastStatus = status;
+        return;
+    }
+
+    if ((events & OSoundtracksAPI::kEventProgress) && status == OSoundtracksAPI::kPlaying) {
+        std::stringstream ss;
+        ss << "updateNowPlayingProgress(" << position << "," << duration << ")";
+        PrismaUI->Invoke(g_HealingView, ss.str().c_str());
+    }
+}
+
+// Pushes the current state once, e.g. when the view's DOM (re)loads. Sound Player
+// builds without the snapshot export are read through the per-field getters.
 void SendNowPlayingToJS() {
     if (!g_HealingView || !g_playerFunctionsLoaded) return;
 
+    if (g_fnGetNowPlaying) {
+        OSoundtracksAPI::NowPlaying snapshot{};
+        if (g_fnGetNowPlaying(&snapshot)) {
+            OnNowPlayingChanged(&snapshot, OSoundtracksAPI::kEventTrack | OSoundtracksAPI::kEventStatus |
+                                           OSoundtracksAPI::kEventSystem, nullptr);
+        }
+        return;
+    }
+
     const char* system = g_fnGetActiveSystem ? g_fnGetActiveSystem() : "none";
     std::string systemStr(system ? system : "none");
 
     std::string trackStr, authorStr;
     int status = 0;
-    std::string statusText = "stopped";
 
     if (systemStr == "SoundMenuKey") {
         const char* t = g_fnGetMenuTrack ? g_fnGetMenuTrack() : "";
         const char* a = g_fnGetMenuAuthor ? g_fnGetMenuAuthor() : "";
-        int s = g_fnGetMenuStatus ? g_fnGetMenuStatus() : 0;
         trackStr = t ? t : "";
         authorStr = a ? a : "";
-        status = s;
-        statusText = (status == 1) ? "playing" : "paused";
+        status = g_fnGetMenuStatus ? g_fnGetMenuStatus() : 0;
     } else if (systemStr == "SoundKey") {
         const char* t = g_fnGetSpecificTrack ? g_fnGetSpecificTrack() : "";
-        int s = g_fnGetSpecificStatus ? g_fnGetSpecificStatus() : 0;
         trackStr = t ? t : "";
-        status = s;
-        statusText = (status == 1) ? "playing" : "paused";
-    }
-
-    if (trackStr != g_lastTrack || authorStr != g_lastAuthor || 
-        systemStr != g_lastSystem || status != g_lastStatus) {
-        logger::info("[NowPlaying] {}, track='{}', author='{}', system='{}'",
-            statusText, trackStr, authorStr, systemStr);
-        g_lastTrack = trackStr;
-        g_lastAuthor = authorStr;
-        g_lastSystem = systemStr;
-        g_lastStatus = status;
+        status = g_fnGetSpecificStatus ? g_fnGetSpecificStatus() : 0;
     }
 
-    std::stringstream ss;
-    ss << "updateNowPlaying({\"track\":\"" << trackStr
-       << "\",\"author\":\"" << authorStr
-       << "\",\"status\":\"" << statusText
-       << "\",\"system\":\"" << systemStr << "\"})";
-    PrismaUI->Invoke(g_HealingView, ss.str().c_str());
+    float progress = (systemStr == "SoundMenuKey" && g_fnGetMenuProgress) ? g_fnGetMenuProgress() : 0.0f;
+    std::lock_guard<std::mutex> lock(g_nowPlayingMutex);
+    InvokeNowPlaying(trackStr, authorStr, NowPlayingStatusText(status), systemStr, progress);
+    g_lastTrack = trackStr;
+    g_lastAuthor = authorStr;
+    g_lastSystem = systemStr;
+    g_lastStatus = status;
 }
 
-void StartNowPlayingTimer() {
-    if (g_nowPlayingTimerActive.load()) return;
-    g_nowPlayingTimerActive = true;
-    g_nowPlayingThread = std::thread([]() {
-        while (g_nowPlayingTimerActive.load() && !g_isShuttingDown) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            if (g_HealingView && g_playerFunctionsLoaded) SendNowPlayingToJS();
-        }
-    });
-    g_nowPlayingThread.detach();
-    logger::info("Now Playing timer started (500ms)");
+void SubscribeNowPlaying() {
+    if (g_nowPlayingSubscribed || !g_playerFunctionsLoaded) return;
+    if (!g_fnRegisterNowPlayingListener) {
+        logger::warn("Sound-Player has no now-playing notifications; the player panel updates when the view opens");
+        return;
+    }
+    g_nowPlayingSubscribed = g_fnRegisterNowPlayingListener(OnNowPlayingChanged, nullptr);
+    logger::info("Now Playing notifications {}", g_nowPlayingSubscribed ? "subscribed" : "unavailable");
 }
 
-void StopNowPlayingTimer() { g_nowPlayingTimerActive = false; }
-
 // PLUGIN CONFIGURATION
 struct PluginConfig
 {
@@ -5323,6 +5396,139 @@ void OnSaveNowPlayingConfig(const char* data) {
     SaveConfig();
 }
 
+// Sound Player tail logs (*.ringlog): 64-byte header {magic "OSRL", version, slotSize,
+// capacity, head} then capacity slots of {uint16 length, text}. head counts every record
+// ever written, so the oldest live record is head - capacity. The writer keeps the file
+// mapped and may append while we read. While it writes record head, that record's slot
+// still holds head - capacity, so after re-reading head we only trust records from
+// head - capacity + 1 on; older ones may be overwritten or half-written.
+std::string ReadTailLog(const fs::path &path)
+{
+    struct TailLogHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slotSize;
+        uint32_t capacity;
+        uint64_t head;
+        uint8_t reserved[40];
+    };
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return std::string();
+
+    TailLogHeader header{};
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.magic != 0x4C52534F ||
+        header.version != 1 || header.capacity == 0 || header.slotSize <= sizeof(uint16_t))
+        return std::string();
+
+    std::vector<char> slots(static_cast<size_t>(header.capacity) * header.slotSize);
+    if (!file.read(slots.data(), static_cast<std::streamsize>(slots.size())))
+        return std::string();
+
+    TailLogHeader after{};
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(&after), sizeof(after));
+    uint64_t oldestIntact = after.head >= header.capacity ? after.head - header.capacity + 1 : 0;
+
+    uint64_t first = header.head > header.capacity ? header.head - header.capacity : 0;
+    std::string rendered;
+    for (uint64_t index = std::max(first, oldestIntact); index < header.head; ++index)
+    {
+        const char *slot = slots.data() + (index % header.capacity) * header.slotSize;
+        uint16_t length = 0;
+        std::memcpy(&length, slot, sizeof(length));
+        length = static_cast<uint16_t>(std::min<size_t>(length, header.slotSize - sizeof(uint16_t)));
+        rendered.append(slot + sizeof(uint16_t), length);
+        rendered += '\n';
+    }
+    return rendered;
+}
+
+// Appended to the Latency tab when the Sound Player reports its voice budget.
+std::string FormatVoiceStats()
+{
+    OSoundtracksAPI::VoiceStats voices{};
+    if (!g_fnGetVoiceStats || !g_fnGetVoiceStats(&voices) || voices.version != OSoundtracksAPI::kVoiceStatsVersion)
+    {
+        return "";
+    }
+
+    char line[200];
+    std::string limit = voices.maxVoices ? std::to_string(voices.maxVoices) : std::string("unlimited");
+    std::snprintf(line, sizeof(line),
+                  "\nVoices: %u active / %s (peak %u), %llu stolen, %llu starts refused, decode CPU %.1f%%\n",
+                  voices.activeVoices, limit.c_str(), voices.peakVoices,
+                  static_cast<unsigned long long>(voices.stolenVoices),
+                  static_cast<unsigned long long>(voices.refusedStarts), voices.decodeCpuPercent);
+    return line;
+}
+
+// Latency tab: the Sound Player's transition histograms, one row per stage, in ms.
+std::string FormatLatencyStats()
+{
+    LoadSoundPlayerFunctions();
+
+    OSoundtracksAPI::LatencyStats stats{};
+    if (!g_fnGetLatencyStats || !g_fnGetLatencyStats(&stats) || stats.version != OSoundtracksAPI::kLatencyStatsVersion)
+    {
+        return "[INFO] Latency stats are not available. They need a Sound Player that exports OSoundtracks_GetLatencyStats.\n";
+    }
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "Transition latency over the last %llu min (ms)\n",
+                  static_cast<unsigned long long>(stats.sinceMicros / 60000000));
+    std::string table = line;
+    std::snprintf(line, sizeof(line), "%-24s %8s %9s %9s %9s %9s %9s\n", "stage", "count", "mean", "p50", "p90",
+                  "p99", "max");
+    table += line;
+
+    uint32_t stageCount = std::min(stats.stageCount, OSoundtracksAPI::kLatencyStageCount);
+    for (uint32_t i = 0; i < stageCount; ++i)
+    {
+        const auto &stage = stats.stages[i];
+        double mean = stage.count ? static_cast<double>(stage.totalMicros) / stage.count / 1000.0 : 0.0;
+        std::snprintf(line, sizeof(line), "%-24s %8llu %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                      OSoundtracksAPI::kLatencyStageNames[i], static_cast<unsigned long long>(stage.count), mean,
+                      stage.p50Micros / 1000.0, stage.p90Micros / 1000.0, stage.p99Micros / 1000.0,
+                      stage.maxMicros / 1000.0);
+        table += line;
+    }
+    return table + FormatVoiceStats();
+}
+
+void SendLogsContent(const std::string &logContent)
+{
+    std::string escapedContent;
+    for (char c : logContent)
+    {
+        switch (c)
+        {
+        case '\\':
+            escapedContent += "\\\\";
+            break;
+        case '"':
+            escapedContent += "\\\"";
+            break;
+        case '\n':
+            escapedContent += "\\n";
+            break;
+        case '\r':
+            escapedContent += "\\r";
+            break;
+        case '\t':
+            escapedContent += "\\t";
+            break;
+        default:
+            escapedContent += c;
+        }
+    }
+
+    std::string script = "window.updateLogsContent(\"" + escapedContent + "\")";
+    PrismaUI->Invoke(g_HealingView, script.c_str());
+}
+
 void OnGetLogs(const char *data)
 {
     
@@ -5336,11 +5542,26 @@ void OnGetLogs(const char *data)
         return;
     }
 
+    if (logType == "latency")
+    {
+        SendLogsContent(FormatLatencyStats());
+        return;
+    }
+
     
     std::string docsPath = GetDocumentsPath();
     fs::path logPath;
 
-    if (logType == "menus")
+    if (logType == "actions")
+    {
+        logPath = fs::path(docsPath) / "My Games" / "Skyrim Special Edition" / "SKSE" / "OSoundtracks-SA-Expansion-Sounds-NG-Actions.ringlog";
+
+        if (!fs::exists(logPath))
+        {
+            logPath = fs::path(docsPath) / "My Games" / "Skyrim.INI" / "SKSE" / "OSoundtracks-SA-Expansion-Sounds-NG-Actions.ringlog";
+        }
+    }
+    else if (logType == "menus")
     {
         
         logPath = fs::path(docsPath) / "My Games" / "Skyrim Special Edition" / "SKSE" / "OSoundtracks-Prisma-Menus.log";
@@ -5363,9 +5584,14 @@ void OnGetLogs(const char *data)
 
     
     std::string logContent;
-    std::ifstream logFile(logPath);
+    std::ifstream logFile;
+
+    if (logType != "actions")
+    {
+        logFile.open(logPath);
+    }
 
-    if (!logFile.is_open())
+    if (logType != "actions" && !logFile.is_open())
     {
         logger::warn("OnGetLogs: Could not open log file: {}", logPath.string());
         
@@ -5382,7 +5608,16 @@ void OnGetLogs(const char *data)
         logFile.open(assetsLogPath);
     }
 
-    if (logFile.is_open())
+    if (logType == "actions")
+    {
+        logContent = ReadTailLog(logPath);
+        if (logContent.empty())
+        {
+            logContent = "[INFO] Actions log not found. It will appear here once the Sound Player is running.\n";
+            logContent += "[INFO] Expected path: " + logPath.string();
+        }
+    }
+    else if (logFile.is_open())
     {
         
         std::vector<std::string> lines;
@@ -5410,35 +5645,7 @@ void OnGetLogs(const char *data)
         logContent += "[INFO] Expected path: " + logPath.string();
     }
 
-    
-    std::string escapedContent;
-    for (char c : logContent)
-    {
-        switch (c)
-        {
-        case '\\':
-            escapedContent += "\\\\";
-            break;
-        case '"':
-            escapedContent += "\\\"";
-            break;
-        case '\n':
-            escapedContent += "\\n";
-            break;
-        case '\r':
-            escapedContent += "\\r";
-            break;
-        case '\t':
-            escapedContent += "\\t";
-            break;
-        default:
-            escapedContent += c;
-        }
-    }
-
-    
-    std::string script = "window.updateLogsContent(\"" + escapedContent + "\")";
-    PrismaUI->Invoke(g_HealingView, script.c_str());
+    SendLogsContent(logContent);
 }
 
 class InputEventHandler : public RE::BSTEventSink<RE::InputEvent *>
@@ -5691,6 +5898,7 @@ void InitializePrismaUI()
     g_HealingView = PrismaUI->CreateView("OSoundtracks-Prisma/index.html", [](PrismaView view)
                                          {
                                              logger::info("Healing view DOM ready: {}", view);
+                                             SendNowPlayingToJS();
 
                                               UpdateUIStats();
                                               LoadAndSendAuthors();
@@ -5774,7 +5982,7 @@ PrismaUI->RegisterJSListener(view, "onGetItemsConfig", OnGetItemsConfig);
     
     
     LoadSoundPlayerFunctions();
-    StartNowPlayingTimer();
+    SubscribeNowPlaying();
 
     if (g_HealingView)
     {
@@ -0,0 +1,831 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "GainStage.h"
+
+// Playback interface between the Sound Player logic and whatever produces sound. The
+// plugin uses the BASS implementation in plugin.cpp; NullAudioBackend and
+// OfflineAudioBackend below depend only on the standard library, so the playback logic
+// can run headless (benchmarks, Linux test harnesses, renders to a WAV file).
+//
+// Handles are plain integers and 0 always means "none". Stream handles returned by
+// OpenStream, SampleChannel and OpenDecoder are freed with Free; samples with FreeSample.
+
+using AudioHandle = uint32_t;
+using AudioSample = uint32_t;
+
+// Called when a sync set with SyncAt/SyncEnd fires. BASS calls it on its mixer thread,
+// the offline renderer on its render thread; either way the backend may be re-entered.
+using AudioSyncProc = void (*)(AudioHandle handle);
+
+enum class AudioActivity { Stopped, Playing, Paused, Stalled };
+
+struct AudioSampleInfo {
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+};
+
+struct AudioFormat {
+    uint32_t sampleRate = 0;
+    uint32_t channels = 0;
+};
+
+class IAudioBackend {
+public:
+    virtual ~IAudioBackend() = default;
+
+    virtual const char* Name() const = 0;
+    virtual bool Initialize() = 0;
+    virtual void Shutdown() = 0;
+    virtual int LastError() const = 0;
+
+    // Streams
+    virtual AudioHandle OpenStream(const std::filesystem::path& file, bool loop) = 0;
+    virtual void Free(AudioHandle handle) = 0;
+    virtual bool Play(AudioHandle handle) = 0;
+    virtual void Pause(AudioHandle handle) = 0;
+    virtual void Stop(AudioHandle handle) = 0;
+    virtual AudioActivity Activity(AudioHandle handle) const = 0;
+    // Channel level from the volume settings (0-2), applied by the stream's GainStage:
+    // ramped instead of stepped and limited below full scale. SetVolume and SlideVolume
+    // multiply on top of it and are meant for fades (0-1).
+    virtual void SetLevel(AudioHandle handle, float level) = 0;
+    // Per-track gain multiplied into the level (loudness normalization); set before Play.
+    virtual void SetTrim(AudioHandle handle, float trim) = 0;
+    virtual void SetVolume(AudioHandle handle, float volume) = 0;
+    virtual void SlideVolume(AudioHandle handle, float volume, uint32_t durationMs) = 0;
+    // Ramps to silence, then stops and frees the handle without further calls.
+    virtual void FadeOutAndFree(AudioHandle handle, uint32_t durationMs) = 0;
+    // Ramps to silence, then pauses. Play plus a slide back up before the ramp ends
+    // cancels the pause; the handle keeps playing from where it is.
+    virtual void FadeOutAndPause(AudioHandle handle, uint32_t durationMs) = 0;
+    virtual void SetLooping(AudioHandle handle, bool loop) = 0;
+    virtual double Length(AudioHandle handle) const = 0;    // seconds; negative if unknown
+    virtual double Position(AudioHandle handle) const = 0;  // seconds; negative if unknown
+    // Fills the playback buffer ahead of Play so a later start has no decode latency.
+    virtual void Prebuffer(AudioHandle handle) = 0;
+
+    // One-shot syncs: at a playback position, or when a non-looping stream runs out
+    // (timed so that a stream started from the callback follows without a gap).
+    virtual bool SyncAt(AudioHandle handle, double seconds, AudioSyncProc proc) = 0;
+    virtual bool SyncEnd(AudioHandle handle, AudioSyncProc proc) = 0;
+
+    // Short clips decoded once into memory
+    virtual AudioSample LoadSample(const std::filesystem::path& file, AudioSampleInfo& info) = 0;
+    virtual AudioHandle SampleChannel(AudioSample sample, bool loop) = 0;
+    virtual bool SampleInUse(AudioSample sample) const = 0;
+    virtual void FreeSample(AudioSample sample) = 0;
+
+    // Decode-only streams producing interleaved float PCM in the file's own format.
+    // Decode returns the number of frames written; 0 at the end of the file.
+    virtual AudioHandle OpenDecoder(const std::filesystem::path& file, AudioFormat& format) = 0;
+    virtual size_t Decode(AudioHandle handle, float* out, size_t frames) = 0;
+
+    // Share of one CPU spent mixing and decoding for playback, in percent; 0 if unknown.
+    // Backends that measure over a window restart it here, so it has a single caller.
+    virtual float TakeCpuPercent() = 0;
+};
+
+// ========================================
+// Null Backend
+// ========================================
+// Accepts everything and produces nothing. Streams report the state their calls would
+// leave them in, but never advance, end or fire syncs.
+class NullAudioBackend : public IAudioBackend {
+public:
+    const char* Name() const override { return "null"; }
+    bool Initialize() override { return true; }
+    void Shutdown() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        streams.clear();
+    }
+    int LastError() const override { return 0; }
+
+    AudioHandle OpenStream(const std::filesystem::path&, bool) override { return Add(); }
+    void Free(AudioHandle handle) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        streams.erase(handle);
+    }
+    bool Play(AudioHandle handle) override { return Set(handle, AudioActivity::Playing); }
+    void Pause(AudioHandle handle) override { Set(handle, AudioActivity::Paused); }
+    void Stop(AudioHandle handle) override { Set(handle, AudioActivity::Stopped); }
+    AudioActivity Activity(AudioHandle handle) const override {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = streams.find(handle);
+        return it != streams.end() ? it->second : AudioActivity::Stopped;
+    }
+    void SetLevel(AudioHandle, float) override {}
+    void SetTrim(AudioHandle, float) override {}
+    void SetVolume(AudioHandle, float) override {}
+    void SlideVolume(AudioHandle, float, uint32_t) override {}
+    void FadeOutAndFree(AudioHandle handle, uint32_t) override { Free(handle); }
+    void FadeOutAndPause(AudioHandle handle, uint32_t) override { Pause(handle); }
+    void SetLooping(AudioHandle, bool) override {}
+    double Length(AudioHandle) const override { return -1.0; }
+    double Position(AudioHandle) const override { return -1.0; }
+    void Prebuffer(AudioHandle) override {}
+
+    bool SyncAt(AudioHandle, double, AudioSyncProc) override { return true; }
+    bool SyncEnd(AudioHandle, AudioSyncProc) override { return true; }
+
+    AudioSample LoadSample(const std::filesystem::path&, AudioSampleInfo&) override { return 0; }
+    AudioHandle SampleChannel(AudioSample, bool) override { return 0; }
+    bool SampleInUse(AudioSample) const override { return false; }
+    void FreeSample(AudioSample) override {}
+
+    AudioHandle OpenDecoder(const std::filesystem::path&, AudioFormat&) override { return 0; }
+    size_t Decode(AudioHandle, float*, size_t) override { return 0; }
+    float TakeCpuPercent() override { return 0.0f; }
+
+private:
+    AudioHandle Add() {
+        std::lock_guard<std::mutex> lock(mutex);
+        AudioHandle handle = ++nextHandle;
+        streams[handle] = AudioActivity::Stopped;
+        return handle;
+    }
+
+    bool Set(AudioHandle handle, AudioActivity activity) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = streams.find(handle);
+        if (it == streams.end()) return false;
+        it->second = activity;
+        return true;
+    }
+
+    mutable std::mutex mutex;
+    std::unordered_map<AudioHandle, AudioActivity> streams;
+    AudioHandle nextHandle = 0;
+};
+
+// ========================================
+// Offline Renderer
+// ========================================
+// Mixes every playing stream into a stereo float WAV file. Rendering is split at the
+// exact frame of each sync, volume slides are linear per frame like BASS's default, and
+// a stream started from an end sync begins on the frame after the previous one ended,
+// so transitions, crossfades and volume curves can be checked sample by sample. Each
+// voice runs through the same GainStage as under BASS. While its limiter is engaged
+// (level above 1) the output trails the source by the look-ahead; the voice then plays
+// on for that long past its last frame to flush the delay, and its syncs fire late by
+// the same amount, so they still line up with what is heard.
+//
+// With realtime = true a pump thread renders as wall-clock time passes (what the plugin
+// uses); with realtime = false nothing advances until Render() is called, which lets a
+// test drive the clock. WAV files are decoded natively (PCM 8/16/24/32, float 32);
+// other formats need a decoder backend, e.g. an initialized BASS backend.
+class OfflineAudioBackend : public IAudioBackend {
+public:
+    static constexpr uint32_t kOutputChannels = 2;
+    static constexpr int kErrorFile = 2;
+    static constexpr int kErrorFormat = 41;
+    static constexpr int kErrorHandle = 5;
+
+    OfflineAudioBackend(std::filesystem::path outputFile, uint32_t sampleRate = 44100, bool realtime = true,
+                        IAudioBackend* decoder = nullptr)
+        : outputFile(std::move(outputFile)), sampleRate(sampleRate), realtime(realtime), decoder(decoder) {}
+
+    ~OfflineAudioBackend() override { Shutdown(); }
+
+    const char* Name() const override { return "offline"; }
+
+    bool Initialize() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (output.is_open()) return true;
+
+        output.open(outputFile, std::ios::binary | std::ios::trunc);
+        if (!output.is_open()) {
+            lastError = kErrorFile;
+            return false;
+        }
+        WriteWavHeader();
+        framesWritten = 0;
+        renderedFrames = 0;
+
+        if (realtime) {
+            pumpActive = true;
+            pumpThread = std::thread([this] { PumpThreadFunction(); });
+        }
+        return true;
+    }
+
+    void Shutdown() override {
+        if (pumpActive.exchange(false) && pumpThread.joinable()) {
+            pumpThread.join();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (output.is_open()) {
+            WriteWavHeader();
+            output.close();
+        }
+        voices.clear();
+        samples.clear();
+    }
+
+    int LastError() const override { return lastError.load(); }
+
+    // Advances the clock by the given number of output frames, firing syncs on the way.
+    void Render(size_t frames) {
+        std::vector<float> block;
+        while (frames > 0) {
+            std::vector<std::pair<AudioSyncProc, AudioHandle>> fired;
+            size_t step = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                step = std::min(frames, FramesUntilNextEvent());
+                block.assign(step * kOutputChannels, 0.0f);
+                auto mixStart = std::chrono::steady_clock::now();
+                MixLocked(block.data(), step, fired);
+                mixSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - mixStart).count();
+                mixFrames += step;
+                if (output.is_open()) {
+                    output.write(reinterpret_cast<const char*>(block.data()),
+                                 static_cast<std::streamsize>(block.size() * sizeof(float)));
+                    framesWritten += step;
+                }
+                renderedFrames += step;
+            }
+            // Outside the lock: callbacks usually start or stop streams.
+            for (const auto& [proc, handle] : fired) proc(handle);
+            frames -= step;
+        }
+    }
+
+    // Total output frames rendered so far (the renderer's clock).
+    uint64_t RenderedFrames() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return renderedFrames;
+    }
+
+    uint32_t SampleRate() const { return sampleRate; }
+
+    // Mixing time over the audio time it produced, since the previous call.
+    float TakeCpuPercent() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        float percent = mixFrames ? static_cast<float>(mixSeconds * sampleRate / mixFrames * 100.0) : 0.0f;
+        mixSeconds = 0.0;
+        mixFrames = 0;
+        return percent;
+    }
+
+    AudioHandle OpenStream(const std::filesystem::path& file, bool loop) override {
+        auto clip = LoadClip(file);
+        if (!clip) return 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return AddVoiceLocked(std::move(clip), loop, 0);
+    }
+
+    void Free(AudioHandle handle) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        voices.erase(handle);
+    }
+
+    bool Play(AudioHandle handle) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        Voice* voice = FindLocked(handle);
+        if (!voice || voice->decoder) return false;
+        if (voice->state == AudioActivity::Stopped && voice->cursor >= voice->clip->frames) voice->cursor = 0.0;
+        voice->state = AudioActivity::Playing;
+        voice->pauseAfterSlide = false;
+        return true;
+    }
+
+    void Pause(AudioHandle handle) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Voice* voice = FindLocked(handle); voice && voice->state == AudioActivity::Playing) {
+            voice->state = AudioActivity::Paused;
+        }
+    }
+
+    void Stop(AudioHandle handle) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Voice* voice = FindLocked(handle)) voice->state = AudioActivity::Stopped;
+    }
+
+    AudioActivity Activity(AudioHandle handle) const override {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = voices.find(handle);
+        return it != voices.end() ? it->second.state : AudioActivity::Stopped;
+    }
+
+    void SetLevel(AudioHandle handle, float level) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Voice* voice = FindLocked(handle)) voice->gain.SetLevel(level);
+    }
+
+    void SetTrim(AudioHandle handle, float trim) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Voice* voice = FindLocked(handle)) voice->gain.SetTrim(trim);
+    }
+
+    void SetVolume(AudioHandle handle, float volume) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Voice* voice = FindLocked(handle)) {
+            voice->volume = std::max(volume, 0.0f);
+            voice->slideFrames = 0;
+        }
+    }
+
+    void SlideVolume(AudioHandle handle, float volume, uint32_t durationMs) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Voice* voice = FindLocked(handle)) StartSlideLocked(*voice, std::max(volume, 0.0f), durationMs);
+    }
+
+    void FadeOutAndFree(AudioHandle handle, uint32_t durationMs) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        Voice* voice = FindLocked(handle);
+        if (!voice) return;
+        if (durationMs == 0 || voice->state != AudioActivity::Playing) {
+            voices.erase(handle);
+            return;
+        }
+        voice->freeAfterSlide = true;
+        StartSlideLocked(*voice, 0.0f, durationMs);
+    }
+
+    void FadeOutAndPause(AudioHandle handle, uint32_t durationMs) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        Voice* voice = FindLocked(handle);
+        if (!voice || voice->state != AudioActivity::Playing) return;
+        if (durationMs == 0) {
+            voice->state = AudioActivity::Paused;
+            return;
+        }
+        voice->pauseAfterSlide = true;
+        StartSlideLocked(*voice, 0.0f, durationMs);
+    }
+
+    void SetLooping(AudioHandle handle, bool loop) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Voice* voice = FindLocked(handle)) voice->loop = loop;
+    }
+
+    double Length(AudioHandle handle) const override {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = voices.find(handle);
+        if (it == voices.end()) return -1.0;
+        return static_cast<double>(it->second.clip->frames) / it->second.clip->sampleRate;
+    }
+
+    double Position(AudioHandle handle) const override {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = voices.find(handle);
+        if (it == voices.end()) return -1.0;
+        return std::min(it->second.cursor, static_cast<double>(it->second.clip->frames)) / it->second.clip->sampleRate;
+    }
+
+    void Prebuffer(AudioHandle) override {}
+
+    bool SyncAt(AudioHandle handle, double seconds, AudioSyncProc proc) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        Voice* voice = FindLocked(handle);
+        if (!voice || !proc) return false;
+        double frame = std::clamp(seconds * voice->clip->sampleRate, 0.0, static_cast<double>(voice->clip->frames));
+        voice->syncs.push_back({frame, proc, false});
+        return true;
+    }
+
+    bool SyncEnd(AudioHandle handle, AudioSyncProc proc) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        Voice* voice = FindLocked(handle);
+        if (!voice || !proc) return false;
+        voice->syncs.push_back({static_cast<double>(voice->clip->frames), proc, true});
+        return true;
+    }
+
+    AudioSample LoadSample(const std::filesystem::path& file, AudioSampleInfo& info) override {
+        auto clip = LoadClip(file);
+        if (!clip) return 0;
+
+        info.bytes = clip->data.size() * sizeof(float);
+        info.seconds = static_cast<double>(clip->frames) / clip->sampleRate;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        AudioSample sample = ++nextSample;
+        samples[sample] = std::move(clip);
+        return sample;
+    }
+
+    AudioHandle SampleChannel(AudioSample sample, bool loop) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = samples.find(sample);
+        if (it == samples.end()) {
+            lastError = kErrorHandle;
+            return 0;
+        }
+        return AddVoiceLocked(it->second, loop, sample);
+    }
+
+    bool SampleInUse(AudioSample sample) const override {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [handle, voice] : voices) {
+            if (voice.sample == sample) return true;
+        }
+        return false;
+    }
+
+    void FreeSample(AudioSample sample) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        samples.erase(sample);
+    }
+
+    AudioHandle OpenDecoder(const std::filesystem::path& file, AudioFormat& format) override {
+        auto clip = LoadClip(file);
+        if (!clip) return 0;
+
+        format.sampleRate = clip->sampleRate;
+        format.channels = clip->channels;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        AudioHandle handle = AddVoiceLocked(std::move(clip), false, 0);
+        voices[handle].decoder = true;
+        return handle;
+    }
+
+    size_t Decode(AudioHandle handle, float* out, size_t frames) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        Voice* voice = FindLocked(handle);
+        if (!voice || !voice->decoder) return 0;
+
+        size_t start = static_cast<size_t>(voice->cursor);
+        size_t count = std::min(frames, voice->clip->frames - std::min(start, voice->clip->frames));
+        std::memcpy(out, voice->clip->data.data() + start * voice->clip->channels,
+                    count * voice->clip->channels * sizeof(float));
+        voice->cursor += static_cast<double>(count);
+        return count;
+    }
+
+private:
+    struct Clip {
+        std::vector<float> data;  // interleaved
+        uint32_t channels = 0;
+        uint32_t sampleRate = 0;
+        size_t frames = 0;
+    };
+
+    struct Sync {
+        double frame;  // in source frames
+        AudioSyncProc proc;
+        bool atEnd;
+    };
+
+    struct Voice {
+        std::shared_ptr<const Clip> clip;
+        AudioSample sample = 0;
+        AudioActivity state = AudioActivity::Stopped;
+        double cursor = 0.0;  // in source frames
+        float volume = 1.0f;
+        float slideTarget = 0.0f;
+        float slideStep = 0.0f;
+        uint64_t slideFrames = 0;  // output frames left in the current slide
+        bool freeAfterSlide = false;
+        bool pauseAfterSlide = false;
+        bool loop = false;
+        bool decoder = false;
+        std::vector<Sync> syncs;
+        GainStage gain;
+    };
+
+    AudioHandle AddVoiceLocked(std::shared_ptr<const Clip> clip, bool loop, AudioSample sample) {
+        AudioHandle handle = ++nextHandle;
+        Voice& voice = voices[handle];
+        voice.clip = std::move(clip);
+        voice.loop = loop;
+        voice.sample = sample;
+        voice.gain.Prepare(sampleRate, kOutputChannels);
+        return handle;
+    }
+
+    Voice* FindLocked(AudioHandle handle) {
+        auto it = voices.find(handle);
+        if (it == voices.end()) {
+            lastError = kErrorHandle;
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    void StartSlideLocked(Voice& voice, float target, uint32_t durationMs) {
+        uint64_t frames = static_cast<uint64_t>(durationMs) * sampleRate / 1000;
+        if (frames == 0) {
+            voice.volume = target;
+            voice.slideFrames = 0;
+            return;
+        }
+        voice.slideTarget = target;
+        voice.slideFrames = frames;
+        voice.slideStep = (target - voice.volume) / static_cast<float>(frames);
+    }
+
+    double Ratio(const Voice& voice) const {
+        return static_cast<double>(voice.clip->sampleRate) / sampleRate;
+    }
+
+    // The GainStage delay in source frames: how far past its own frame each sync fires,
+    // and how long a non-looping voice runs past its end.
+    double Latency(const Voice& voice) const {
+        return voice.gain.LatencyFrames() * Ratio(voice);
+    }
+
+    double SyncFrame(const Voice& voice, const Sync& sync, double latency) const {
+        double frame = sync.frame + latency;
+        if (voice.loop && frame >= voice.clip->frames) frame -= static_cast<double>(voice.clip->frames);
+        return frame;
+    }
+
+    // Output frames until the next sync, end of stream or end of a slide, so each mix
+    // pass can treat everything as constant or linear and syncs land on exact frames.
+    size_t FramesUntilNextEvent() const {
+        size_t limit = 4096;
+        for (const auto& [handle, voice] : voices) {
+            if (voice.state != AudioActivity::Playing) continue;
+            double ratio = Ratio(voice);
+            double latency = Latency(voice);
+            auto until = [&](double frame) {
+                double ahead = (frame - voice.cursor) / ratio;
+                return ahead <= 0.0 ? size_t(1) : static_cast<size_t>(std::ceil(ahead));
+            };
+            limit = std::min(limit, until(voice.clip->frames + (voice.loop ? 0.0 : latency)));
+            for (const auto& sync : voice.syncs) {
+                double frame = SyncFrame(voice, sync, latency);
+                if (!sync.atEnd && frame >= voice.cursor) limit = std::min(limit, until(frame));
+            }
+            if (voice.slideFrames > 0) limit = std::min<size_t>(limit, voice.slideFrames);
+        }
+        return std::max<size_t>(limit, 1);
+    }
+
+    void MixLocked(float* out, size_t frames, std::vector<std::pair<AudioSyncProc, AudioHandle>>& fired) {
+        for (auto it = voices.begin(); it != voices.end();) {
+            AudioHandle handle = it->first;
+            Voice& voice = it->second;
+            if (voice.state != AudioActivity::Playing) {
+                ++it;
+                continue;
+            }
+
+            const Clip& clip = *voice.clip;
+            double ratio = Ratio(voice);
+            double latency = Latency(voice);
+            double end = clip.frames + (voice.loop ? 0.0 : latency);
+            bool ended = false;
+            double start = voice.cursor;
+            voiceBlock.assign(frames * kOutputChannels, 0.0f);
+            size_t mixed = 0;
+
+            for (size_t i = 0; i < frames; ++i) {
+                if (voice.cursor >= clip.frames) {
+                    if (!voice.loop) {
+                        if (voice.cursor >= end) {
+                            ended = true;
+                            break;
+                        }
+                        // Past the last frame: silence in, the limiter's delay out.
+                        voice.cursor += ratio;
+                        mixed++;
+                        continue;
+                    }
+                    voice.cursor -= static_cast<double>(clip.frames);
+                }
+
+                size_t index = static_cast<size_t>(voice.cursor);
+                float fraction = static_cast<float>(voice.cursor - index);
+                size_t nextIndex = index + 1 < clip.frames ? index + 1 : (voice.loop ? 0 : index);
+                for (uint32_t c = 0; c < kOutputChannels; ++c) {
+                    uint32_t source = clip.channels == 1 ? 0 : std::min(c, clip.channels - 1);
+                    float a = clip.data[index * clip.channels + source];
+                    float b = clip.data[nextIndex * clip.channels + source];
+                    voiceBlock[i * kOutputChannels + c] = a + (b - a) * fraction;
+                }
+
+                voice.cursor += ratio;
+                mixed++;
+            }
+
+            voice.gain.Process(voiceBlock.data(), frames);
+            for (size_t i = 0; i < mixed; ++i) {
+                for (uint32_t c = 0; c < kOutputChannels; ++c) {
+                    out[i * kOutputChannels + c] += voiceBlock[i * kOutputChannels + c] * voice.volume;
+                }
+                if (voice.slideFrames > 0) {
+                    voice.volume += voice.slideStep;
+                    if (--voice.slideFrames == 0) voice.volume = voice.slideTarget;
+                }
+            }
+
+            if (!voice.loop && voice.cursor >= end) ended = true;
+
+            bool wrapped = voice.cursor < start;
+            for (auto sync = voice.syncs.begin(); sync != voice.syncs.end();) {
+                double frame = SyncFrame(voice, *sync, latency);
+                bool reached = sync->atEnd ? ended
+                             : wrapped     ? frame >= start || frame <= voice.cursor
+                                           : frame >= start && frame <= voice.cursor;
+                if (reached) {
+                    fired.emplace_back(sync->proc, handle);
+                    sync = voice.syncs.erase(sync);
+                } else {
+                    ++sync;
+                }
+            }
+
+            if (ended) {
+                voice.state = AudioActivity::Stopped;
+                voice.cursor = static_cast<double>(clip.frames);
+            }
+            if (voice.freeAfterSlide && voice.slideFrames == 0) {
+                it = voices.erase(it);
+                continue;
+            }
+            if (voice.pauseAfterSlide && voice.slideFrames == 0) {
+                voice.pauseAfterSlide = false;
+                if (voice.state == AudioActivity::Playing) voice.state = AudioActivity::Paused;
+            }
+            ++it;
+        }
+    }
+
+    void PumpThreadFunction() {
+        auto last = std::chrono::steady_clock::now();
+        double carry = 0.0;
+        while (pumpActive.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            auto now = std::chrono::steady_clock::now();
+            carry += std::chrono::duration<double>(now - last).count() * sampleRate;
+            last = now;
+            size_t frames = static_cast<size_t>(carry);
+            carry -= static_cast<double>(frames);
+            Render(frames);
+        }
+    }
+
+    std::shared_ptr<const Clip> LoadClip(const std::filesystem::path& file) {
+        auto clip = std::make_shared<Clip>();
+        if (ReadWav(file, *clip) || DecodeWith(file, *clip)) return clip;
+        return nullptr;
+    }
+
+    bool DecodeWith(const std::filesystem::path& file, Clip& clip) {
+        if (!decoder) {
+            lastError = kErrorFormat;
+            return false;
+        }
+        AudioFormat format;
+        AudioHandle handle = decoder->OpenDecoder(file, format);
+        if (!handle || format.channels == 0 || format.sampleRate == 0) {
+            lastError = decoder->LastError();
+            return false;
+        }
+        clip.channels = format.channels;
+        clip.sampleRate = format.sampleRate;
+        std::vector<float> buffer(4096 * format.channels);
+        while (size_t got = decoder->Decode(handle, buffer.data(), 4096)) {
+            clip.data.insert(clip.data.end(), buffer.begin(), buffer.begin() + got * format.channels);
+        }
+        decoder->Free(handle);
+        clip.frames = clip.data.size() / clip.channels;
+        return clip.frames > 0;
+    }
+
+    bool ReadWav(const std::filesystem::path& file, Clip& clip) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) {
+            lastError = kErrorFile;
+            return false;
+        }
+
+        char riff[12];
+        if (!in.read(riff, 12) || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+            return false;
+        }
+
+        uint16_t formatTag = 0, channels = 0, bits = 0;
+        uint32_t rate = 0;
+        std::vector<char> pcm;
+        char header[8];
+        while (in.read(header, 8)) {
+            uint32_t size = 0;
+            std::memcpy(&size, header + 4, 4);
+            if (std::memcmp(header, "fmt ", 4) == 0 && size >= 16) {
+                char fmt[16];
+                in.read(fmt, 16);
+                std::memcpy(&formatTag, fmt, 2);
+                std::memcpy(&channels, fmt + 2, 2);
+                std::memcpy(&rate, fmt + 4, 4);
+                std::memcpy(&bits, fmt + 14, 2);
+                if (formatTag == 0xFFFE && size >= 40) {
+                    char extension[24];
+                    in.read(extension, 24);
+                    std::memcpy(&formatTag, extension + 8, 2);
+                    in.seekg(size - 40, std::ios::cur);
+                } else {
+                    in.seekg(size - 16, std::ios::cur);
+                }
+            } else if (std::memcmp(header, "data", 4) == 0) {
+                pcm.resize(size);
+                in.read(pcm.data(), size);
+                pcm.resize(static_cast<size_t>(in.gcount()));
+                break;
+            } else {
+                in.seekg(size, std::ios::cur);
+            }
+            if (size & 1) in.seekg(1, std::ios::cur);
+        }
+
+        bool isFloat = formatTag == 3 && bits == 32;
+        bool isPcm = formatTag == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+        if ((!isFloat && !isPcm) || channels == 0 || rate == 0) {
+            lastError = kErrorFormat;
+            return false;
+        }
+
+        size_t bytesPerSample = bits / 8;
+        size_t count = pcm.size() / bytesPerSample;
+        count -= count % channels;
+        clip.data.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(pcm.data()) + i * bytesPerSample;
+            float value = 0.0f;
+            if (isFloat) {
+                std::memcpy(&value, p, 4);
+            } else if (bits == 8) {
+                value = (static_cast<int>(p[0]) - 128) / 128.0f;
+            } else if (bits == 16) {
+                value = static_cast<int16_t>(p[0] | (p[1] << 8)) / 32768.0f;
+            } else if (bits == 24) {
+                int32_t sample = (p[0] << 8) | (p[1] << 16) | (p[2] << 24);
+                value = (sample >> 8) / 8388608.0f;
+            } else {
+                int32_t sample = 0;
+                std::memcpy(&sample, p, 4);
+                value = static_cast<float>(sample / 2147483648.0);
+            }
+            clip.data[i] = value;
+        }
+        clip.channels = channels;
+        clip.sampleRate = rate;
+        clip.frames = count / channels;
+        return clip.frames > 0;
+    }
+
+    void WriteWavHeader() {
+        auto put16 = [&](uint16_t v) { output.write(reinterpret_cast<const char*>(&v), 2); };
+        auto put32 = [&](uint32_t v) { output.write(reinterpret_cast<const char*>(&v), 4); };
+
+        uint32_t dataBytes = static_cast<uint32_t>(std::min<uint64_t>(framesWritten * kOutputChannels * sizeof(float),
+                                                                      0xFFFFFFFFull - 36));
+        std::streampos end = output.tellp();
+        output.seekp(0);
+        output.write("RIFF", 4);
+        put32(36 + dataBytes);
+        output.write("WAVEfmt ", 8);
+        put32(16);
+        put16(3);  // IEEE float
+        put16(kOutputChannels);
+        put32(sampleRate);
+        put32(sampleRate * kOutputChannels * sizeof(float));
+        put16(kOutputChannels * sizeof(float));
+        put16(32);
+        output.write("data", 4);
+        put32(dataBytes);
+        if (end > std::streampos(44)) output.seekp(end);
+    }
+
+    std::filesystem::path outputFile;
+    uint32_t sampleRate;
+    bool realtime;
+    IAudioBackend* decoder;
+
+    mutable std::mutex mutex;
+    std::map<AudioHandle, Voice> voices;
+    std::vector<float> voiceBlock;  // one voice's frames between resampling and mixing
+    std::unordered_map<AudioSample, std::shared_ptr<const Clip>> samples;
+    AudioHandle nextHandle = 0;
+    AudioSample nextSample = 0;
+    std::ofstream output;
+    uint64_t framesWritten = 0;
+    uint64_t renderedFrames = 0;
+    double mixSeconds = 0.0;
+    uint64_t mixFrames = 0;
+    std::atomic<int> lastError{0};
+    std::atomic<bool> pumpActive{false};
+    std::thread pumpThread;
+};
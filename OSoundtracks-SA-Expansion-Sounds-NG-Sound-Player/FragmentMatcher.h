@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// SoundPositionKey fragment matching, kept apart from the game types so it can be tested
+// off Windows. Standard library only, like GainStage.h.
+
+// Fixed-size bitset over fragment IDs; sized once per SoundTables generation.
+struct FragmentSet {
+    std::vector<uint64_t> words;
+
+    void Resize(size_t bits) { words.assign((bits + 63) / 64, 0); }
+    void Clear() { std::fill(words.begin(), words.end(), 0); }
+    void Set(size_t bit) { words[bit >> 6] |= (uint64_t{1} << (bit & 63)); }
+    bool Test(size_t bit) const { return (words[bit >> 6] >> (bit & 63)) & 1; }
+};
+
+// Case-insensitive Aho-Corasick automaton over the SoundPositionKey fragments. Compiled
+// into a dense DFA over the byte classes that occur in fragments, so matching an
+// animation name is one table lookup per character.
+class FragmentMatcher {
+public:
+    void Build(const std::vector<std::string>& fragments) {
+        fragmentCount = fragments.size();
+        byteClass.fill(0);
+        classCount = 1;
+
+        std::vector<std::string> patterns;
+        patterns.reserve(fragments.size());
+        for (const auto& fragment : fragments) {
+            std::string lower = fragment;
+            for (auto& ch : lower) {
+                ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+                auto& cls = byteClass[static_cast<unsigned char>(ch)];
+                if (cls == 0) {
+                    cls = static_cast<uint16_t>(classCount++);
+                }
+            }
+            patterns.push_back(std::move(lower));
+        }
+        for (int b = 0; b < 256; ++b) {
+            byteClass[b] = byteClass[static_cast<unsigned char>(std::tolower(b))];
+        }
+
+        transitions.assign(classCount, -1);
+        outputHead.assign(1, -1);
+        outputLink.assign(1, -1);
+        nextSameNode.assign(fragmentCount, -1);
+
+        for (size_t id = 0; id < patterns.size(); ++id) {
+            int32_t node = 0;
+            for (unsigned char ch : patterns[id]) {
+                size_t slot = static_cast<size_t>(node) * classCount + byteClass[ch];
+                if (transitions[slot] < 0) {
+                    transitions[slot] = static_cast<int32_t>(outputHead.size());
+                    transitions.resize(transitions.size() + classCount, -1);
+                    outputHead.push_back(-1);
+                    outputLink.push_back(-1);
+                }
+                node = transitions[slot];
+            }
+            nextSameNode[id] = outputHead[node];
+            outputHead[node] = static_cast<int32_t>(id);
+        }
+
+        std::vector<int32_t> fail(outputHead.size(), 0);
+        std::deque<int32_t> queue;
+        for (uint32_t c = 0; c < classCount; ++c) {
+            int32_t& next = transitions[c];
+            if (next < 0) {
+                next = 0;
+            } else {
+                queue.push_back(next);
+            }
+        }
+
+        while (!queue.empty()) {
+            int32_t node = queue.front();
+            queue.pop_front();
+            size_t row = static_cast<size_t>(node) * classCount;
+            size_t failRow = static_cast<size_t>(fail[node]) * classCount;
+            for (uint32_t c = 0; c < classCount; ++c) {
+                int32_t next = transitions[row + c];
+                if (next < 0) {
+                    transitions[row + c] = transitions[failRow + c];
+                    continue;
+                }
+                int32_t nextFail = transitions[failRow + c];
+                fail[next] = nextFail;
+                outputLink[next] = outputHead[nextFail] >= 0 ? nextFail : outputLink[nextFail];
+                queue.push_back(next);
+            }
+        }
+    }
+
+    size_t FragmentCount() const { return fragmentCount; }
+
+    void Match(std::string_view text, FragmentSet& matches) const {
+        if (fragmentCount == 0) {
+            return;
+        }
+        int32_t node = 0;
+        Emit(node, matches);
+        for (unsigned char ch : text) {
+            node = transitions[static_cast<size_t>(node) * classCount + byteClass[ch]];
+            Emit(node, matches);
+        }
+    }
+
+private:
+    void Emit(int32_t node, FragmentSet& matches) const {
+        for (int32_t n = outputHead[node] >= 0 ? node : outputLink[node]; n >= 0; n = outputLink[n]) {
+            for (int32_t id = outputHead[n]; id >= 0; id = nextSameNode[id]) {
+                matches.Set(static_cast<size_t>(id));
+            }
+        }
+    }
+
+    std::array<uint16_t, 256> byteClass{};
+    uint32_t classCount = 1;
+    size_t fragmentCount = 0;
+    std::vector<int32_t> transitions;
+    std::vector<int32_t> outputHead;
+    std::vector<int32_t> outputLink;
+    std::vector<int32_t> nextSameNode;
+};
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OSOUNDTRACKS_GAIN_SSE 1
+#endif
+
+// Per-stream output stage: the channel level from the volume settings (0-200%), ramped
+// per sample, followed by a look-ahead limiter that keeps the result under full scale.
+// It runs before the backend's own volume, which is left to fades, so slider moves glide
+// instead of stepping and levels above 100% are pulled down smoothly instead of clipping.
+// At 100% and below the limiter is bypassed and the stage adds no latency.
+//
+// Standard library plus SSE2 (part of every x64 CPU), so the same code runs off Windows.
+// Buffers are interleaved float; mono and stereo take the vector paths, anything else the
+// scalar loops, which produce the same results.
+
+// samples[frame * channels + c] *= from + step * frame
+inline void ApplyGainRamp(float* samples, size_t frames, uint32_t channels, float from, float step) {
+    size_t i = 0;
+#ifdef OSOUNDTRACKS_GAIN_SSE
+    const __m128 base = _mm_set1_ps(from);
+    const __m128 slope = _mm_set1_ps(step);
+    if (channels == 2) {
+        __m128 frame = _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f);
+        const __m128 advance = _mm_set1_ps(2.0f);
+        for (; i + 2 <= frames; i += 2) {
+            float* p = samples + i * 2;
+            __m128 gain = _mm_add_ps(base, _mm_mul_ps(slope, frame));
+            _mm_storeu_ps(p, _mm_mul_ps(_mm_loadu_ps(p), gain));
+            frame = _mm_add_ps(frame, advance);
+        }
+    } else if (channels == 1) {
+        __m128 frame = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 advance = _mm_set1_ps(4.0f);
+        for (; i + 4 <= frames; i += 4) {
+            float* p = samples + i;
+            __m128 gain = _mm_add_ps(base, _mm_mul_ps(slope, frame));
+            _mm_storeu_ps(p, _mm_mul_ps(_mm_loadu_ps(p), gain));
+            frame = _mm_add_ps(frame, advance);
+        }
+    }
+#endif
+    for (; i < frames; ++i) {
+        float gain = from + step * static_cast<float>(i);
+        for (uint32_t c = 0; c < channels; ++c) samples[i * channels + c] *= gain;
+    }
+}
+
+// samples[frame * channels + c] *= gains[frame]
+inline void ApplyGainCurve(float* samples, size_t frames, uint32_t channels, const float* gains) {
+    size_t i = 0;
+#ifdef OSOUNDTRACKS_GAIN_SSE
+    if (channels == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            float* p = samples + i * 2;
+            __m128 g = _mm_loadu_ps(gains + i);
+            _mm_storeu_ps(p, _mm_mul_ps(_mm_loadu_ps(p), _mm_unpacklo_ps(g, g)));
+            _mm_storeu_ps(p + 4, _mm_mul_ps(_mm_loadu_ps(p + 4), _mm_unpackhi_ps(g, g)));
+        }
+    } else if (channels == 1) {
+        for (; i + 4 <= frames; i += 4) {
+            _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(gains + i)));
+        }
+    }
+#endif
+    for (; i < frames; ++i) {
+        for (uint32_t c = 0; c < channels; ++c) samples[i * channels + c] *= gains[i];
+    }
+}
+
+// peaks[frame] = largest |sample| across the frame's channels
+inline void FramePeaks(const float* samples, size_t frames, uint32_t channels, float* peaks) {
+    size_t i = 0;
+#ifdef OSOUNDTRACKS_GAIN_SSE
+    const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    if (channels == 2) {
+        for (; i + 4 <= frames; i += 4) {
+            const float* p = samples + i * 2;
+            __m128 a = _mm_and_ps(_mm_loadu_ps(p), magnitude);
+            __m128 b = _mm_and_ps(_mm_loadu_ps(p + 4), magnitude);
+            __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(peaks + i, _mm_max_ps(left, right));
+        }
+    } else if (channels == 1) {
+        for (; i + 4 <= frames; i += 4) {
+            _mm_storeu_ps(peaks + i, _mm_and_ps(_mm_loadu_ps(samples + i), magnitude));
+        }
+    }
+#endif
+    for (; i < frames; ++i) {
+        float peak = 0.0f;
+        for (uint32_t c = 0; c < channels; ++c) peak = std::max(peak, std::fabs(samples[i * channels + c]));
+        peaks[i] = peak;
+    }
+}
+
+// Delays the signal by the look-ahead and applies a gain that has already reached
+// ceiling / peak when each peak comes out. The gain is the minimum required over the
+// look-ahead window, released exponentially and then averaged over the same window,
+// so it bends down over the look-ahead instead of jumping and never overshoots.
+class LookAheadLimiter {
+public:
+    static constexpr float kCeiling = 0.98f;  // about -0.2 dBFS
+    static constexpr float kLookaheadMs = 2.0f;
+    static constexpr float kReleaseMs = 80.0f;
+
+    void Prepare(uint32_t sampleRate, uint32_t channelCount) {
+        channels = channelCount;
+        lookahead = std::max<uint32_t>(1, static_cast<uint32_t>(sampleRate * kLookaheadMs / 1000.0f));
+        window = lookahead + 1;
+        releaseCoef = 1.0f - std::exp(-1000.0f / (kReleaseMs * std::max<uint32_t>(sampleRate, 1)));
+
+        delay.assign(static_cast<size_t>(lookahead) * channels, 0.0f);
+        minFrames.assign(window, 0);
+        minGains.assign(window, 1.0f);
+        minHead = 0;
+        minCount = 0;
+        average.assign(window, 1.0f);
+        averagePos = 0;
+        averageSum = window;
+        held = 1.0f;
+        frameCounter = 0;
+    }
+
+    uint32_t LatencyFrames() const { return lookahead; }
+
+    // While bypassed: keeps the delay line holding the latest input, so Process can take
+    // over without a gap, and returns the gain to unity.
+    void Track(const float* samples, size_t frames) {
+        size_t delaySamples = delay.size();
+        size_t blockSamples = frames * channels;
+        if (blockSamples >= delaySamples) {
+            std::memcpy(delay.data(), samples + blockSamples - delaySamples, delaySamples * sizeof(float));
+        } else {
+            std::memmove(delay.data(), delay.data() + blockSamples, (delaySamples - blockSamples) * sizeof(float));
+            std::memcpy(delay.data() + delaySamples - blockSamples, samples, blockSamples * sizeof(float));
+        }
+        frameCounter += frames;
+        if (held != 1.0f || minCount > 0) {
+            minHead = 0;
+            minCount = 0;
+            std::fill(average.begin(), average.end(), 1.0f);
+            averagePos = 0;
+            averageSum = window;
+            held = 1.0f;
+        }
+    }
+
+    void Process(float* samples, size_t frames) {
+        if (frames == 0 || channels == 0) return;
+
+        size_t delaySamples = delay.size();
+        size_t blockSamples = frames * channels;
+        work.resize(delaySamples + blockSamples);
+        std::memcpy(work.data(), delay.data(), delaySamples * sizeof(float));
+        std::memcpy(work.data() + delaySamples, samples, blockSamples * sizeof(float));
+
+        peaks.resize(frames);
+        gains.resize(frames);
+        FramePeaks(samples, frames, channels, peaks.data());
+
+        bool reducing = false;
+        for (size_t i = 0; i < frames; ++i) {
+            float required = peaks[i] > kCeiling ? kCeiling / peaks[i] : 1.0f;
+            float minimum = PushMinimum(required);
+            held = minimum < held ? minimum : held + (minimum - held) * releaseCoef;
+
+            averageSum += static_cast<double>(held) - average[averagePos];
+            average[averagePos] = held;
+            averagePos = averagePos + 1 == window ? 0 : averagePos + 1;
+
+            gains[i] = std::min(1.0f, static_cast<float>(averageSum / window));
+            reducing |= gains[i] < 1.0f;
+        }
+
+        std::memcpy(samples, work.data(), blockSamples * sizeof(float));
+        std::memcpy(delay.data(), work.data() + blockSamples, delaySamples * sizeof(float));
+        if (reducing) ApplyGainCurve(samples, frames, channels, gains.data());
+    }
+
+private:
+    // Sliding minimum over the last `window` frames (monotonic queue in a ring).
+    float PushMinimum(float gain) {
+        while (minCount > 0 && minFrames[minHead] + window <= frameCounter) {
+            minHead = (minHead + 1) % window;
+            --minCount;
+        }
+        while (minCount > 0 && minGains[(minHead + minCount - 1) % window] >= gain) --minCount;
+        size_t slot = (minHead + minCount) % window;
+        minFrames[slot] = frameCounter;
+        minGains[slot] = gain;
+        ++minCount;
+        ++frameCounter;
+        return minGains[minHead];
+    }
+
+    uint32_t channels = 0;
+    uint32_t lookahead = 0;
+    uint32_t window = 1;
+    float releaseCoef = 0.0f;
+
+    std::vector<float> delay;  // the last `lookahead` input frames
+    std::vector<float> work;
+    std::vector<float> peaks;
+    std::vector<float> gains;
+
+    std::vector<uint64_t> minFrames;
+    std::vector<float> minGains;
+    size_t minHead = 0;
+    size_t minCount = 0;
+
+    std::vector<float> average;
+    size_t averagePos = 0;
+    double averageSum = 1.0;
+
+    float held = 1.0f;
+    uint64_t frameCounter = 0;
+};
+
+// SetLevel and SetTrim may be called from any thread; Process runs on the mixer thread
+// and picks the new gain up at its next block, ramping to it over kRampMs. The trim is
+// a per-track correction (loudness normalization) multiplied into the level; boosts are
+// capped below the true-peak ceiling, so only a level above 1 needs the limiter.
+//
+// The limiter's look-ahead delays the stream, which would cut the end of every track and
+// open a gap before the next, so it runs only while the level is above 1. Engaging and
+// releasing it cross-fade between the direct and the delayed signal over kRampMs.
+class GainStage {
+public:
+    static constexpr float kRampMs = 20.0f;
+
+    void Prepare(uint32_t sampleRate, uint32_t channelCount) {
+        channels = channelCount;
+        rampFrames = std::max<size_t>(1, static_cast<size_t>(sampleRate * kRampMs / 1000.0f));
+        limiter.Prepare(sampleRate, channelCount);
+    }
+
+    void SetLevel(float value) { level.store(std::max(value, 0.0f), std::memory_order_relaxed); }
+    void SetTrim(float value) { trim.store(std::max(value, 0.0f), std::memory_order_relaxed); }
+    float Level() const { return level.load(std::memory_order_relaxed); }
+    uint32_t Channels() const { return channels; }
+    // Frames the output trails the input by, counting an engage the next block will make:
+    // 0 unless the limiter is (or is about to be) in the signal path.
+    uint32_t LatencyFrames() const {
+        bool engaged = limiting || switchLeft > 0 || level.load(std::memory_order_relaxed) > 1.0f;
+        return engaged ? limiter.LatencyFrames() : 0;
+    }
+
+    void Process(float* samples, size_t frames) {
+        if (channels == 0 || frames == 0) return;
+
+        // Engage as soon as the level goes above 1; release only once the ramp down ends.
+        float levelValue = level.load(std::memory_order_relaxed);
+        bool limit = levelValue > 1.0f || (limiting && rampLeft > 0);
+        if (current < 0.0f) {
+            // Nothing has been heard yet, so the first block needs no cross-fade.
+            limiting = limit;
+        } else if (limit != limiting) {
+            // A switch that reverses half way continues from the same mix.
+            switchLeft = switchLeft > 0 ? rampFrames - switchLeft : rampFrames;
+            limiting = limit;
+        }
+        // The direct signal must stay under full scale, so the level waits at 1 until the
+        // limiter has fully taken over.
+        if (!limiting || switchLeft > 0) levelValue = std::min(levelValue, 1.0f);
+
+        float target = levelValue * trim.load(std::memory_order_relaxed);
+        if (current < 0.0f) {
+            // The first block starts at the level set before playback, without a ramp.
+            current = target;
+            rampTarget = target;
+        }
+        if (target != rampTarget) {
+            rampTarget = target;
+            rampLeft = rampFrames;
+            rampStep = (target - current) / static_cast<float>(rampFrames);
+        }
+
+        size_t done = 0;
+        if (rampLeft > 0) {
+            done = std::min(frames, rampLeft);
+            ApplyGainRamp(samples, done, channels, current + rampStep, rampStep);
+            rampLeft -= done;
+            current = rampLeft == 0 ? rampTarget : current + rampStep * static_cast<float>(done);
+        }
+        if (done < frames && current != 1.0f) {
+            ApplyGainRamp(samples + done * channels, frames - done, channels, current, 0.0f);
+        }
+
+        if (switchLeft == 0) {
+            if (limiting) {
+                limiter.Process(samples, frames);
+            } else {
+                limiter.Track(samples, frames);
+            }
+            return;
+        }
+
+        direct.assign(samples, samples + frames * channels);
+        limiter.Process(samples, frames);
+        size_t fading = std::min(frames, switchLeft);
+        for (size_t i = 0; i < fading; ++i) {
+            // Share of the limited signal: rising while engaging, falling while releasing.
+            float t = static_cast<float>(rampFrames - switchLeft + i + 1) / static_cast<float>(rampFrames);
+            float w = limiting ? t : 1.0f - t;
+            for (uint32_t c = 0; c < channels; ++c) {
+                size_t k = i * channels + c;
+                samples[k] = direct[k] + (samples[k] - direct[k]) * w;
+            }
+        }
+        if (!limiting && frames > fading) {
+            std::memcpy(samples + fading * channels, direct.data() + fading * channels,
+                        (frames - fading) * channels * sizeof(float));
+        }
+        switchLeft -= fading;
+    }
+
+private:
+    std::atomic<float> level{1.0f};
+    std::atomic<float> trim{1.0f};
+    uint32_t channels = 0;
+    size_t rampFrames = 1;
+    size_t rampLeft = 0;
+    float rampStep = 0.0f;
+    float rampTarget = 1.0f;
+    float current = -1.0f;  // negative until the first block
+    LookAheadLimiter limiter;
+    bool limiting = false;
+    size_t switchLeft = 0;  // frames left in a cross-fade between direct and limited
+    std::vector<float> direct;
+};
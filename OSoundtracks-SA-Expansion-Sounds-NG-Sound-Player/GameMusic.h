@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Music-mute bookkeeping, kept apart from the game types so it can run against a fake
+// IGameMusic off Windows. The plugin implements IGameMusic over the BGSMusicType forms.
+//
+// Muting swaps each type's track array with an empty one held by the implementation, so
+// the game sees no tracks, nothing is copied, and restoring is the same swap back. The
+// index of music types is built once after data load and reused by every mute.
+
+class IGameMusic {
+public:
+    virtual ~IGameMusic() = default;
+
+    // Rebuilds the list of music types and returns how many there are. Types are
+    // addressed by their position in that list until the next call.
+    virtual size_t IndexMusicTypes() = 0;
+    virtual size_t TrackCount(size_t type) const = 0;
+
+    // Leaves the type with an empty track array and keeps the original one aside;
+    // ReattachTracks puts the original back. Calls always come in that order.
+    virtual void DetachTracks(size_t type) = 0;
+    virtual void ReattachTracks(size_t type) = 0;
+};
+
+class MusicMuter {
+public:
+    struct MuteCounts {
+        size_t muted = 0;
+        size_t skipped = 0;
+    };
+
+    explicit MusicMuter(IGameMusic& game) : game(game) {}
+
+    // Call once the game's forms are loaded. Anything still muted is restored first,
+    // since the old positions are about to become meaningless.
+    size_t BuildIndex() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ReattachLocked();
+        IndexLocked();
+        return typeCount;
+    }
+
+    // Empties every music type that has tracks. Does nothing if already muted.
+    MuteCounts DetachAll() {
+        std::lock_guard<std::mutex> lock(mutex);
+        MuteCounts counts;
+        if (!detached.empty()) {
+            return counts;
+        }
+        if (!indexed) {
+            IndexLocked();
+        }
+
+        for (size_t type = 0; type < typeCount; ++type) {
+            if (game.TrackCount(type) == 0) {
+                counts.skipped++;
+                continue;
+            }
+            game.DetachTracks(type);
+            detached.push_back(type);
+            counts.muted++;
+        }
+        return counts;
+    }
+
+    // Returns how many music types got their tracks back.
+    size_t ReattachAll() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ReattachLocked();
+    }
+
+    bool IsMuted() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !detached.empty();
+    }
+
+    size_t IndexedTypes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return typeCount;
+    }
+
+private:
+    void IndexLocked() {
+        typeCount = game.IndexMusicTypes();
+        detached.clear();
+        detached.reserve(typeCount);
+        indexed = true;
+    }
+
+    size_t ReattachLocked() {
+        size_t restored = detached.size();
+        for (size_t type : detached) {
+            game.ReattachTracks(type);
+        }
+        detached.clear();
+        return restored;
+    }
+
+    IGameMusic& game;
+    mutable std::mutex mutex;
+    std::vector<size_t> detached;
+    size_t typeCount = 0;
+    bool indexed = false;
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Integrated loudness (ITU-R BS.1770-4 / EBU R128) and true peak of a whole file, fed
+// interleaved float frames in order. Standard library only, like GainStage.h.
+//
+// K-weighting is the two-stage filter from the standard, with coefficients derived for
+// the file's sample rate. Loudness is measured on 400 ms blocks every 100 ms, gated at
+// -70 LUFS and then 10 LU below the ungated mean. Mono files are counted as dual mono,
+// the way they reach the listener. Multichannel files are taken in WAVE channel order
+// (what decoders deliver): surround channels count 1.41, the LFE not at all. True peak
+// comes from 4x oversampling with a 48-tap windowed-sinc interpolator, as the
+// standard's annex suggests.
+class LoudnessMeter {
+public:
+    static constexpr double kSilence = -70.0;  // returned when nothing passes the gate
+    static constexpr uint32_t kMaxChannels = 8;
+
+    // False for channel counts without a known layout (0 or more than kMaxChannels);
+    // the meter then ignores its input.
+    bool Prepare(uint32_t sampleRate, uint32_t channelCount) {
+        channels = ChannelWeights(channelCount, weights) ? channelCount : 0;
+        filters.assign(channels, Filter{});
+        DesignKWeighting(static_cast<double>(sampleRate));
+        DesignInterpolator();
+        history.assign(static_cast<size_t>(kTapsPerPhase) * channels, 0.0f);
+        historyPos = 0;
+
+        hopFrames = std::max<size_t>(1, sampleRate / 10);
+        hopEnergy = 0.0;
+        hopFilled = 0;
+        hops.clear();
+        blocks.clear();
+        peak = 0.0f;
+        return channels != 0;
+    }
+
+    void Add(const float* samples, size_t frames) {
+        if (channels == 0) return;
+
+        for (size_t i = 0; i < frames; ++i) {
+            const float* frame = samples + i * channels;
+            double energy = 0.0;
+            for (uint32_t c = 0; c < channels; ++c) {
+                double x = filters[c].Run(frame[c], shelf, highpass);
+                energy += x * x * weights[c];
+            }
+            hopEnergy += energy;
+            TrackTruePeak(frame);
+
+            if (++hopFilled == hopFrames) {
+                hops.push_back(hopEnergy / static_cast<double>(hopFrames));
+                hopEnergy = 0.0;
+                hopFilled = 0;
+                if (hops.size() >= 4) {
+                    size_t n = hops.size();
+                    blocks.push_back((hops[n - 1] + hops[n - 2] + hops[n - 3] + hops[n - 4]) / 4.0);
+                }
+            }
+        }
+    }
+
+    double IntegratedLufs() const {
+        const double absoluteGate = EnergyOf(kSilence);
+        double sum = 0.0;
+        size_t count = 0;
+        for (double block : blocks) {
+            if (block > absoluteGate) {
+                sum += block;
+                count++;
+            }
+        }
+        if (count == 0) return kSilence;
+
+        const double relativeGate = sum / static_cast<double>(count) * std::pow(10.0, -10.0 / 10.0);
+        sum = 0.0;
+        count = 0;
+        for (double block : blocks) {
+            if (block > absoluteGate && block > relativeGate) {
+                sum += block;
+                count++;
+            }
+        }
+        return count ? LoudnessOf(sum / static_cast<double>(count)) : kSilence;
+    }
+
+    // dBTP; -inf for digital silence.
+    double TruePeakDb() const { return 20.0 * std::log10(static_cast<double>(peak)); }
+
+private:
+    static constexpr int kPhases = 4;
+    static constexpr int kTapsPerPhase = 12;
+
+    struct Biquad {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    struct Filter {
+        double s1 = 0.0, s2 = 0.0, h1 = 0.0, h2 = 0.0;
+
+        double Run(double x, const Biquad& first, const Biquad& second) {
+            double y = first.b0 * x + s1;
+            s1 = first.b1 * x - first.a1 * y + s2;
+            s2 = first.b2 * x - first.a2 * y;
+            double z = second.b0 * y + h1;
+            h1 = second.b1 * y - second.a1 * z + h2;
+            h2 = second.b2 * y - second.a2 * z;
+            return z;
+        }
+    };
+
+    // BS.1770 weights by position: 1.0 front, 1.41 for surrounds between 60 and 120
+    // degrees, 0 for the LFE. Layouts are the WAVE defaults for each channel count:
+    // quad FL FR BL BR, 5.0 FL FR FC BL BR, 5.1 adds LFE after FC, 6.1 adds BC before
+    // SL SR, and 7.1 is FL FR FC LFE BL BR SL SR with the back pair behind 120 degrees.
+    static bool ChannelWeights(uint32_t count, std::vector<double>& out) {
+        constexpr double kSurround = 1.41;
+        switch (count) {
+            case 1: out = {2.0}; return true;
+            case 2: out = {1.0, 1.0}; return true;
+            case 3: out = {1.0, 1.0, 1.0}; return true;
+            case 4: out = {1.0, 1.0, kSurround, kSurround}; return true;
+            case 5: out = {1.0, 1.0, 1.0, kSurround, kSurround}; return true;
+            case 6: out = {1.0, 1.0, 1.0, 0.0, kSurround, kSurround}; return true;
+            case 7: out = {1.0, 1.0, 1.0, 0.0, 1.0, kSurround, kSurround}; return true;
+            case 8: out = {1.0, 1.0, 1.0, 0.0, 1.0, 1.0, kSurround, kSurround}; return true;
+            default: out.clear(); return false;
+        }
+    }
+
+    static double LoudnessOf(double energy) { return -0.691 + 10.0 * std::log10(energy); }
+    static double EnergyOf(double lufs) { return std::pow(10.0, (lufs + 0.691) / 10.0); }
+
+    void DesignKWeighting(double rate) {
+        const double pi = 3.14159265358979323846;
+
+        double f0 = 1681.974450955533;
+        double gainDb = 3.999843853973347;
+        double q = 0.7071752369554196;
+        double k = std::tan(pi * f0 / rate);
+        double vh = std::pow(10.0, gainDb / 20.0);
+        double vb = std::pow(vh, 0.4996667741545416);
+        double a0 = 1.0 + k / q + k * k;
+        shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        shelf.b1 = 2.0 * (k * k - vh) / a0;
+        shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+        f0 = 38.13547087602444;
+        q = 0.5003270373238773;
+        k = std::tan(pi * f0 / rate);
+        a0 = 1.0 + k / q + k * k;
+        highpass.b0 = 1.0;
+        highpass.b1 = -2.0;
+        highpass.b2 = 1.0;
+        highpass.a1 = 2.0 * (k * k - 1.0) / a0;
+        highpass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // Phase p holds taps p, p + 4, p + 8, ... of a Hann-windowed sinc cut at the
+    // original Nyquist, scaled so each phase has unity DC gain.
+    void DesignInterpolator() {
+        const double pi = 3.14159265358979323846;
+        const int taps = kPhases * kTapsPerPhase;
+        const double center = (taps - 1) / 2.0;
+        for (int p = 0; p < kPhases; ++p) {
+            double sum = 0.0;
+            for (int t = 0; t < kTapsPerPhase; ++t) {
+                int n = t * kPhases + p;
+                double x = (n - center) / kPhases;
+                double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+                double window = 0.5 - 0.5 * std::cos(2.0 * pi * (n + 0.5) / taps);
+                interpolator[p][t] = static_cast<float>(sinc * window);
+                sum += interpolator[p][t];
+            }
+            for (int t = 0; t < kTapsPerPhase; ++t) interpolator[p][t] = static_cast<float>(interpolator[p][t] / sum);
+        }
+    }
+
+    void TrackTruePeak(const float* frame) {
+        for (uint32_t c = 0; c < channels; ++c) history[historyPos * channels + c] = frame[c];
+        historyPos = (historyPos + 1) % kTapsPerPhase;
+
+        for (uint32_t c = 0; c < channels; ++c) {
+            for (int p = 0; p < kPhases; ++p) {
+                float y = 0.0f;
+                for (int t = 0; t < kTapsPerPhase; ++t) {
+                    size_t slot = (historyPos + kTapsPerPhase - 1 - t) % kTapsPerPhase;
+                    y += interpolator[p][t] * history[slot * channels + c];
+                }
+                peak = std::max(peak, std::fabs(y));
+            }
+        }
+    }
+
+    uint32_t channels = 0;
+    std::vector<double> weights;
+    Biquad shelf;
+    Biquad highpass;
+    std::vector<Filter> filters;
+
+    float interpolator[kPhases][kTapsPerPhase] = {};
+    std::vector<float> history;  // last kTapsPerPhase input frames, ring
+    size_t historyPos = 0;
+    float peak = 0.0f;
+
+    size_t hopFrames = 1;
+    double hopEnergy = 0.0;
+    size_t hopFilled = 0;
+    std::vector<double> hops;    // mean square per 100 ms
+    std::vector<double> blocks;  // mean square per 400 ms block, 75% overlap
+};
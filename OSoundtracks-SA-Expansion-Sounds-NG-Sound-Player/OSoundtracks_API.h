@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+
+// Now-playing interface exported by OSoundtracks-SA-Expansion-Sounds-NG-Sound-Player.dll.
+// Other SKSE plugins resolve the functions below with GetProcAddress on that module.
+// Keep this file identical in every project that includes it.
+namespace OSoundtracksAPI {
+    constexpr uint32_t kNowPlayingVersion = 1;
+    constexpr uint32_t kChannelCount = 7;
+
+    enum Channel : uint32_t {
+        kChannelBase,
+        kChannelSpecific,
+        kChannelMenu,
+        kChannelSoundMenuKey,
+        kChannelEffect,
+        kChannelPosition,
+        kChannelTag
+    };
+
+    enum Status : int32_t { kStopped = 0, kPlaying = 1, kPaused = 2 };
+
+    enum System : uint32_t { kSystemNone = 0, kSystemSoundMenuKey = 1, kSystemSoundKey = 2 };
+
+    struct ChannelState {
+        uint32_t trackId;  // FNV-1a of the track file name; 0 when the channel is idle
+        int32_t status;    // Status
+        float position;    // seconds, as of the moment the snapshot was taken
+        float duration;    // seconds; 0 if unknown
+        char track[128];
+        char author[64];   // SoundMenuKey author; empty for other channels
+    };
+
+    struct NowPlaying {
+        uint32_t version;       // kNowPlayingVersion
+        uint32_t activeSystem;  // System
+        uint64_t sequence;      // bumps whenever anything except position changes
+        ChannelState channels[kChannelCount];
+    };
+
+    // bool OSoundtracks_GetNowPlaying(NowPlaying* out)
+    //   Lock-free consistent snapshot; false if the Sound Player is not publishing yet.
+    using GetNowPlayingFn = bool (*)(NowPlaying*);
+
+    // uint64_t OSoundtracks_GetNowPlayingSequence()
+    //   Cheap check: callers skip GetNowPlaying while this is unchanged.
+    using GetNowPlayingSequenceFn = uint64_t (*)();
+
+    // Bits passed to a NowPlayingListener describing what changed since its last call.
+    enum Event : uint32_t {
+        kEventTrack = 1 << 0,     // a channel started, changed or dropped its track
+        kEventStatus = 1 << 1,    // a channel was paused, resumed or stopped
+        kEventSystem = 1 << 2,    // activeSystem changed
+        kEventProgress = 1 << 3   // periodic position update while something is playing
+    };
+
+    // Called on the Sound Player's notifier thread, never on the audio or game thread.
+    // The snapshot is only valid for the duration of the call; return quickly, and do not
+    // register or unregister listeners from inside one.
+    using NowPlayingListener = void (*)(const NowPlaying* state, uint32_t events, void* context);
+
+    // bool OSoundtracks_RegisterNowPlayingListener(NowPlayingListener listener, void* context)
+    //   Adds a listener and immediately delivers the current state to it with every
+    //   event bit set. Registering the same listener/context pair twice is a no-op.
+    using RegisterNowPlayingListenerFn = bool (*)(NowPlayingListener, void*);
+
+    // void OSoundtracks_UnregisterNowPlayingListener(NowPlayingListener listener, void* context)
+    //   Returns once the listener is guaranteed not to be running or called again.
+    using UnregisterNowPlayingListenerFn = void (*)(NowPlayingListener, void*);
+
+    // Transition latency, measured per Play command started by an OStim.log line.
+    // Stages are consecutive except kStageTotal, which spans line read to stream playing.
+    constexpr uint32_t kLatencyStatsVersion = 1;
+
+    enum LatencyStage : uint32_t {
+        kStageAppendToRead,          // OStim's own timestamp to our read of the line (ms resolution)
+        kStageReadToClassified,      // line parsed as a transition
+        kStageClassifiedToResolved,  // mapping looked up and the Play command queued
+        kStageResolvedToOpened,      // queue wait, then the file or cached sample opened
+        kStageOpenedToPlaying,       // stream started
+        kStageTotal,                 // line read to stream playing
+        kLatencyStageCount
+    };
+
+    inline constexpr const char* kLatencyStageNames[kLatencyStageCount] = {
+        "append_to_read", "read_to_classified", "classified_to_resolved",
+        "resolved_to_opened", "opened_to_playing", "read_to_playing"
+    };
+
+    struct LatencyStageStats {
+        uint64_t count;
+        uint64_t totalMicros;
+        uint32_t p50Micros;  // percentiles are bucket upper bounds, within ~3% of the sample
+        uint32_t p90Micros;
+        uint32_t p99Micros;
+        uint32_t maxMicros;
+    };
+
+    struct LatencyStats {
+        uint32_t version;     // kLatencyStatsVersion
+        uint32_t stageCount;  // kLatencyStageCount
+        uint64_t sinceMicros; // time covered by the histograms
+        LatencyStageStats stages[kLatencyStageCount];
+    };
+
+    // bool OSoundtracks_GetLatencyStats(LatencyStats* out)
+    //   Copies the running histograms without blocking the audio or monitor threads.
+    using GetLatencyStatsFn = bool (*)(LatencyStats*);
+
+    // Voice budget: streams playing (decoding) at once and what keeping under the cap cost.
+    constexpr uint32_t kVoiceStatsVersion = 1;
+
+    struct VoiceStats {
+        uint32_t version;        // kVoiceStatsVersion
+        uint32_t maxVoices;      // [Audio Engine] MaxVoices; 0 = no limit
+        uint32_t activeVoices;
+        uint32_t peakVoices;     // since the game started
+        uint64_t stolenVoices;   // faded out to make room for a higher-priority start
+        uint64_t refusedStarts;  // dropped because every playing voice outranked them
+        float decodeCpuPercent;  // backend mixing and decoding load; 0 if unknown
+    };
+
+    // bool OSoundtracks_GetVoiceStats(VoiceStats* out)
+    using GetVoiceStatsFn = bool (*)(VoiceStats*);
+}
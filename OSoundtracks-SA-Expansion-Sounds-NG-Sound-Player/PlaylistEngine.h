@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// SoundMenuKey track order, kept apart from the game types so it can be tested off
+// Windows. Standard library only, like GainStage.h.
+//
+// Track order over dense IDs [0, size). Everything except the weighted history is a
+// pure function of (seed, cursor), so next/previous are O(1) and a playlist resumes
+// from two integers. Shuffle walks a keyed Feistel permutation that changes every
+// cycle; weighted draws from a Vose alias table.
+enum class PlaylistOrder { Sequential, Shuffle, Weighted };
+
+class PlaylistEngine {
+public:
+    static constexpr uint32_t kMaxNoRepeat = 16;
+
+    void Reset(uint32_t count, PlaylistOrder newOrder, uint64_t newSeed, uint32_t noRepeat,
+               const std::vector<double>& weights = {}) {
+        size = count;
+        order = newOrder;
+        seed = newSeed;
+        cursor = 0;
+        window = std::min<uint32_t>(noRepeat, kMaxNoRepeat);
+        history.clear();
+        halfBits = 1;
+        while ((uint64_t(1) << (halfBits * 2)) < size) halfBits++;
+        BuildAliasTable(order == PlaylistOrder::Weighted ? weights : std::vector<double>());
+    }
+
+    void Restore(uint64_t savedCursor) {
+        cursor = savedCursor;
+        history.clear();
+    }
+
+    uint32_t Next() {
+        if (size == 0) return 0;
+        uint32_t id = order == PlaylistOrder::Weighted ? DrawWeighted(cursor) : At(cursor);
+        cursor++;
+        if (order == PlaylistOrder::Weighted) {
+            history.push_back(id);
+            if (history.size() > kHistory) history.pop_front();
+        }
+        return id;
+    }
+
+    // Takes back the last Next(), so the same track is drawn again.
+    void Unwind() {
+        if (cursor == 0) return;
+        cursor--;
+        if (order == PlaylistOrder::Weighted && !history.empty()) history.pop_back();
+    }
+
+    // Steps back so the track before the current one becomes current again.
+    uint32_t Previous() {
+        if (size == 0) return 0;
+        if (cursor == 0) return Next();
+        if (cursor >= 2) cursor--;
+        if (order != PlaylistOrder::Weighted) return At(cursor - 1);
+        if (history.size() >= 2) history.pop_back();
+        return history.empty() ? DrawWeighted(cursor - 1) : history.back();
+    }
+
+    uint32_t Size() const { return size; }
+    uint64_t Seed() const { return seed; }
+    uint64_t Cursor() const { return cursor; }
+    uint32_t Position() const { return size ? static_cast<uint32_t>((cursor + size - 1) % size) + 1 : 0; }
+
+private:
+    static constexpr size_t kHistory = 64;
+
+    static uint64_t Mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // Four Feistel rounds over 2*halfBits bits, cycle-walking until the value lands in
+    // [0, size). The domain is at most 4x the size, so the expected walk is short.
+    uint32_t Permute(uint32_t index, uint64_t key) const {
+        const uint64_t mask = (uint64_t(1) << halfBits) - 1;
+        uint64_t value = index;
+        do {
+            uint64_t left = value >> halfBits;
+            uint64_t right = value & mask;
+            for (uint64_t round = 0; round < 4; ++round) {
+                uint64_t next = left ^ (Mix(key ^ (round << 56) ^ right) & mask);
+                left = right;
+                right = next;
+            }
+            value = (left << halfBits) | right;
+        } while (value >= size);
+        return static_cast<uint32_t>(value);
+    }
+
+    uint32_t Effective() const { return std::min<uint32_t>(window, size / 3); }
+
+    // Shuffle with the no-repeat window applied across cycle boundaries: any of the
+    // first W slots of a cycle holding one of the previous cycle's last W tracks is
+    // swapped with the nearest clean slot in the middle of the cycle. Tail slots are
+    // never touched, so each cycle's fix-ups depend only on its predecessor.
+    uint32_t At(uint64_t k) const {
+        if (order == PlaylistOrder::Sequential) return static_cast<uint32_t>(k % size);
+
+        uint64_t cycle = k / size;
+        uint32_t slot = static_cast<uint32_t>(k % size);
+        uint64_t key = Mix(seed ^ Mix(cycle));
+        uint32_t w = Effective();
+        if (cycle == 0 || w == 0 || (slot >= w && slot >= size - w)) {
+            return Permute(slot, key);
+        }
+
+        std::array<uint32_t, kMaxNoRepeat> tail{};
+        uint64_t previousKey = Mix(seed ^ Mix(cycle - 1));
+        for (uint32_t i = 0; i < w; ++i) tail[i] = Permute(size - 1 - i, previousKey);
+        auto inTail = [&](uint32_t id) { return std::find(tail.begin(), tail.begin() + w, id) != tail.begin() + w; };
+
+        uint32_t probe = w;
+        for (uint32_t head = 0; head < w; ++head) {
+            uint32_t id = Permute(head, key);
+            if (!inTail(id)) continue;
+            uint32_t replacement = Permute(probe, key);
+            while (inTail(replacement)) replacement = Permute(++probe, key);
+            if (slot == head) return replacement;
+            if (slot == probe) return id;
+            probe++;
+        }
+        return Permute(slot, key);
+    }
+
+    uint32_t DrawWeighted(uint64_t k) const {
+        uint32_t w = std::min<uint32_t>(window, size - 1);
+        auto recent = [&](uint32_t id) {
+            auto first = history.end() - std::min<size_t>(w, history.size());
+            return std::find(first, history.end(), id) != history.end();
+        };
+        uint32_t id = 0;
+        for (uint64_t attempt = 0; attempt < 8; ++attempt) {
+            uint64_t r = Mix(seed ^ Mix(k ^ (attempt << 58)));
+            uint32_t column = static_cast<uint32_t>((r >> 32) % size);
+            double coin = static_cast<double>(r & 0xFFFFFFFFull) / 4294967296.0;
+            id = coin < aliasProbability[column] ? column : aliasIndex[column];
+            if (!recent(id)) return id;
+        }
+        // A few heavy tracks can keep winning the draw; fall back to the next clean ID.
+        while (recent(id)) id = (id + 1) % size;
+        return id;
+    }
+
+    void BuildAliasTable(const std::vector<double>& weights) {
+        aliasProbability.assign(size, 1.0);
+        aliasIndex.resize(size);
+        for (uint32_t i = 0; i < size; ++i) aliasIndex[i] = i;
+        if (weights.size() != size || size == 0) return;
+
+        double total = 0.0;
+        for (double weight : weights) total += std::max(weight, 0.0);
+        if (total <= 0.0) return;
+
+        std::vector<double> scaled(size);
+        std::vector<uint32_t> small;
+        std::vector<uint32_t> large;
+        for (uint32_t i = 0; i < size; ++i) {
+            scaled[i] = std::max(weights[i], 0.0) * size / total;
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            uint32_t lo = small.back();
+            small.pop_back();
+            uint32_t hi = large.back();
+            aliasProbability[lo] = scaled[lo];
+            aliasIndex[lo] = hi;
+            scaled[hi] -= 1.0 - scaled[lo];
+            if (scaled[hi] < 1.0) {
+                large.pop_back();
+                small.push_back(hi);
+            }
+        }
+    }
+
+    uint32_t size = 0;
+    PlaylistOrder order = PlaylistOrder::Sequential;
+    uint64_t seed = 0;
+    uint64_t cursor = 0;
+    uint32_t window = 0;
+    uint32_t halfBits = 1;
+    std::vector<float> aliasProbability;
+    std::vector<uint32_t> aliasIndex;
+    std::deque<uint32_t> history;
+};
@@ -9,19 +9,38 @@
 #include <endpointvolume.h>
 #include <Psapi.h>
 #include "bass.h"
+#include "OSoundtracks_API.h"
+#include "AudioBackend.h"
+#include "GameMusic.h"
+#include "LoudnessMeter.h"
+#include "FragmentMatcher.h"
+#include "PlaylistEngine.h"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <cctype>
 #include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <random>
+#include <cmath>
 #include <ctime>
 #include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
+#include <list>
 #include <mutex>
+#include <new>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <map>
 #include <set>
@@ -57,6 +76,234 @@ struct SoundConfigMultiple {
     SoundConfigMultiple() : repeatDelaySeconds(0) {}
 };
 
+struct StringViewHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+};
+
+static constexpr uint32_t kNoAnimationId = UINT32_MAX;
+static constexpr uint32_t kStaleAnimationId = UINT32_MAX - 1;
+
+// Per-ID view of a SoundKey entry; options live in SoundTables::animationOptions.
+struct AnimationEntry {
+    uint32_t optionOffset = 0;
+    uint32_t optionCount = 0;
+    uint32_t familyId = kNoAnimationId;
+    int repeatDelaySeconds = 0;
+};
+
+// Parsed contents of OSoundtracks-SA-Expansion-Sounds-NG.json. Built by the mappings
+// loader thread and frozen before publication; readers only ever see complete tables.
+struct SoundTables {
+    std::unordered_map<std::string, SoundConfigMultiple> animation;
+    std::unordered_map<std::string, SoundConfigMultiple> effect;
+    std::unordered_map<std::string, SoundConfigMultiple> position;
+    std::unordered_map<std::string, SoundConfigMultiple> tag;
+    std::unordered_map<std::string, std::vector<SoundOption>> soundMenuKey;
+    std::vector<std::string> soundMenuKeyTracks;
+    std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> soundMenuKeyRanges;
+    std::vector<std::string> animationNames;
+    std::vector<AnimationEntry> animationEntries;
+    std::vector<SoundOption> animationOptions;
+    std::unordered_map<std::string, uint32_t, StringViewHash, std::equal_to<>> animationIds;
+    std::vector<std::string> positionFragments;
+    std::vector<const SoundConfigMultiple*> positionConfigs;
+    std::unordered_map<std::string, uint32_t> positionFragmentIds;
+    FragmentMatcher positionMatcher;
+    fs::file_time_type jsonWriteTime{};
+    uint64_t generation = 0;
+
+    uint32_t FindAnimationId(std::string_view name) const {
+        auto it = animationIds.find(name);
+        return it != animationIds.end() ? it->second : kNoAnimationId;
+    }
+};
+
+struct SoundFileEntry {
+    fs::path path;
+    std::string extension;
+    uintmax_t size = 0;
+};
+
+// Case-insensitive view of the sounds directory tree, keyed by lowercase path relative
+// to the sounds folder with '/' separators. byStem keeps the preferred format only
+// (wav > mp3 > ogg), matching the probing order FindSoundFile always used.
+struct SoundFileIndex {
+    std::unordered_map<std::string, SoundFileEntry> byName;
+    std::unordered_map<std::string, SoundFileEntry> byStem;
+    fs::path root;
+    bool valid = false;
+};
+
+// ========================================
+// Snapshot Publication - Epoch-Based Reclamation
+// ========================================
+// Readers pin the global epoch in a per-thread slot while they hold a snapshot and
+// never take a lock. The writer swaps the pointer, bumps the epoch and frees a
+// retired snapshot only once no slot is pinned at or before its retire epoch.
+class EpochDomain {
+public:
+    static constexpr size_t kMaxReaderSlots = 64;
+
+    static EpochDomain& GetSingleton() {
+        static EpochDomain singleton;
+        return singleton;
+    }
+
+    void Enter() {
+        auto& local = LocalReader();
+        if (local.depth++ > 0) {
+            return;
+        }
+        if (local.slot < 0) {
+            local.slot = ClaimSlot();
+        }
+        uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+        if (local.slot >= 0) {
+            slots[local.slot].epoch.store(epoch, std::memory_order_seq_cst);
+        } else {
+            overflowReaders.fetch_add(1, std::memory_order_seq_cst);
+        }
+    }
+
+    void Leave() {
+        auto& local = LocalReader();
+        if (--local.depth > 0) {
+            return;
+        }
+        if (local.slot >= 0) {
+            slots[local.slot].epoch.store(0, std::memory_order_release);
+        } else {
+            overflowReaders.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // Returns the epoch a just-unpublished object belongs to.
+    uint64_t Advance() { return globalEpoch.fetch_add(1, std::memory_order_seq_cst); }
+
+    bool IsQuiescent(uint64_t retireEpoch) const {
+        if (overflowReaders.load(std::memory_order_seq_cst) != 0) {
+            return false;
+        }
+        for (const auto& slot : slots) {
+            uint64_t pinned = slot.epoch.load(std::memory_order_seq_cst);
+            if (pinned != 0 && pinned <= retireEpoch) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> claimed{false};
+    };
+
+    struct ThreadReader {
+        int slot = -1;
+        int depth = 0;
+
+        ~ThreadReader() {
+            if (slot >= 0) {
+                EpochDomain::GetSingleton().ReleaseSlot(slot);
+            }
+        }
+    };
+
+    static ThreadReader& LocalReader() {
+        thread_local ThreadReader reader;
+        return reader;
+    }
+
+    int ClaimSlot() {
+        for (size_t i = 0; i < kMaxReaderSlots; ++i) {
+            bool expected = false;
+            if (slots[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    void ReleaseSlot(int slot) {
+        slots[slot].epoch.store(0, std::memory_order_release);
+        slots[slot].claimed.store(false, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> globalEpoch{1};
+    std::atomic<uint32_t> overflowReaders{0};
+    std::array<ReaderSlot, kMaxReaderSlots> slots{};
+};
+
+template <typename T>
+class RcuReadGuard {
+public:
+    explicit RcuReadGuard(const std::atomic<const T*>& source) {
+        EpochDomain::GetSingleton().Enter();
+        snapshot = source.load(std::memory_order_seq_cst);
+    }
+
+    ~RcuReadGuard() { EpochDomain::GetSingleton().Leave(); }
+
+    RcuReadGuard(const RcuReadGuard&) = delete;
+    RcuReadGuard& operator=(const RcuReadGuard&) = delete;
+
+    const T* operator->() const { return snapshot; }
+    const T& operator*() const { return *snapshot; }
+
+private:
+    const T* snapshot = nullptr;
+};
+
+template <typename T>
+class RcuCell {
+public:
+    explicit RcuCell(std::unique_ptr<T> initial) : current(initial.release()) {}
+
+    ~RcuCell() {
+        delete current.load();
+        for (auto& entry : retired) {
+            delete entry.second;
+        }
+    }
+
+    RcuReadGuard<T> Read() const { return RcuReadGuard<T>(current); }
+
+    // Single writer at a time; readers are never blocked by a publish.
+    void Publish(std::unique_ptr<T> next) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        const T* previous = current.exchange(next.release(), std::memory_order_seq_cst);
+        retired.emplace_back(EpochDomain::GetSingleton().Advance(), previous);
+        ReclaimLocked();
+    }
+
+    size_t Reclaim() {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        return ReclaimLocked();
+    }
+
+private:
+    size_t ReclaimLocked() {
+        size_t freed = 0;
+        auto& domain = EpochDomain::GetSingleton();
+        for (auto it = retired.begin(); it != retired.end();) {
+            if (domain.IsQuiescent(it->first)) {
+                delete it->second;
+                it = retired.erase(it);
+                ++freed;
+            } else {
+                ++it;
+            }
+        }
+        return freed;
+    }
+
+    std::atomic<const T*> current;
+    std::mutex writerMutex;
+    std::vector<std::pair<uint64_t, const T*>> retired;
+};
+
 enum ScriptType { SCRIPT_BASE, SCRIPT_SPECIFIC, SCRIPT_MENU, SCRIPT_CHECK, SCRIPT_EFFECT, SCRIPT_POSITION, SCRIPT_TAG };
 
 struct ScriptState {
@@ -82,8 +329,6 @@ struct ScriptState {
 
 static std::ofstream g_soundPlayerLog;
 static std::ofstream g_actionsLog;
-static std::deque<std::string> g_heartbeatLines;
-static std::deque<std::string> g_actionLines;
 static std::string g_documentsPath;
 static std::string g_gamePath;
 static bool g_isInitialized = false;
@@ -94,12 +339,18 @@ static std::thread g_monitorThread;
 static int g_monitorCycles = 0;
 static std::unordered_set<std::string> g_processedLines;
 static size_t g_lastFileSize = 0;
-static std::string g_lastAnimation = "";
 
-static std::unordered_map<std::string, SoundConfigMultiple> g_animationSoundMap;
-static std::unordered_map<std::string, SoundConfigMultiple> g_effectSoundMap;
-static std::unordered_map<std::string, SoundConfigMultiple> g_positionSoundMap;
-static std::unordered_map<std::string, SoundConfigMultiple> g_tagSoundMap;
+static RcuCell<SoundTables> g_soundTables(std::make_unique<SoundTables>());
+static std::atomic<uint64_t> g_soundTablesGeneration(0);
+static std::mutex g_soundTablesPublishMutex;
+static std::condition_variable g_soundTablesPublished;
+static fs::path g_soundMappingsJsonPath;
+static RcuCell<SoundFileIndex> g_soundFileIndex(std::make_unique<SoundFileIndex>());
+static std::thread g_soundIndexThread;
+static std::atomic<bool> g_soundIndexActive(false);
+static HANDLE g_soundIndexStopEvent = nullptr;
+static std::thread g_mappingsLoaderThread;
+static std::atomic<bool> g_mappingsLoaderActive(false);
 
 static ScriptState g_baseScript;
 static ScriptState g_menuScript;
@@ -113,32 +364,40 @@ static bool g_initialDelayComplete = false;
 static std::atomic<bool> g_isShuttingDown(false);
 
 static std::atomic<bool> g_pauseMonitoring(false);
+static std::atomic<bool> g_replayRunning(false);
+static std::mutex g_monitorCycleMutex;
+static std::mutex g_replayMutex;
+static std::string g_replaySession;
+static float g_replaySpeed = 1.0f;
+static uint32_t g_replayLoops = 1;
+static std::atomic<uint64_t> g_monitorCpuCycles(0);
+static std::atomic<uint64_t> g_monitorTimedCycles(0);
 static bool g_activationMessageShown = false;
 
 static std::thread g_heartbeatThread;
 static std::atomic<bool> g_heartbeatActive(false);
+static std::atomic<uint32_t> g_latencyStatsSeconds(30);
 
-static std::string g_currentBaseAnimation = "";
-static std::string g_currentSpecificAnimation = "";
 static std::string g_currentPositionFragment = "";
 
 static std::atomic<bool> g_startupSoundEnabled(true);
 static std::atomic<bool> g_topNotificationsVisible(true);
-static std::time_t g_lastIniCheckTime = 0;
 static fs::path g_iniPath;
 static std::thread g_iniMonitorThread;
 static std::atomic<bool> g_monitoringIni(false);
+static HANDLE g_iniStopEvent = nullptr;
+
+// The INI as LoadIniSettings last applied it: every [Section] Key=Value, trimmed, and the
+// file's write time at that read. The watcher diffs the file against this before it
+// reloads anything. Only LoadIniSettings and the watcher touch these, and the watcher
+// starts after the first load.
+using IniValues = std::map<std::pair<std::string, std::string>, std::string>;
+static IniValues g_iniAppliedValues;
+static fs::file_time_type g_iniAppliedWriteTime{};
 
 static std::atomic<bool> g_soundsPaused(false);
 static std::mutex g_pauseMutex;
 
-static bool g_baseWasActiveBeforePause = false;
-static bool g_menuWasActiveBeforePause = false;
-static bool g_specificWasActiveBeforePause = false;
-static bool g_positionWasActiveBeforePause = false;
-static bool g_effectWasActiveBeforePause = false;
-static bool g_tagWasActiveBeforePause = false;
-
 static std::unordered_map<std::string, std::string> g_activeMenuSounds;
 static std::unordered_map<std::string, PROCESS_INFORMATION> g_menuSoundProcesses;
 static std::mutex g_menuSoundMutex;
@@ -147,7 +406,6 @@ static std::vector<std::string> g_baseTracks;
 static std::vector<std::string> g_specificTracks;
 static std::vector<std::string> g_menuTracks;
 
-static std::unordered_map<std::string, std::chrono::steady_clock::time_point> g_lastPlayTime;
 static std::mutex g_throttleMutex;
 
 static bool g_usingDllPath = false;
@@ -164,28 +422,60 @@ static std::atomic<float> g_tagVolume(1.0f);
 static std::atomic<float> g_soundMenuKeyVolume(1.0f);
 static std::atomic<bool> g_volumeControlEnabled(true);
 
+static std::atomic<bool> g_sampleCacheEnabled(true);
+static std::atomic<uint32_t> g_sampleCacheMaxClipKB(1024);
+static std::atomic<float> g_sampleCacheMaxClipSeconds(15.0f);
+static std::atomic<uint32_t> g_sampleCacheBudgetMB(64);
+static std::atomic<bool> g_prefetchEnabled(true);
+static std::atomic<uint32_t> g_prefetchTopK(3);
+static std::atomic<bool> g_loudnessEnabled(true);
+static std::atomic<float> g_loudnessTargetLufs(-18.0f);
+static std::atomic<float> g_loudnessMaxBoostDb(6.0f);
+
+// ===================================================================
+// SoundMenuKey playlist
+// ===================================================================
+
+// The track order itself comes from PlaylistEngine.h; this is the state around it.
+
 enum class SoundMenuKeyMode {
     DISABLED,
     ALL_ORDER,
     ALL_RANDOM,
+    ALL_WEIGHTED,
     AUTHOR_ORDER,
     AUTHOR_RANDOM
 };
 
-static std::unordered_map<std::string, std::vector<SoundOption>> g_soundMenuKeyMap;
+struct SoundMenuKeyPlaylistState {
+    uint64_t fingerprint = 0;
+    uint64_t seed = 0;
+    uint64_t cursor = 0;
+};
+
 static SoundMenuKeyMode g_soundMenuKeyMode = SoundMenuKeyMode::DISABLED;
 static std::string g_soundMenuKeyAuthor = "";
-static std::vector<std::string> g_soundMenuKeyPlaylist;
-static size_t g_soundMenuKeyCurrentIndex = 0;
+static PlaylistEngine g_soundMenuKeyPlaylist;
+static uint32_t g_soundMenuKeyFirstTrack = 0;
+static uint64_t g_soundMenuKeyGeneration = 0;
+static uint64_t g_soundMenuKeyFingerprint = 0;
+static std::string g_soundMenuKeyStateKey;
+static std::atomic<uint32_t> g_soundMenuKeyNoRepeat(3);
+static std::map<std::string, SoundMenuKeyPlaylistState> g_soundMenuKeyStates;
+static bool g_soundMenuKeyStatesLoaded = false;
+// Advances only mark the states dirty; SaveSoundMenuKeyStates writes them from the
+// heartbeat thread, on stop and at shutdown, never from the audio thread.
+static bool g_soundMenuKeyStatesDirty = false;
+static fs::path g_soundMenuKeyStatePath;
 static std::atomic<bool> g_soundMenuKeyActive(false);
 static std::atomic<bool> g_soundMenuKeyPaused(false);
 static std::string g_currentSoundMenuKeyTrack = "";
 static std::mutex g_soundMenuKeyMutex;
-static std::thread g_soundMenuKeyMonitorThread;
-static std::atomic<bool> g_soundMenuKeyMonitorActive(false);
-static bool g_soundMenuKeyWasActiveBeforePause = false;
+// Set while the gapless preload holds a drawn track that has not been heard yet. The next
+// manual advance takes that same track; a discarded preload hands its draw back.
+static bool g_soundMenuKeyReserved = false;
 
-static HSTREAM g_authorPreviewStream = 0;
+static AudioHandle g_authorPreviewStream = 0;
 static std::string g_lastAuthorName = "";
 static std::atomic<bool> g_previewPlaying(false);
 static std::thread g_previewTimerThread;
@@ -200,11 +490,11 @@ static std::atomic<bool> g_backupUpdateEnabled(false);
 static std::atomic<bool> g_muteGameMusicDuringOStim(true);
 static std::string g_muteMusicCode = "0010486c";
 static float g_originalMusicVolume = 1.0f;
-static bool g_gameMusicMuted = false;
+static std::atomic<bool> g_gameMusicMuted(false);
 static std::atomic<bool> g_muteGameMusicDuringOStim_snapshot(true);
 
-static std::unordered_map<RE::BGSMusicType*, RE::BSTArray<RE::BSIMusicTrack*>> g_originalMusicTracks;
-static bool g_musicTracksCleared = false;
+static std::atomic<bool> g_musicTracksCleared(false);
+static std::atomic<uint64_t> g_musicMuteGeneration(0);
 
 // ========================================
 // BASS Audio Library - Global Variables
@@ -213,17 +503,128 @@ static HMODULE g_bassModule = nullptr;
 static bool g_bassInitialized = false;
 static std::mutex g_bassMutex;
 
-static HSTREAM g_baseStream = 0;
-static HSTREAM g_menuStream = 0;
-static HSTREAM g_specificStream = 0;
-static HSTREAM g_effectStream = 0;
-static HSTREAM g_positionStream = 0;
-static HSTREAM g_tagStream = 0;
-static HSTREAM g_soundMenuKeyStream = 0;
+static std::atomic<uint32_t> g_crossfadeMs(250);
+
+// ========================================
+// Scene Contexts
+// ========================================
+// One SceneContext per OStim thread; thread 0 is the player's scene, NPC scenes run on
+// the others. Each keeps its own node, the base and specific sounds it picked, its
+// repeat throttles and its active position fragments, so concurrent scenes no longer
+// overwrite each other. [Audio Engine] ScenePolicy decides what is heard:
+//   player - only the player's scene is heard; NPC scenes are tracked silently
+//   latest - the scene that last changed node is heard
+//   npc-ducked - the player's scene is heard, and every NPC scene is mixed under it
+//                at SceneDuckVolume
+// The audible scene plays on the live channels. When it changes, the old one's sounds
+// stop and the new one's current node starts from scratch. A mixed NPC scene plays on
+// its own AudioOutput instead, so its streams never replace the player's; it leaves the
+// SoundMenuKey alone, and the OStim group and the voice budget cover it like the live
+// output. Only the monitor thread (or the replay) touches contexts.
+
+static constexpr int kPlayerSceneThread = 0;
+
+struct AudioOutput;
+
+struct SceneContext {
+    int thread = kPlayerSceneThread;
+    std::string lastAnimation;
+    uint64_t lastChangeTick = 0;
+    std::string currentBaseAnimation;
+    std::string currentSpecificAnimation;
+    uint32_t currentFamilyId = kNoAnimationId;
+    uint32_t currentSpecificId = kNoAnimationId;
+    uint64_t animationStateGeneration = 0;
+    std::vector<std::chrono::steady_clock::time_point> lastPlayTimes;  // g_throttleMutex
+    FragmentSet activePositionFragments;
+    uint64_t activePositionGeneration = 0;
+    uint64_t positionEpoch = 0;
+    AudioOutput* output = nullptr;  // own output while mixed (npc-ducked); else null
+};
+
+enum class ScenePolicy { Player, Latest, NpcDucked };
+
+static std::map<int, SceneContext> g_scenes;
+static SceneContext* g_audibleScene = nullptr;
+static uint64_t g_sceneChangeTick = 0;
+static std::atomic<ScenePolicy> g_scenePolicy(ScenePolicy::Player);
+static std::atomic<float> g_sceneDuckVolume(0.4f);
+static std::atomic<bool> g_scenePolicyChanged(false);
+
+const char* ScenePolicyName(ScenePolicy policy) {
+    switch (policy) {
+        case ScenePolicy::Latest: return "latest";
+        case ScenePolicy::NpcDucked: return "npc-ducked";
+        default: return "player";
+    }
+}
+
+float LoudnessTrimFor(const fs::path& soundPath);
+float SceneGain();
+
+float PositionLayerVolume() {
+    return (g_volumeControlEnabled.load() ? g_positionVolume.load() : 1.0f) * SceneGain();
+}
+
+// Short clips decoded once into BASS samples; channels are created from memory on every
+// play. Guarded by g_sampleCacheMutex, which may be taken while g_bassMutex is held but
+// never the other way around.
+struct SampleCacheEntry {
+    AudioSample sample = 0;
+    uint64_t bytes = 0;
+    std::list<std::wstring>::iterator lruIt;
+};
 
-static std::map<std::string, std::map<int, HSTREAM>> g_positionStreams;
-static std::set<std::string> g_activePositionFragments;
-static std::map<std::string, std::map<int, bool>> g_positionLayersActiveBeforePause;
+static std::unordered_map<std::wstring, SampleCacheEntry> g_sampleCache;
+static std::list<std::wstring> g_sampleCacheLru;
+static std::unordered_set<std::wstring> g_sampleCacheRejected;
+static std::mutex g_sampleCacheMutex;
+static uint64_t g_sampleCacheBytes = 0;
+static uint64_t g_sampleCacheHits = 0;
+static uint64_t g_sampleCacheMisses = 0;
+static uint64_t g_sampleCacheEvictions = 0;
+
+// Prefetcher state; everything except the thread handle is guarded by g_prefetchMutex.
+static std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>> g_transitionCounts;
+static std::vector<std::string> g_lastPredictions;
+static std::deque<std::string> g_prefetchQueue;
+static std::mutex g_prefetchMutex;
+static std::condition_variable g_prefetchCondition;
+static std::thread g_prefetchThread;
+static std::atomic<bool> g_prefetchActive(false);
+static fs::path g_transitionTablePath;
+static uint64_t g_prefetchPredicted = 0;
+static uint64_t g_prefetchHits = 0;
+static std::atomic<uint64_t> g_prefetchWarmedSamples(0);
+static std::atomic<uint64_t> g_prefetchWarmedFiles(0);
+static uint32_t g_transitionsSinceSave = 0;
+
+// Loudness analyzer state; everything but the decode lock and epoch is guarded by
+// g_loudnessMutex. Keys are UTF-8 absolute paths.
+struct LoudnessInfo {
+    uint64_t size = 0;
+    int64_t writeTime = 0;
+    float lufs = 0.0f;
+    float truePeakDb = 0.0f;
+};
+static std::unordered_map<std::string, LoudnessInfo> g_loudnessCache;
+static std::unordered_set<std::string> g_loudnessChecked;  // compared against disk this session
+static std::unordered_set<std::string> g_loudnessQueued;
+static std::deque<std::pair<std::string, fs::path>> g_loudnessQueue;
+static std::mutex g_loudnessMutex;
+static std::condition_variable g_loudnessCondition;
+static std::vector<std::thread> g_loudnessWorkers;
+static std::atomic<bool> g_loudnessActive(false);
+static fs::path g_loudnessCachePath;
+static uint32_t g_loudnessInFlight = 0;
+static bool g_loudnessDirty = false;
+static uint64_t g_loudnessAnalyzed = 0;
+static uint64_t g_loudnessUnchanged = 0;
+static uint64_t g_loudnessFailed = 0;
+// Held by a worker around each decoder call. ShutdownBASSLibrary takes it before the
+// backend goes away and bumps the epoch, so a decoder from the old backend is dropped.
+static std::mutex g_loudnessDecodeMutex;
+static uint64_t g_audioBackendEpoch = 0;
 
 // BASS Function Pointers
 typedef BOOL(WINAPI* BASS_Init_t)(int, DWORD, DWORD, HWND, void*);
@@ -235,7 +636,26 @@ typedef BOOL(WINAPI* BASS_ChannelStop_t)(DWORD);
 typedef BOOL(WINAPI* BASS_ChannelPause_t)(DWORD);
 typedef BOOL(WINAPI* BASS_StreamFree_t)(DWORD);
 typedef BOOL(WINAPI* BASS_ChannelSetAttribute_t)(DWORD, DWORD, float);
+typedef BOOL(WINAPI* BASS_ChannelGetAttribute_t)(DWORD, DWORD, float*);
 typedef DWORD(WINAPI* BASS_ChannelIsActive_t)(DWORD);
+typedef HSAMPLE(WINAPI* BASS_SampleLoad_t)(BOOL, const void*, QWORD, DWORD, DWORD, DWORD);
+typedef BOOL(WINAPI* BASS_SampleFree_t)(HSAMPLE);
+typedef DWORD(WINAPI* BASS_SampleGetChannel_t)(HSAMPLE, DWORD);
+typedef BOOL(WINAPI* BASS_SampleGetInfo_t)(HSAMPLE, BASS_SAMPLE*);
+typedef DWORD(WINAPI* BASS_SampleGetChannels_t)(HSAMPLE, HCHANNEL*);
+typedef DWORD(WINAPI* BASS_ChannelFlags_t)(DWORD, DWORD, DWORD);
+typedef BOOL(WINAPI* BASS_ChannelSlideAttribute_t)(DWORD, DWORD, float, DWORD);
+typedef HSYNC(WINAPI* BASS_ChannelSetSync_t)(DWORD, DWORD, QWORD, SYNCPROC*, void*);
+typedef QWORD(WINAPI* BASS_ChannelGetLength_t)(DWORD, DWORD);
+typedef QWORD(WINAPI* BASS_ChannelSeconds2Bytes_t)(DWORD, double);
+typedef BOOL(WINAPI* BASS_ChannelUpdate_t)(DWORD, DWORD);
+typedef QWORD(WINAPI* BASS_ChannelGetPosition_t)(DWORD, DWORD);
+typedef double(WINAPI* BASS_ChannelBytes2Seconds_t)(DWORD, QWORD);
+typedef BOOL(WINAPI* BASS_ChannelGetInfo_t)(DWORD, BASS_CHANNELINFO*);
+typedef DWORD(WINAPI* BASS_ChannelGetData_t)(DWORD, void*, DWORD);
+typedef float(WINAPI* BASS_GetCPU_t)();
+typedef BOOL(WINAPI* BASS_SetConfig_t)(DWORD, DWORD);
+typedef HDSP(WINAPI* BASS_ChannelSetDSP_t)(DWORD, DSPPROC*, void*, int);
 
 static BASS_Init_t pBASS_Init = nullptr;
 static BASS_Free_t pBASS_Free = nullptr;
@@ -246,500 +666,3457 @@ static BASS_ChannelStop_t pBASS_ChannelStop = nullptr;
 static BASS_ChannelPause_t pBASS_ChannelPause = nullptr;
 static BASS_StreamFree_t pBASS_StreamFree = nullptr;
 static BASS_ChannelSetAttribute_t pBASS_ChannelSetAttribute = nullptr;
+static BASS_ChannelGetAttribute_t pBASS_ChannelGetAttribute = nullptr;
 static BASS_ChannelIsActive_t pBASS_ChannelIsActive = nullptr;
+static BASS_SampleLoad_t pBASS_SampleLoad = nullptr;
+static BASS_SampleFree_t pBASS_SampleFree = nullptr;
+static BASS_SampleGetChannel_t pBASS_SampleGetChannel = nullptr;
+static BASS_SampleGetInfo_t pBASS_SampleGetInfo = nullptr;
+static BASS_SampleGetChannels_t pBASS_SampleGetChannels = nullptr;
+static BASS_ChannelFlags_t pBASS_ChannelFlags = nullptr;
+static BASS_ChannelSlideAttribute_t pBASS_ChannelSlideAttribute = nullptr;
+static BASS_ChannelSetSync_t pBASS_ChannelSetSync = nullptr;
+static BASS_ChannelGetLength_t pBASS_ChannelGetLength = nullptr;
+static BASS_ChannelSeconds2Bytes_t pBASS_ChannelSeconds2Bytes = nullptr;
+static BASS_ChannelUpdate_t pBASS_ChannelUpdate = nullptr;
+static BASS_ChannelGetPosition_t pBASS_ChannelGetPosition = nullptr;
+static BASS_ChannelBytes2Seconds_t pBASS_ChannelBytes2Seconds = nullptr;
+static BASS_ChannelGetInfo_t pBASS_ChannelGetInfo = nullptr;
+static BASS_ChannelGetData_t pBASS_ChannelGetData = nullptr;
+static BASS_GetCPU_t pBASS_GetCPU = nullptr;
+static BASS_SetConfig_t pBASS_SetConfig = nullptr;
+static BASS_ChannelSetDSP_t pBASS_ChannelSetDSP = nullptr;
+
+#ifndef BASS_SAMCHAN_STREAM
+#define BASS_SAMCHAN_STREAM 2
+#endif
+
+// ========================================
+// Audio Backends
 // ========================================
+// Playback code talks to Audio() (see AudioBackend.h) instead of the BASS pointers, so
+// the same logic can run on the null backend or render offline to a WAV file. The
+// backend is chosen by [Audio Engine] Backend when the audio library is initialized.
+// BASS handles are 32-bit DWORDs, so they pass through as AudioHandle unchanged.
+class BassAudioBackend : public IAudioBackend {
+public:
+    const char* Name() const override { return "bass"; }
+    bool Initialize() override;
+    void Shutdown() override;
+    int LastError() const override { return pBASS_ErrorGetCode ? pBASS_ErrorGetCode() : -1; }
 
-void CheckAndPlaySound(const std::string& animationName);
-void CheckPositionSound(const std::string& animationName);
-void PlaySound(const std::string& soundFileName, bool waitForCompletion = true);
-void StartMonitoringThread();
-void StopMonitoringThread();
-bool LoadSoundMappings();
-std::string GetAnimationBase(const std::string& animationName);
-bool LoadIniSettings();
-void StartIniMonitoring();
-void StopIniMonitoring();
-void PlayStartupSound();
-void StopAllSounds();
-void StartHeartbeatThread();
-void StopHeartbeatThread();
-void WriteHeartbeat();
-SKSELogsPaths GetAllSKSELogsPaths();
-fs::path GetHeartbeatLogPath();
-void WriteToActionsLog(const std::string& message, int lineNumber = 0);
-void PauseAllSounds();
-void ResumeAllSounds();
-void PlayMenuSound(const std::string& menuName);
-void StopMenuSound(const std::string& menuName);
-void StopAllMenuSounds();
-void WriteToSoundPlayerLog(const std::string& message, int lineNumber = 0, bool isAnimationEntry = false);
-void ShowGameNotification(const std::string& message);
+    AudioHandle OpenStream(const fs::path& file, bool loop) override {
+        if (!pBASS_StreamCreateFile) return 0;
+        return AttachGainStage(
+            pBASS_StreamCreateFile(FALSE, file.wstring().c_str(), 0, 0, BASS_UNICODE | (loop ? BASS_SAMPLE_LOOP : 0)));
+    }
 
-void BuildSoundMenuKeyPlaylist();
-void StartSoundMenuKey();
-void StopSoundMenuKey();
-void PauseSoundMenuKey();
-void ResumeSoundMenuKey();
-void PlayNextSoundMenuKeyTrack();
-void SoundMenuKeyMonitorThreadFunction();
-void StartSoundMenuKeyMonitor();
-void StopSoundMenuKeyMonitor();
-void MuteGameMusic();
-void RestoreGameMusic();
-void ForceAudioRefresh();
-void ExecuteConsoleCommand(const std::string& command);
-std::string ToLowerCase(const std::string& str);
-void PlayAuthorPreview(const std::string& authorName);
-void StartPreviewTimer(const std::string& authorName, const std::string& songName);
-void StopAuthorPreview();
-void CreateIniBackup();
-void ProcessBackupUpdate();
+    void Free(AudioHandle handle) override {
+        if (!handle) return;
+        {
+            std::lock_guard<std::mutex> lock(gainMutex);
+            fallbackGains.erase(handle);
+        }
+        if (pBASS_StreamFree) pBASS_StreamFree(handle);
+    }
 
-void CleanOldScripts();
-void GenerateStaticScripts();
-void ClassifyAnimations();
-bool IsMenuSound(const std::string& animationName);
-bool IsSpecificSound(const std::string& animationName);
-bool IsBaseSound(const std::string& animationName);
-void StartAllScriptsFrozen();
-void StopAllScripts();
-void SendTrackCommand(ScriptType type, const std::string& trackFile);
-void PlaySoundInScript(ScriptType type, const std::string& soundFile);
-void StopScript(ScriptState& scriptState);
-void SuspendProcess(HANDLE hProcess);
-void ResumeProcess(HANDLE hProcess);
-PROCESS_INFORMATION LaunchPowerShellScript(const std::string& scriptPath);
-void CleanStopFiles();
-void GenerateBaseScript();
-void GenerateSpecificScript();
-void GenerateMenuScript();
-void GenerateCheckScript();
-void SendDebugSoundBeforeFreeze(ScriptType type, ScriptState& scriptState);
-fs::path GetDllDirectory();
-bool SetProcessVolume(DWORD processID, float volume);
+    bool Play(AudioHandle handle) override { return handle && pBASS_ChannelPlay && pBASS_ChannelPlay(handle, FALSE); }
 
-void ShowGameNotification(const std::string& message) {
-    if (g_topNotificationsVisible.load()) {
-        RE::DebugNotification(message.c_str());
-        WriteToSoundPlayerLog("IN-GAME MESSAGE SHOWN: " + message, __LINE__);
-    } else {
-        WriteToSoundPlayerLog("IN-GAME MESSAGE SUPPRESSED: " + message, __LINE__);
+    void Pause(AudioHandle handle) override {
+        if (handle && pBASS_ChannelPause) pBASS_ChannelPause(handle);
     }
-}
 
-std::string ToLowerCase(const std::string& str) {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-    return result;
-}
+    void Stop(AudioHandle handle) override {
+        if (handle && pBASS_ChannelStop) pBASS_ChannelStop(handle);
+    }
 
-// ========================================
-// BASS Audio Library - Core Functions
-// ========================================
+    AudioActivity Activity(AudioHandle handle) const override {
+        switch (handle && pBASS_ChannelIsActive ? pBASS_ChannelIsActive(handle) : BASS_ACTIVE_STOPPED) {
+            case BASS_ACTIVE_PLAYING: return AudioActivity::Playing;
+            case BASS_ACTIVE_STALLED: return AudioActivity::Stalled;
+            case BASS_ACTIVE_PAUSED:
+            case BASS_ACTIVE_PAUSED_DEVICE: return AudioActivity::Paused;
+            default: return AudioActivity::Stopped;
+        }
+    }
 
-bool InitializeBASSLibrary() {
-    std::lock_guard<std::mutex> lock(g_bassMutex);
-    
-    if (g_bassInitialized) return true;
-    
-    fs::path bassPath;
-    
-    if (g_dllDirectory.empty()) {
-        HMODULE hModule = nullptr;
-        if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-                               (LPCWSTR)&InitializeBASSLibrary, &hModule)) {
-            wchar_t dllPath[MAX_PATH];
-            if (GetModuleFileNameW(hModule, dllPath, MAX_PATH)) {
-                fs::path dllFilePath(dllPath);
-                bassPath = dllFilePath.parent_path() / "DJ_library" / "bass.dll";
+    void SetLevel(AudioHandle handle, float level) override {
+        float target;
+        {
+            std::lock_guard<std::mutex> lock(gainMutex);
+            auto it = gainStages.find(handle);
+            if (it != gainStages.end()) {
+                it->second->SetLevel(level);
+                return;
             }
+            auto fallback = fallbackGains.find(handle);
+            if (fallback == fallbackGains.end()) return;
+            fallback->second.level = level;
+            target = fallback->second.Volume();
         }
-    } else {
-        bassPath = g_dllDirectory / "DJ_library" / "bass.dll";
+        SlideAttribute(handle, target, GainStage::kRampMs);
     }
-    
-    if (bassPath.empty()) {
-        logger::error("Failed to determine bass.dll path");
-        WriteToSoundPlayerLog("BASS ERROR: Failed to determine bass.dll path", __LINE__);
-        return false;
+
+    void SetTrim(AudioHandle handle, float trim) override {
+        float target;
+        {
+            std::lock_guard<std::mutex> lock(gainMutex);
+            auto it = gainStages.find(handle);
+            if (it != gainStages.end()) {
+                it->second->SetTrim(trim);
+                return;
+            }
+            auto fallback = fallbackGains.find(handle);
+            if (fallback == fallbackGains.end()) return;
+            fallback->second.trim = trim;
+            target = fallback->second.Volume();
+        }
+        SlideAttribute(handle, target, GainStage::kRampMs);
     }
-    
-    logger::info("Attempting to load BASS from: {}", bassPath.string());
-    WriteToSoundPlayerLog("BASS: Loading from " + bassPath.string(), __LINE__);
-    
-    g_bassModule = LoadLibraryW(bassPath.wstring().c_str());
-    if (!g_bassModule) {
-        DWORD error = GetLastError();
-        logger::error("Failed to load bass.dll from: {} (error: {})", bassPath.string(), error);
-        WriteToSoundPlayerLog("BASS ERROR: Failed to load bass.dll from " + bassPath.string() + " (error: " + std::to_string(error) + ")", __LINE__);
-        return false;
+
+    void SetVolume(AudioHandle handle, float volume) override {
+        if (handle && pBASS_ChannelSetAttribute) {
+            pBASS_ChannelSetAttribute(handle, BASS_ATTRIB_VOL, FallbackVolume(handle, volume));
+        }
     }
-    
-    pBASS_Init = (BASS_Init_t)GetProcAddress(g_bassModule, "BASS_Init");
-    pBASS_Free = (BASS_Free_t)GetProcAddress(g_bassModule, "BASS_Free");
-    pBASS_ErrorGetCode = (BASS_ErrorGetCode_t)GetProcAddress(g_bassModule, "BASS_ErrorGetCode");
-    pBASS_StreamCreateFile = (BASS_StreamCreateFile_t)GetProcAddress(g_bassModule, "BASS_StreamCreateFile");
-    pBASS_ChannelPlay = (BASS_ChannelPlay_t)GetProcAddress(g_bassModule, "BASS_ChannelPlay");
-    pBASS_ChannelStop = (BASS_ChannelStop_t)GetProcAddress(g_bassModule, "BASS_ChannelStop");
-    pBASS_ChannelPause = (BASS_ChannelPause_t)GetProcAddress(g_bassModule, "BASS_ChannelPause");
-    pBASS_StreamFree = (BASS_StreamFree_t)GetProcAddress(g_bassModule, "BASS_StreamFree");
-    pBASS_ChannelSetAttribute = (BASS_ChannelSetAttribute_t)GetProcAddress(g_bassModule, "BASS_ChannelSetAttribute");
-    pBASS_ChannelIsActive = (BASS_ChannelIsActive_t)GetProcAddress(g_bassModule, "BASS_ChannelIsActive");
-    
-    if (!pBASS_Init || !pBASS_StreamCreateFile || !pBASS_ChannelPlay) {
-        logger::error("Failed to get BASS function pointers");
-        WriteToSoundPlayerLog("BASS ERROR: Failed to get function pointers", __LINE__);
-        FreeLibrary(g_bassModule);
-        g_bassModule = nullptr;
-        return false;
+
+    void SlideVolume(AudioHandle handle, float volume, uint32_t durationMs) override {
+        if (handle) SlideAttribute(handle, FallbackVolume(handle, volume), durationMs);
     }
-    
-    if (!pBASS_Init(-1, 44100, 0, nullptr, nullptr)) {
-        int error = pBASS_ErrorGetCode ? pBASS_ErrorGetCode() : -1;
-        if (error != BASS_ERROR_ALREADY) {
-            logger::error("BASS_Init failed with error: {}", error);
-            WriteToSoundPlayerLog("BASS ERROR: BASS_Init failed with error " + std::to_string(error), __LINE__);
-            FreeLibrary(g_bassModule);
-            g_bassModule = nullptr;
-            return false;
+
+    // AUTOFREE plus a slide to -1 lets BASS stop and release the handle itself when the
+    // ramp ends, on the same mixer update as any slide started alongside it.
+    void FadeOutAndFree(AudioHandle handle, uint32_t durationMs) override {
+        if (!handle) return;
+        if (durationMs > 0 && pBASS_ChannelSlideAttribute && pBASS_ChannelFlags &&
+            Activity(handle) == AudioActivity::Playing) {
+            pBASS_ChannelFlags(handle, BASS_STREAM_AUTOFREE, BASS_STREAM_AUTOFREE);
+            pBASS_ChannelSlideAttribute(handle, BASS_ATTRIB_VOL, -1.0f, durationMs);
+            return;
+        }
+        Stop(handle);
+        Free(handle);
+    }
+
+    void FadeOutAndPause(AudioHandle handle, uint32_t durationMs) override {
+        if (!handle) return;
+        if (durationMs > 0 && pBASS_ChannelSlideAttribute && pBASS_ChannelSetSync && pBASS_ChannelGetAttribute &&
+            Activity(handle) == AudioActivity::Playing) {
+            pBASS_ChannelSetSync(handle, BASS_SYNC_SLIDE | BASS_SYNC_ONETIME, 0, PauseIfSilent, nullptr);
+            pBASS_ChannelSlideAttribute(handle, BASS_ATTRIB_VOL, 0.0f, durationMs);
+            return;
+        }
+        Pause(handle);
+    }
+
+    void SetLooping(AudioHandle handle, bool loop) override {
+        if (handle && pBASS_ChannelFlags) pBASS_ChannelFlags(handle, loop ? BASS_SAMPLE_LOOP : 0, BASS_SAMPLE_LOOP);
+    }
+
+    double Length(AudioHandle handle) const override {
+        if (!handle || !pBASS_ChannelGetLength || !pBASS_ChannelBytes2Seconds) return -1.0;
+        QWORD bytes = pBASS_ChannelGetLength(handle, BASS_POS_BYTE);
+        return bytes != static_cast<QWORD>(-1) ? pBASS_ChannelBytes2Seconds(handle, bytes) : -1.0;
+    }
+
+    double Position(AudioHandle handle) const override {
+        if (!handle || !pBASS_ChannelGetPosition || !pBASS_ChannelBytes2Seconds) return -1.0;
+        QWORD bytes = pBASS_ChannelGetPosition(handle, BASS_POS_BYTE);
+        return bytes != static_cast<QWORD>(-1) ? pBASS_ChannelBytes2Seconds(handle, bytes) : -1.0;
+    }
+
+    void Prebuffer(AudioHandle handle) override {
+        if (handle && pBASS_ChannelUpdate) pBASS_ChannelUpdate(handle, 0);
+    }
+
+    bool SyncAt(AudioHandle handle, double seconds, AudioSyncProc proc) override {
+        if (!handle || !pBASS_ChannelSetSync || !pBASS_ChannelSeconds2Bytes) return false;
+        QWORD bytes = pBASS_ChannelSeconds2Bytes(handle, seconds > 0.0 ? seconds : 0.0);
+        return pBASS_ChannelSetSync(handle, BASS_SYNC_POS | BASS_SYNC_ONETIME, bytes, SyncThunk,
+                                    reinterpret_cast<void*>(proc)) != 0;
+    }
+
+    bool SyncEnd(AudioHandle handle, AudioSyncProc proc) override {
+        if (!handle || !pBASS_ChannelSetSync) return false;
+        return pBASS_ChannelSetSync(handle, BASS_SYNC_END | BASS_SYNC_MIXTIME | BASS_SYNC_ONETIME, 0, SyncThunk,
+                                    reinterpret_cast<void*>(proc)) != 0;
+    }
+
+    AudioSample LoadSample(const fs::path& file, AudioSampleInfo& info) override {
+        if (!pBASS_SampleLoad || !pBASS_SampleGetInfo) return 0;
+        HSAMPLE sample = pBASS_SampleLoad(FALSE, file.wstring().c_str(), 0, 0, 16, BASS_UNICODE);
+        if (!sample) return 0;
+
+        BASS_SAMPLE sampleInfo{};
+        pBASS_SampleGetInfo(sample, &sampleInfo);
+        DWORD bytesPerSample = (sampleInfo.flags & BASS_SAMPLE_FLOAT) ? 4 : ((sampleInfo.flags & BASS_SAMPLE_8BITS) ? 1 : 2);
+        double bytesPerSecond = static_cast<double>(sampleInfo.freq) * sampleInfo.chans * bytesPerSample;
+        info.bytes = sampleInfo.length;
+        info.seconds = bytesPerSecond > 0.0 ? sampleInfo.length / bytesPerSecond : 0.0;
+        return sample;
+    }
+
+    // Stream-type channels (BASS_SAMCHAN_STREAM) so StreamFree and attributes keep
+    // working on the handle exactly as for file streams.
+    AudioHandle SampleChannel(AudioSample sample, bool loop) override {
+        if (!sample || !pBASS_SampleGetChannel) return 0;
+        AudioHandle channel = pBASS_SampleGetChannel(sample, BASS_SAMCHAN_STREAM);
+        if (channel) SetLooping(channel, loop);
+        return AttachGainStage(channel);
+    }
+
+    bool SampleInUse(AudioSample sample) const override {
+        return pBASS_SampleGetChannels && pBASS_SampleGetChannels(sample, nullptr) > 0;
+    }
+
+    void FreeSample(AudioSample sample) override {
+        if (sample && pBASS_SampleFree) pBASS_SampleFree(sample);
+    }
+
+    AudioHandle OpenDecoder(const fs::path& file, AudioFormat& format) override {
+        if (!pBASS_StreamCreateFile || !pBASS_ChannelGetInfo) return 0;
+        HSTREAM stream = pBASS_StreamCreateFile(FALSE, file.wstring().c_str(), 0, 0,
+                                                BASS_UNICODE | BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+        if (!stream) return 0;
+
+        BASS_CHANNELINFO info{};
+        pBASS_ChannelGetInfo(stream, &info);
+        format.sampleRate = info.freq;
+        format.channels = info.chans;
+        return stream;
+    }
+
+    size_t Decode(AudioHandle handle, float* out, size_t frames) override {
+        if (!handle || !pBASS_ChannelGetData || !pBASS_ChannelGetInfo) return 0;
+        BASS_CHANNELINFO info{};
+        pBASS_ChannelGetInfo(handle, &info);
+        if (info.chans == 0) return 0;
+
+        DWORD bytes = static_cast<DWORD>(frames * info.chans * sizeof(float));
+        DWORD got = pBASS_ChannelGetData(handle, out, bytes | BASS_DATA_FLOAT);
+        return got == static_cast<DWORD>(-1) ? 0 : got / (info.chans * sizeof(float));
+    }
+
+    float TakeCpuPercent() override { return pBASS_GetCPU ? pBASS_GetCPU() : 0.0f; }
+
+private:
+    // A handle without a GainStage (no float DSP, or the attach failed) carries its
+    // level in BASS_ATTRIB_VOL under the fade, capped at 1 like before the gain stages.
+    struct FallbackGain {
+        float level = 1.0f;
+        float trim = 1.0f;
+        float fade = 1.0f;
+
+        float Volume() const { return fade * std::clamp(level * trim, 0.0f, 1.0f); }
+    };
+
+    // Records the fade target for a fallback handle and returns the attribute value
+    // that carries it; handles with a GainStage take the fade as is.
+    float FallbackVolume(AudioHandle handle, float fade) {
+        std::lock_guard<std::mutex> lock(gainMutex);
+        auto it = fallbackGains.find(handle);
+        if (it == fallbackGains.end()) return fade;
+        it->second.fade = fade;
+        return it->second.Volume();
+    }
+
+    void SlideAttribute(AudioHandle handle, float volume, uint32_t durationMs) {
+        if (pBASS_ChannelSlideAttribute) {
+            pBASS_ChannelSlideAttribute(handle, BASS_ATTRIB_VOL, volume, durationMs);
+        } else if (pBASS_ChannelSetAttribute) {
+            pBASS_ChannelSetAttribute(handle, BASS_ATTRIB_VOL, volume);
+        }
+    }
+
+    void AttachFallbackGain(AudioHandle handle) {
+        {
+            std::lock_guard<std::mutex> lock(gainMutex);
+            fallbackGains[handle] = FallbackGain{};
+        }
+        if (pBASS_ChannelSetSync) pBASS_ChannelSetSync(handle, BASS_SYNC_FREE, 0, ReleaseGainStage, this);
+    }
+
+    // Every playable handle gets its own GainStage as a DSP. The free sync releases it
+    // however the handle goes away, including AUTOFREE at the end of a fade.
+    AudioHandle AttachGainStage(AudioHandle handle) {
+        if (!handle) return handle;
+        BASS_CHANNELINFO info{};
+        if (!floatDsp || !pBASS_ChannelGetInfo(handle, &info) || info.chans == 0) {
+            AttachFallbackGain(handle);
+            return handle;
+        }
+
+        auto stage = std::make_unique<GainStage>();
+        stage->Prepare(info.freq, info.chans);
+        GainStage* raw = stage.get();
+        {
+            std::lock_guard<std::mutex> lock(gainMutex);
+            gainStages[handle] = std::move(stage);
+        }
+        if (!pBASS_ChannelSetSync(handle, BASS_SYNC_FREE, 0, ReleaseGainStage, this) ||
+            !pBASS_ChannelSetDSP(handle, GainStageDSP, raw, 0)) {
+            {
+                std::lock_guard<std::mutex> lock(gainMutex);
+                gainStages.erase(handle);
+            }
+            AttachFallbackGain(handle);
+        }
+        return handle;
+    }
+
+    static void CALLBACK GainStageDSP(HDSP, DWORD, void* buffer, DWORD length, void* user) {
+        auto* stage = static_cast<GainStage*>(user);
+        stage->Process(static_cast<float*>(buffer), length / (sizeof(float) * stage->Channels()));
+    }
+
+    static void CALLBACK ReleaseGainStage(HSYNC, DWORD channel, DWORD, void* user) {
+        auto* backend = static_cast<BassAudioBackend*>(user);
+        std::lock_guard<std::mutex> lock(backend->gainMutex);
+        backend->gainStages.erase(channel);
+        backend->fallbackGains.erase(channel);
+    }
+
+    static void CALLBACK SyncThunk(HSYNC, DWORD channel, DWORD, void* user) {
+        reinterpret_cast<AudioSyncProc>(user)(channel);
+    }
+
+    // The slide sync also fires for a resume that slid the volume back up before the
+    // fade finished, so only a slide that really ended in silence pauses.
+    static void CALLBACK PauseIfSilent(HSYNC, DWORD channel, DWORD, void*) {
+        float volume = 1.0f;
+        if (pBASS_ChannelGetAttribute(channel, BASS_ATTRIB_VOL, &volume) && volume <= 0.0f && pBASS_ChannelPause) {
+            pBASS_ChannelPause(channel);
+        }
+    }
+
+    bool floatDsp = false;
+    std::mutex gainMutex;
+    std::unordered_map<AudioHandle, std::unique_ptr<GainStage>> gainStages;
+    std::unordered_map<AudioHandle, FallbackGain> fallbackGains;
+};
+
+static BassAudioBackend g_bassBackend;
+static NullAudioBackend g_nullBackend;
+static std::unique_ptr<OfflineAudioBackend> g_offlineBackend;
+
+// Swapped only by InitializeBASSLibrary under g_bassMutex, before any handle exists.
+// Playback code goes through Audio(), which is this unless the thread plays into
+// another output (see AudioOutput).
+static IAudioBackend* g_audio = &g_nullBackend;
+static std::string g_audioBackendName = "bass";
+static std::string g_offlineRenderFile;
+
+// ========================================
+// Playback Channels
+// ========================================
+// One logical output (Base, Specific, Menu, ...) per ScriptType. Start() swaps in a
+// stream that was created outside g_bassMutex; the outgoing stream is not stopped and
+// freed inline but handed to FadeOutAndFree, so both ramps begin on the same mixer
+// update and the backend releases the old handle itself when the fade ends. Methods
+// that touch the backend run on the audio command thread with g_bassMutex held;
+// IsActive() reflects what has been posted and is safe anywhere.
+IAudioBackend* Audio();
+
+class Channel {
+public:
+    Channel(const char* name, std::atomic<float>* volumeSetting, bool followsScene)
+        : name(name), volumeSetting(volumeSetting), followsScene(followsScene) {}
+
+    const char* Name() const { return name; }
+    AudioHandle Handle() const { return stream.load(); }
+
+    // Set when a play is posted, cleared when a stop is posted or that play fails, so
+    // callers see the state their own commands will produce without waiting for them.
+    bool IsActive() const { return requested.load(); }
+
+    void MarkRequested(bool active, uint64_t sequence) {
+        requested = active;
+        lastRequest = sequence;
+    }
+
+    void PlayFailed(uint64_t sequence) {
+        if (lastRequest.load() == sequence) requested = false;
+    }
+
+    float TargetVolume() const {
+        float volume = g_volumeControlEnabled.load() ? volumeSetting->load() : 1.0f;
+        return followsScene ? volume * SceneGain() : volume;
+    }
+
+    // Takes ownership of a ready, not yet playing stream. Returns false (and frees it)
+    // if the backend refuses to play it, leaving the current track untouched.
+    bool Start(AudioHandle next, uint32_t fadeMs) {
+        AudioHandle previous = stream.load();
+        bool fade = fadeMs > 0 && IsAudible(previous);
+        float volume = TargetVolume();
+
+        Audio()->SetLevel(next, volume);
+        Audio()->SetVolume(next, fade ? 0.0f : 1.0f);
+        if (!Audio()->Play(next)) {
+            Audio()->Free(next);
+            return false;
+        }
+        if (fade) {
+            Audio()->SlideVolume(next, 1.0f, fadeMs);
+        }
+
+        stream = next;
+        Retire(previous, fadeMs);
+        return true;
+    }
+
+    void Stop(uint32_t fadeMs) { Retire(stream.exchange(0), fadeMs); }
+
+    // Takes over a stream that is already playing (gapless playlist advance); the
+    // previous one has reached its end and is released immediately.
+    void Adopt(AudioHandle playing) { Retire(stream.exchange(playing), 0); }
+
+    void Pause() const {
+        AudioHandle current = stream.load();
+        if (current) Audio()->Pause(current);
+    }
+
+    void Resume() const {
+        AudioHandle current = stream.load();
+        if (current) Audio()->Play(current);
+    }
+
+    void SetLevel(float level) const {
+        AudioHandle current = stream.load();
+        if (current) Audio()->SetLevel(current, level);
+    }
+
+private:
+    static bool IsAudible(AudioHandle handle) {
+        return handle && Audio()->Activity(handle) == AudioActivity::Playing;
+    }
+
+    static void Retire(AudioHandle handle, uint32_t fadeMs) {
+        if (handle) Audio()->FadeOutAndFree(handle, fadeMs);
+    }
+
+    const char* name;
+    std::atomic<float>* volumeSetting;
+    bool followsScene;
+    std::atomic<AudioHandle> stream{0};
+    std::atomic<bool> requested{false};
+    std::atomic<uint64_t> lastRequest{0};
+};
+
+// ========================================
+// Audio Outputs
+// ========================================
+// A set of channels and position streams with the backend they play through. The live
+// output is what the game hears, on g_audio. An NPC scene mixed under the player's has
+// its own output on g_audio too (see Scene Contexts). The replay benchmark plays into
+// its own output on its own backend, so its streams never meet live ones and g_audio is
+// never swapped while handles exist. A thread plays into t_audioOutput (null: live);
+// MakeAudioCommand copies it into the command and the audio thread switches to the
+// command's output while executing it, like the replay trace id.
+struct AudioOutput {
+    IAudioBackend* backend = nullptr;  // null: g_audio
+
+    // Indexed by ScriptType, so the order here must follow the enum.
+    std::array<Channel, 7> channels = {{
+        Channel("BASE", &g_baseVolume, true),
+        Channel("SPECIFIC", &g_specificVolume, true),
+        Channel("MENU", &g_menuVolume, false),
+        Channel("SOUNDMENUKEY", &g_soundMenuKeyVolume, false),
+        Channel("EFFECT", &g_effectVolume, true),
+        Channel("POSITION", &g_positionVolume, true),
+        Channel("TAG", &g_tagVolume, true),
+    }};
+
+    // File name each channel was last started with, and the sequence of the Play command
+    // that started it. Only the audio command thread touches these.
+    std::array<std::string, 7> tracks;
+    std::array<uint64_t, 7> startSequences{};
+
+    std::map<std::string, std::map<int, AudioHandle>> positionStreams;
+
+    // Bumped whenever the position streams are emptied outside the scene logic, so the
+    // scene playing here knows the fragments it thinks are active no longer have streams.
+    std::atomic<uint64_t> positionStreamsEpoch{0};
+
+    // Applied to the scene-driven channels and position layers; SceneDuckVolume on a
+    // mixed scene's output.
+    std::atomic<float> sceneGain{1.0f};
+
+    // Voice budget counters (see Voice Budget). Only the live output's are exported.
+    std::atomic<uint32_t> activeVoices{0};
+    std::atomic<uint32_t> peakVoices{0};
+    std::atomic<uint64_t> stolenVoices{0};
+    std::atomic<uint64_t> refusedVoiceStarts{0};
+};
+
+static AudioOutput g_liveOutput;
+static thread_local AudioOutput* t_audioOutput = nullptr;
+
+// The mixed scenes' outputs. Added by the monitor thread, removed and freed by the
+// audio thread once the commands posted into them have run. Guarded by g_bassMutex.
+static std::vector<AudioOutput*> g_sceneOutputs;
+
+AudioOutput& Output() { return t_audioOutput ? *t_audioOutput : g_liveOutput; }
+
+IAudioBackend* Audio() { return t_audioOutput && t_audioOutput->backend ? t_audioOutput->backend : g_audio; }
+
+float SceneGain() { return Output().sceneGain.load(); }
+
+// Plays a scene into its own output, if it has one, until the end of the scope.
+class SceneOutputScope {
+public:
+    explicit SceneOutputScope(const SceneContext& scene) : previous(t_audioOutput) {
+        if (scene.output) t_audioOutput = scene.output;
+    }
+    ~SceneOutputScope() { t_audioOutput = previous; }
+
+    SceneOutputScope(const SceneOutputScope&) = delete;
+    SceneOutputScope& operator=(const SceneOutputScope&) = delete;
+
+private:
+    AudioOutput* previous;
+};
+
+Channel* GetChannel(ScriptType type) {
+    size_t index = static_cast<size_t>(type);
+    auto& channels = Output().channels;
+    return index < channels.size() ? &channels[index] : nullptr;
+}
+
+// ========================================
+// Channel Groups
+// ========================================
+// Channels and loose streams that pause and resume together: OStim (Base, Specific,
+// Effect, Position, Tag, the position layers and the mixed scenes), Menu (Menu and
+// SoundMenuKey) and Preview (the author preview). A group pause records what was
+// actually playing and fades it out; resuming brings back exactly that. While a group
+// is paused, anything started in it is held paused and joins the group. Guarded by
+// g_bassMutex.
+
+enum ChannelGroup : uint32_t {
+    kGroupOStim = 1u << 0,
+    kGroupMenu = 1u << 1,
+    kGroupPreview = 1u << 2,
+    kGroupAll = kGroupOStim | kGroupMenu | kGroupPreview
+};
+
+struct ChannelGroupState {
+    bool paused = false;
+    uint32_t channels = 0;              // bit per ScriptType to resume
+    std::vector<AudioHandle> streams;   // position layers, mixed scenes or preview to resume
+};
+
+static std::array<ChannelGroupState, 3> g_channelGroups;
+static std::atomic<uint32_t> g_pauseFadeMs(150);
+
+uint32_t ChannelGroupOf(ScriptType type) {
+    return (type == SCRIPT_MENU || type == SCRIPT_CHECK) ? kGroupMenu : kGroupOStim;
+}
+
+ChannelGroupState& GetChannelGroup(uint32_t group) {
+    return g_channelGroups[std::countr_zero(group)];
+}
+// ========================================
+
+void CheckAndPlaySound(SceneContext& scene, const std::string& animationName);
+void CheckPositionSound(SceneContext& scene, const std::string& animationName, const SoundTables& tables);
+void ForgetScenes();
+void PlaySound(const std::string& soundFileName, bool waitForCompletion = true);
+void StartMonitoringThread();
+void StopMonitoringThread();
+bool ResolveSoundMappingsPath();
+bool LoadSoundMappings();
+RcuReadGuard<SoundTables> GetSoundTables();
+bool WaitForSoundTables(std::chrono::milliseconds timeout);
+void StartMappingsLoader();
+void StopMappingsLoader();
+void StartSoundIndexWatcher();
+void StopSoundIndexWatcher();
+std::string_view GetAnimationBaseView(std::string_view animationName);
+bool LoadIniSettings();
+void StartIniMonitoring();
+void StopIniMonitoring();
+void StartReplayBenchmark();
+void StopReplayBenchmark();
+void PlayStartupSound();
+void StopAllSounds();
+void StartHeartbeatThread();
+void StopHeartbeatThread();
+void WriteHeartbeat();
+SKSELogsPaths GetAllSKSELogsPaths();
+fs::path GetHeartbeatLogPath();
+void WriteToActionsLog(const std::string& message, int lineNumber = 0);
+void PauseAllSounds();
+void ResumeAllSounds();
+void PlayMenuSound(const std::string& menuName);
+void StopMenuSound(const std::string& menuName);
+void StopAllMenuSounds();
+void WriteToSoundPlayerLog(const std::string& message, int lineNumber = 0, bool isAnimationEntry = false);
+void ShowGameNotification(const std::string& message);
+
+void BuildSoundMenuKeyPlaylist();
+void InvalidateSoundMenuKeyPlaylist();
+void StartSoundMenuKey();
+void StopSoundMenuKey();
+void PauseSoundMenuKey();
+void ResumeSoundMenuKey();
+void PlayNextSoundMenuKeyTrack();
+std::string AdvanceSoundMenuKeyPlaylist(size_t& position, size_t& total, bool reserve = false);
+void ReleaseSoundMenuKeyReservation(bool played);
+void SaveSoundMenuKeyStates();
+void MuteGameMusic();
+void RestoreGameMusic();
+void ForceAudioRefresh();
+void ExecuteConsoleCommand(const std::string& command);
+void ScheduleGameTask(std::chrono::milliseconds delay, std::function<void()> task);
+void StopTimedGameTasks();
+std::string ToLowerCase(const std::string& str);
+void PlayAuthorPreview(const std::string& authorName);
+void StartPreviewTimer(const std::string& authorName, const std::string& songName);
+void StopAuthorPreview();
+void CreateIniBackup();
+void ProcessBackupUpdate();
+
+void CleanOldScripts();
+void GenerateStaticScripts();
+void ClassifyAnimations();
+bool IsMenuSound(const std::string& animationName);
+bool IsSpecificSound(const std::string& animationName);
+bool IsBaseSound(const std::string& animationName);
+void StartAllScriptsFrozen();
+void StopAllScripts();
+void SendTrackCommand(ScriptType type, const std::string& trackFile);
+void PlaySoundInScript(ScriptType type, const std::string& soundFile);
+void StopScript(ScriptState& scriptState);
+void SuspendProcess(HANDLE hProcess);
+void ResumeProcess(HANDLE hProcess);
+PROCESS_INFORMATION LaunchPowerShellScript(const std::string& scriptPath);
+void CleanStopFiles();
+void GenerateBaseScript();
+void GenerateSpecificScript();
+void GenerateMenuScript();
+void GenerateCheckScript();
+void SendDebugSoundBeforeFreeze(ScriptType type, ScriptState& scriptState);
+fs::path GetDllDirectory();
+bool SetProcessVolume(DWORD processID, float volume);
+
+void ShowGameNotification(const std::string& message) {
+    if (g_replayRunning.load()) {
+        return;
+    }
+    
+    if (g_topNotificationsVisible.load()) {
+        RE::DebugNotification(message.c_str());
+        WriteToSoundPlayerLog("IN-GAME MESSAGE SHOWN: " + message, __LINE__);
+    } else {
+        WriteToSoundPlayerLog("IN-GAME MESSAGE SUPPRESSED: " + message, __LINE__);
+    }
+}
+
+std::string ToLowerCase(const std::string& str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    return result;
+}
+
+// ========================================
+// BASS Audio Library - Core Functions
+// ========================================
+
+bool BassAudioBackend::Initialize() {
+    if (g_bassModule) return true;
+    
+    fs::path bassPath;
+    
+    if (g_dllDirectory.empty()) {
+        HMODULE hModule = nullptr;
+        if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                               (LPCWSTR)&g_bassBackend, &hModule)) {
+            wchar_t dllPath[MAX_PATH];
+            if (GetModuleFileNameW(hModule, dllPath, MAX_PATH)) {
+                fs::path dllFilePath(dllPath);
+                bassPath = dllFilePath.parent_path() / "DJ_library" / "bass.dll";
+            }
+        }
+    } else {
+        bassPath = g_dllDirectory / "DJ_library" / "bass.dll";
+    }
+    
+    if (bassPath.empty()) {
+        logger::error("Failed to determine bass.dll path");
+        WriteToSoundPlayerLog("BASS ERROR: Failed to determine bass.dll path", __LINE__);
+        return false;
+    }
+    
+    logger::info("Attempting to load BASS from: {}", bassPath.string());
+    WriteToSoundPlayerLog("BASS: Loading from " + bassPath.string(), __LINE__);
+    
+    g_bassModule = LoadLibraryW(bassPath.wstring().c_str());
+    if (!g_bassModule) {
+        DWORD error = GetLastError();
+        logger::error("Failed to load bass.dll from: {} (error: {})", bassPath.string(), error);
+        WriteToSoundPlayerLog("BASS ERROR: Failed to load bass.dll from " + bassPath.string() + " (error: " + std::to_string(error) + ")", __LINE__);
+        return false;
+    }
+    
+    pBASS_Init = (BASS_Init_t)GetProcAddress(g_bassModule, "BASS_Init");
+    pBASS_Free = (BASS_Free_t)GetProcAddress(g_bassModule, "BASS_Free");
+    pBASS_ErrorGetCode = (BASS_ErrorGetCode_t)GetProcAddress(g_bassModule, "BASS_ErrorGetCode");
+    pBASS_StreamCreateFile = (BASS_StreamCreateFile_t)GetProcAddress(g_bassModule, "BASS_StreamCreateFile");
+    pBASS_ChannelPlay = (BASS_ChannelPlay_t)GetProcAddress(g_bassModule, "BASS_ChannelPlay");
+    pBASS_ChannelStop = (BASS_ChannelStop_t)GetProcAddress(g_bassModule, "BASS_ChannelStop");
+    pBASS_ChannelPause = (BASS_ChannelPause_t)GetProcAddress(g_bassModule, "BASS_ChannelPause");
+    pBASS_StreamFree = (BASS_StreamFree_t)GetProcAddress(g_bassModule, "BASS_StreamFree");
+    pBASS_ChannelSetAttribute = (BASS_ChannelSetAttribute_t)GetProcAddress(g_bassModule, "BASS_ChannelSetAttribute");
+    pBASS_ChannelGetAttribute = (BASS_ChannelGetAttribute_t)GetProcAddress(g_bassModule, "BASS_ChannelGetAttribute");
+    pBASS_ChannelIsActive = (BASS_ChannelIsActive_t)GetProcAddress(g_bassModule, "BASS_ChannelIsActive");
+    pBASS_SampleLoad = (BASS_SampleLoad_t)GetProcAddress(g_bassModule, "BASS_SampleLoad");
+    pBASS_SampleFree = (BASS_SampleFree_t)GetProcAddress(g_bassModule, "BASS_SampleFree");
+    pBASS_SampleGetChannel = (BASS_SampleGetChannel_t)GetProcAddress(g_bassModule, "BASS_SampleGetChannel");
+    pBASS_SampleGetInfo = (BASS_SampleGetInfo_t)GetProcAddress(g_bassModule, "BASS_SampleGetInfo");
+    pBASS_SampleGetChannels = (BASS_SampleGetChannels_t)GetProcAddress(g_bassModule, "BASS_SampleGetChannels");
+    pBASS_ChannelFlags = (BASS_ChannelFlags_t)GetProcAddress(g_bassModule, "BASS_ChannelFlags");
+    pBASS_ChannelSlideAttribute = (BASS_ChannelSlideAttribute_t)GetProcAddress(g_bassModule, "BASS_ChannelSlideAttribute");
+    pBASS_ChannelSetSync = (BASS_ChannelSetSync_t)GetProcAddress(g_bassModule, "BASS_ChannelSetSync");
+    pBASS_ChannelGetLength = (BASS_ChannelGetLength_t)GetProcAddress(g_bassModule, "BASS_ChannelGetLength");
+    pBASS_ChannelSeconds2Bytes = (BASS_ChannelSeconds2Bytes_t)GetProcAddress(g_bassModule, "BASS_ChannelSeconds2Bytes");
+    pBASS_ChannelUpdate = (BASS_ChannelUpdate_t)GetProcAddress(g_bassModule, "BASS_ChannelUpdate");
+    pBASS_ChannelGetPosition = (BASS_ChannelGetPosition_t)GetProcAddress(g_bassModule, "BASS_ChannelGetPosition");
+    pBASS_ChannelBytes2Seconds = (BASS_ChannelBytes2Seconds_t)GetProcAddress(g_bassModule, "BASS_ChannelBytes2Seconds");
+    pBASS_ChannelGetInfo = (BASS_ChannelGetInfo_t)GetProcAddress(g_bassModule, "BASS_ChannelGetInfo");
+    pBASS_ChannelGetData = (BASS_ChannelGetData_t)GetProcAddress(g_bassModule, "BASS_ChannelGetData");
+    pBASS_GetCPU = (BASS_GetCPU_t)GetProcAddress(g_bassModule, "BASS_GetCPU");
+    pBASS_SetConfig = (BASS_SetConfig_t)GetProcAddress(g_bassModule, "BASS_SetConfig");
+    pBASS_ChannelSetDSP = (BASS_ChannelSetDSP_t)GetProcAddress(g_bassModule, "BASS_ChannelSetDSP");
+
+    if (!pBASS_Init || !pBASS_StreamCreateFile || !pBASS_ChannelPlay) {
+        logger::error("Failed to get BASS function pointers");
+        WriteToSoundPlayerLog("BASS ERROR: Failed to get function pointers", __LINE__);
+        FreeLibrary(g_bassModule);
+        g_bassModule = nullptr;
+        return false;
+    }
+    
+    if (!pBASS_Init(-1, 44100, 0, nullptr, nullptr)) {
+        int error = pBASS_ErrorGetCode ? pBASS_ErrorGetCode() : -1;
+        if (error != BASS_ERROR_ALREADY) {
+            logger::error("BASS_Init failed with error: {}", error);
+            WriteToSoundPlayerLog("BASS ERROR: BASS_Init failed with error " + std::to_string(error), __LINE__);
+            FreeLibrary(g_bassModule);
+            g_bassModule = nullptr;
+            return false;
+        }
+    }
+    
+    // The gain stages work on float data; with this off BASS would hand them 16-bit PCM.
+    floatDsp = pBASS_SetConfig && pBASS_ChannelSetDSP && pBASS_ChannelGetInfo && pBASS_ChannelSetSync &&
+               pBASS_SetConfig(BASS_CONFIG_FLOATDSP, TRUE);
+    if (!floatDsp) {
+        WriteToSoundPlayerLog("BASS WARNING: Float DSP unavailable, volume levels above 100% will not be applied", __LINE__);
+    }
+    
+    logger::info("BASS Audio Library initialized successfully from: {}", bassPath.string());
+    WriteToSoundPlayerLog("BASS Audio Library initialized successfully", __LINE__);
+    return true;
+}
+
+void BassAudioBackend::Shutdown() {
+    if (!g_bassModule) return;
+    
+    if (pBASS_Free) pBASS_Free();
+    FreeLibrary(g_bassModule);
+    g_bassModule = nullptr;
+    
+    // BASS_Free fires the free syncs; anything left belonged to a failed attach.
+    std::lock_guard<std::mutex> lock(gainMutex);
+    gainStages.clear();
+    fallbackGains.clear();
+    floatDsp = false;
+}
+
+// The offline renderer writes next to the logs unless OfflineRenderFile is absolute.
+// BASS is still loaded when available, but only to decode MP3/OGG for the renderer.
+IAudioBackend* SelectAudioBackend() {
+    if (g_audioBackendName == "null") {
+        return &g_nullBackend;
+    }
+    
+    if (g_audioBackendName == "offline") {
+        fs::path renderPath = g_offlineRenderFile.empty() ? fs::path("OSoundtracks-SA-Expansion-Sounds-NG-Offline-Render.wav")
+                                                          : fs::path(g_offlineRenderFile);
+        if (renderPath.is_relative()) {
+            renderPath = GetAllSKSELogsPaths().primary / renderPath;
+        }
+        IAudioBackend* decoder = g_bassBackend.Initialize() ? &g_bassBackend : nullptr;
+        g_offlineBackend = std::make_unique<OfflineAudioBackend>(renderPath, 44100, true, decoder);
+        WriteToSoundPlayerLog("AUDIO: Offline render to " + renderPath.string() +
+                             (decoder ? "" : " (WAV only, BASS unavailable for decoding)"), __LINE__);
+        return g_offlineBackend.get();
+    }
+    
+    return &g_bassBackend;
+}
+
+bool InitializeBASSLibrary() {
+    std::lock_guard<std::mutex> lock(g_bassMutex);
+    
+    if (g_bassInitialized) return true;
+    
+    IAudioBackend* backend = SelectAudioBackend();
+    if (!backend->Initialize()) {
+        WriteToSoundPlayerLog("AUDIO ERROR: " + std::string(backend->Name()) + " backend failed to initialize, error " +
+                             std::to_string(backend->LastError()), __LINE__);
+        return false;
+    }
+    
+    g_audio = backend;
+    g_bassInitialized = true;
+    WriteToSoundPlayerLog("AUDIO: Using " + std::string(backend->Name()) + " backend", __LINE__);
+    return true;
+}
+
+// Stops everything an output on g_audio plays. Channels fade out over `fadeMs`; position
+// layers are freed at once, as StopPositionFragment does. Caller holds g_bassMutex.
+void StopOutputLocked(AudioOutput& output, uint32_t fadeMs) {
+    for (auto& channel : output.channels) {
+        channel.Stop(fadeMs);
+        channel.MarkRequested(false, 0);
+    }
+    for (auto& [fragment, layers] : output.positionStreams) {
+        for (auto& [layerNum, stream] : layers) {
+            if (stream) {
+                g_audio->Free(stream);
+                stream = 0;
+            }
+        }
+    }
+    output.positionStreams.clear();
+    output.positionStreamsEpoch++;
+}
+
+void ShutdownBASSLibrary() {
+    std::lock_guard<std::mutex> lock(g_bassMutex);
+    
+    StopOutputLocked(g_liveOutput, 0);
+    // Mixed scenes keep their outputs until they close; only the streams go here.
+    for (AudioOutput* output : g_sceneOutputs) StopOutputLocked(*output, 0);
+    if (g_authorPreviewStream) { g_audio->Free(g_authorPreviewStream); g_authorPreviewStream = 0; }
+    g_channelGroups = {};
+    
+    std::lock_guard<std::mutex> cacheLock(g_sampleCacheMutex);
+    if (!g_sampleCache.empty()) {
+        WriteToSoundPlayerLog("SAMPLE CACHE: Shutdown - hits: " + std::to_string(g_sampleCacheHits) +
+                             ", misses: " + std::to_string(g_sampleCacheMisses) +
+                             ", evictions: " + std::to_string(g_sampleCacheEvictions), __LINE__);
+    }
+    for (auto& [path, entry] : g_sampleCache) {
+        g_audio->FreeSample(entry.sample);
+    }
+    g_sampleCache.clear();
+    g_sampleCacheLru.clear();
+    g_sampleCacheRejected.clear();
+    g_sampleCacheBytes = 0;
+    
+    std::lock_guard<std::mutex> decodeLock(g_loudnessDecodeMutex);
+    g_audioBackendEpoch++;
+    if (g_bassInitialized) {
+        g_audio->Shutdown();
+    }
+    g_bassBackend.Shutdown();
+    g_audio = &g_nullBackend;
+    
+    g_bassInitialized = false;
+    WriteToSoundPlayerLog("BASS Audio Library shutdown complete (multi-layer position cleaned)", __LINE__);
+}
+
+// ========================================
+// Sound File Resolver
+// ========================================
+
+std::string NormalizeSoundKey(const std::string& name) {
+    std::string key = ToLowerCase(name);
+    std::replace(key.begin(), key.end(), '\\', '/');
+    while (!key.empty() && key[0] == '/') {
+        key.erase(0, 1);
+    }
+    return key;
+}
+
+int SoundExtensionRank(const std::string& extensionLower) {
+    if (extensionLower == ".wav") return 0;
+    if (extensionLower == ".mp3") return 1;
+    if (extensionLower == ".ogg") return 2;
+    return -1;
+}
+
+std::unique_ptr<SoundFileIndex> BuildSoundFileIndex(const fs::path& root) {
+    auto index = std::make_unique<SoundFileIndex>();
+    index->root = root;
+
+    std::error_code ec;
+    if (root.empty() || !fs::is_directory(root, ec)) {
+        return index;
+    }
+
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+    fs::recursive_directory_iterator end;
+
+    for (; !ec && it != end; it.increment(ec)) {
+        try {
+            const auto& entry = *it;
+            std::error_code entryEc;
+            if (!entry.is_regular_file(entryEc)) {
+                continue;
+            }
+
+            SoundFileEntry file;
+            file.path = entry.path();
+            file.extension = ToLowerCase(file.path.extension().string());
+            file.size = entry.file_size(entryEc);
+
+            std::string key = NormalizeSoundKey(file.path.lexically_relative(root).string());
+            index->byName[key] = file;
+
+            int rank = SoundExtensionRank(file.extension);
+            if (rank < 0) {
+                continue;
+            }
+
+            std::string stem = key.substr(0, key.size() - file.extension.size());
+            auto existing = index->byStem.find(stem);
+            if (existing == index->byStem.end() || rank < SoundExtensionRank(existing->second.extension)) {
+                index->byStem[stem] = file;
+            }
+        } catch (...) {
+        }
+    }
+
+    // A walk cut short by an error would make the missing files look absent.
+    index->valid = !ec;
+    return index;
+}
+
+void SoundIndexWatcherThreadFunction() {
+    fs::path root = g_soundsDirectory;
+    HANDLE changeHandle = INVALID_HANDLE_VALUE;
+    bool rebuild = true;
+    bool loggedMissing = false;
+
+    WriteToSoundPlayerLog("Sound index watcher started: " + root.string(), __LINE__);
+
+    while (g_soundIndexActive.load() && !g_isShuttingDown.load()) {
+        if (rebuild) {
+            auto buildStart = std::chrono::steady_clock::now();
+            auto index = BuildSoundFileIndex(root);
+            auto buildMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - buildStart).count();
+
+            if (index->valid) {
+                WriteToSoundPlayerLog("Sound index rebuilt: " + std::to_string(index->byName.size()) + " files, " +
+                                          std::to_string(index->byStem.size()) + " playable (" +
+                                          std::to_string(buildMs) + "ms)",
+                                      __LINE__);
+                loggedMissing = false;
+            } else if (!loggedMissing) {
+                WriteToSoundPlayerLog("Sound index: folder not available, using direct file lookups", __LINE__);
+                loggedMissing = true;
+            }
+
+            g_soundFileIndex.Publish(std::move(index));
+            rebuild = false;
+        }
+
+        if (changeHandle == INVALID_HANDLE_VALUE) {
+            changeHandle = FindFirstChangeNotificationW(
+                root.wstring().c_str(), TRUE,
+                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                    FILE_NOTIFY_CHANGE_LAST_WRITE);
+
+            if (changeHandle == INVALID_HANDLE_VALUE) {
+                if (WaitForSingleObject(g_soundIndexStopEvent, 5000) == WAIT_OBJECT_0) {
+                    break;
+                }
+                rebuild = true;
+                continue;
+            }
+        }
+
+        HANDLE handles[2] = {g_soundIndexStopEvent, changeHandle};
+        DWORD result = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+
+        if (result == WAIT_OBJECT_0) {
+            break;
+        }
+
+        if (result == WAIT_OBJECT_0 + 1) {
+            // Mod managers copy files in bursts; coalesce them into a single rescan.
+            bool rearmed = true;
+            do {
+                if (!FindNextChangeNotification(changeHandle)) {
+                    rearmed = false;
+                    break;
+                }
+            } while (WaitForSingleObject(changeHandle, 250) == WAIT_OBJECT_0);
+
+            if (!rearmed) {
+                FindCloseChangeNotification(changeHandle);
+                changeHandle = INVALID_HANDLE_VALUE;
+            }
+            rebuild = true;
+        } else {
+            FindCloseChangeNotification(changeHandle);
+            changeHandle = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    if (changeHandle != INVALID_HANDLE_VALUE) {
+        FindCloseChangeNotification(changeHandle);
+    }
+
+    logger::info("Sound index watcher stopped");
+}
+
+void StartSoundIndexWatcher() {
+    if (!g_soundIndexActive.load()) {
+        if (!g_soundIndexStopEvent) {
+            g_soundIndexStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        }
+        ResetEvent(g_soundIndexStopEvent);
+        g_soundIndexActive = true;
+        g_soundIndexThread = std::thread(SoundIndexWatcherThreadFunction);
+    }
+}
+
+void StopSoundIndexWatcher() {
+    if (g_soundIndexActive.load()) {
+        g_soundIndexActive = false;
+        if (g_soundIndexStopEvent) {
+            SetEvent(g_soundIndexStopEvent);
+        }
+        if (g_soundIndexThread.joinable()) {
+            g_soundIndexThread.join();
+        }
+    }
+}
+
+fs::path FindSoundFileOnDisk(const std::string& baseName) {
+    std::string nameWithoutExt = baseName;
+    std::string originalExt = "";
+    
+    size_t lastDot = baseName.find_last_of('.');
+    if (lastDot != std::string::npos) {
+        originalExt = baseName.substr(lastDot);
+        nameWithoutExt = baseName.substr(0, lastDot);
+    }
+    
+    fs::path testPath = g_soundsDirectory / baseName;
+    if (!originalExt.empty() && fs::exists(testPath)) {
+        return testPath;
+    }
+    
+    fs::path wavPath = g_soundsDirectory / (nameWithoutExt + ".wav");
+    if (fs::exists(wavPath)) {
+        return wavPath;
+    }
+    
+    fs::path mp3Path = g_soundsDirectory / (nameWithoutExt + ".mp3");
+    if (fs::exists(mp3Path)) {
+        return mp3Path;
+    }
+    
+    fs::path oggPath = g_soundsDirectory / (nameWithoutExt + ".ogg");
+    if (fs::exists(oggPath)) {
+        return oggPath;
+    }
+    
+    return fs::path();
+}
+
+fs::path FindSoundFile(const std::string& baseName) {
+    if (baseName.empty()) return fs::path();
+    
+    fs::path resolved;
+    {
+        auto index = g_soundFileIndex.Read();
+        if (index->valid) {
+            std::string key = NormalizeSoundKey(baseName);
+            
+            auto exact = index->byName.find(key);
+            if (exact != index->byName.end()) {
+                resolved = exact->second.path;
+            } else {
+                size_t lastDot = key.find_last_of('.');
+                size_t lastSlash = key.find_last_of('/');
+                if (lastDot != std::string::npos && (lastSlash == std::string::npos || lastDot > lastSlash)) {
+                    auto stem = index->byStem.find(key.substr(0, lastDot));
+                    if (stem != index->byStem.end()) {
+                        resolved = stem->second.path;
+                    }
+                }
+                if (resolved.empty()) {
+                    auto stem = index->byStem.find(key);
+                    if (stem != index->byStem.end()) {
+                        resolved = stem->second.path;
+                    }
+                }
+            }
+        }
+    }
+    
+    // The index lags the folder by the watcher's debounce, and never catches up where
+    // change notifications don't fire, so a miss is checked on disk before it counts.
+    if (resolved.empty()) {
+        resolved = FindSoundFileOnDisk(baseName);
+    }
+    
+    if (resolved.empty()) {
+        logger::warn("Sound file not found: {} (tried .wav, .mp3, .ogg)", baseName);
+        WriteToSoundPlayerLog("BASS WARNING: Sound file not found: " + baseName, __LINE__);
+    }
+    return resolved;
+}
+
+// ========================================
+// Sample Cache - Short Clips In Memory
+// ========================================
+// Clips under the INI size/duration limits are decoded once with LoadSample and every
+// later play gets a channel from memory that behaves like a file stream (Free,
+// SetVolume and syncs work on the handle). Unless noted otherwise the
+// functions below expect g_sampleCacheMutex to be held by the caller.
+
+void LogSampleCacheStats(const std::string& reason) {
+    uint64_t lookups = g_sampleCacheHits + g_sampleCacheMisses;
+    int hitRate = lookups ? static_cast<int>((g_sampleCacheHits * 100) / lookups) : 0;
+    WriteToSoundPlayerLog("SAMPLE CACHE: " + reason + " - entries: " + std::to_string(g_sampleCache.size()) +
+                         ", memory: " + std::to_string(g_sampleCacheBytes / 1024) + " KB" +
+                         ", hits: " + std::to_string(g_sampleCacheHits) +
+                         ", misses: " + std::to_string(g_sampleCacheMisses) +
+                         " (" + std::to_string(hitRate) + "%)" +
+                         ", evictions: " + std::to_string(g_sampleCacheEvictions), __LINE__);
+}
+
+// Frees least recently used samples until the cache fits in budgetBytes. Samples that
+// still own a channel (playing, paused or waiting to be freed) are skipped.
+void EvictSampleCache(uint64_t budgetBytes) {
+    auto it = g_sampleCacheLru.end();
+    while (g_sampleCacheBytes > budgetBytes && it != g_sampleCacheLru.begin()) {
+        --it;
+        auto entryIt = g_sampleCache.find(*it);
+        if (entryIt == g_sampleCache.end()) {
+            it = g_sampleCacheLru.erase(it);
+            continue;
+        }
+        
+        if (g_audio->SampleInUse(entryIt->second.sample)) {
+            continue;
+        }
+        
+        g_audio->FreeSample(entryIt->second.sample);
+        g_sampleCacheBytes -= entryIt->second.bytes;
+        g_sampleCacheEvictions++;
+        g_sampleCache.erase(entryIt);
+        it = g_sampleCacheLru.erase(it);
+    }
+}
+
+// Cached samples belong to g_audio, so outputs on another backend always open streams.
+bool SampleCacheAvailable() {
+    return g_sampleCacheEnabled.load() && !Output().backend;
+}
+
+// Decodes a clip into a BASS sample if it fits the size/duration limits. Touches no
+// cache state, so it runs without g_sampleCacheMutex and never blocks playback.
+AudioSample LoadSampleFromDisk(const fs::path& soundPath, uint64_t& bytes) {
+    std::error_code ec;
+    uintmax_t fileSize = fs::file_size(soundPath, ec);
+    if (ec || fileSize > static_cast<uintmax_t>(g_sampleCacheMaxClipKB.load()) * 1024) {
+        return 0;
+    }
+    
+    AudioSampleInfo info;
+    AudioSample sample = g_audio->LoadSample(soundPath, info);
+    if (!sample) {
+        int error = g_audio->LastError();
+        WriteToSoundPlayerLog("SAMPLE CACHE: Load failed for " + soundPath.filename().string() +
+                             ", error " + std::to_string(error) + " - streaming from disk", __LINE__);
+        return 0;
+    }
+    
+    double seconds = info.seconds;
+    uint64_t budgetBytes = static_cast<uint64_t>(g_sampleCacheBudgetMB.load()) * 1024 * 1024;
+    
+    if (seconds > g_sampleCacheMaxClipSeconds.load() || info.bytes > budgetBytes) {
+        g_audio->FreeSample(sample);
+        return 0;
+    }
+    
+    bytes = info.bytes;
+    WriteToSoundPlayerLog("SAMPLE CACHE: Cached " + soundPath.filename().string() + " (" +
+                         std::to_string(info.bytes / 1024) + " KB, " +
+                         std::to_string(static_cast<int>(seconds * 1000)) + " ms)", __LINE__);
+    return sample;
+}
+
+// Adds a freshly loaded sample as most recently used. If another thread cached the
+// same file in the meantime, the duplicate is freed and the existing entry returned.
+AudioSample InsertCachedSample(std::wstring key, AudioSample sample, uint64_t bytes) {
+    auto existing = g_sampleCache.find(key);
+    if (existing != g_sampleCache.end()) {
+        g_audio->FreeSample(sample);
+        return existing->second.sample;
+    }
+    
+    uint64_t budgetBytes = static_cast<uint64_t>(g_sampleCacheBudgetMB.load()) * 1024 * 1024;
+    EvictSampleCache(budgetBytes > bytes ? budgetBytes - bytes : 0);
+    
+    g_sampleCacheLru.push_front(key);
+    SampleCacheEntry entry;
+    entry.sample = sample;
+    entry.bytes = bytes;
+    entry.lruIt = g_sampleCacheLru.begin();
+    g_sampleCache.emplace(std::move(key), entry);
+    g_sampleCacheBytes += bytes;
+    return sample;
+}
+
+// Locks g_sampleCacheMutex itself; a miss decodes the file with the lock released.
+AudioSample AcquireCachedSample(const fs::path& soundPath) {
+    if (!SampleCacheAvailable()) {
+        return 0;
+    }
+    
+    std::wstring key = soundPath.wstring();
+    
+    std::unique_lock<std::mutex> lock(g_sampleCacheMutex);
+    auto cached = g_sampleCache.find(key);
+    if (cached != g_sampleCache.end()) {
+        g_sampleCacheLru.splice(g_sampleCacheLru.begin(), g_sampleCacheLru, cached->second.lruIt);
+        g_sampleCacheHits++;
+        if ((g_sampleCacheHits + g_sampleCacheMisses) % 100 == 0) {
+            LogSampleCacheStats("Stats");
+        }
+        return cached->second.sample;
+    }
+    
+    if (g_sampleCacheRejected.count(key)) {
+        return 0;
+    }
+    
+    g_sampleCacheMisses++;
+    lock.unlock();
+    
+    uint64_t bytes = 0;
+    AudioSample sample = LoadSampleFromDisk(soundPath, bytes);
+    
+    lock.lock();
+    if (!sample) {
+        g_sampleCacheRejected.insert(std::move(key));
+        return 0;
+    }
+    
+    return InsertCachedSample(std::move(key), sample, bytes);
+}
+
+// Returns a channel for the file, from the sample cache when the clip qualifies and
+// from a regular file stream otherwise. The caller owns the handle either way. Does not
+// need g_bassMutex, so file opens and decoder setup stay out of the playback lock.
+AudioHandle CreateBASSChannel(const fs::path& soundPath, bool loop) {
+    AudioHandle channel = 0;
+    AudioSample sample = AcquireCachedSample(soundPath);
+    if (sample) {
+        channel = Audio()->SampleChannel(sample, loop);
+    }
+    if (!channel) {
+        channel = Audio()->OpenStream(soundPath, loop);
+    }
+    
+    if (channel) {
+        Audio()->SetTrim(channel, LoudnessTrimFor(soundPath));
+    }
+    return channel;
+}
+
+// Called after INI changes: drops rejected-path memo (limits may have grown) and
+// shrinks the cache to the new budget, or empties it when disabled.
+void ApplySampleCacheSettings() {
+    std::lock_guard<std::mutex> lock(g_sampleCacheMutex);
+    
+    g_sampleCacheRejected.clear();
+    
+    uint64_t budgetBytes = g_sampleCacheEnabled.load() ? static_cast<uint64_t>(g_sampleCacheBudgetMB.load()) * 1024 * 1024 : 0;
+    if (g_sampleCacheBytes > budgetBytes) {
+        EvictSampleCache(budgetBytes);
+        LogSampleCacheStats("Trimmed to budget");
+    }
+}
+
+// ========================================
+// Prefetch - Next Animation Prediction
+// ========================================
+// First-order Markov table of OStim node transitions (from -> to -> count), learned
+// from the audible scene's node changes and saved next to the INI. After every transition the
+// top-K successors go to a low-priority worker that resolves their base, specific and
+// position sounds and either decodes them into the sample cache (short clips) or reads
+// the head of the file so the stream open and decoder probe hit the OS file cache.
+
+static constexpr size_t kPrefetchMaxSuccessors = 16;
+static constexpr uint32_t kPrefetchAgingThreshold = 1000;
+static constexpr uint32_t kPrefetchSaveInterval = 50;
+static constexpr size_t kPrefetchWarmBytes = 1024 * 1024;
+
+void LogPrefetchStats(const std::string& reason) {
+    int hitRate = g_prefetchPredicted ? static_cast<int>((g_prefetchHits * 100) / g_prefetchPredicted) : 0;
+    WriteToSoundPlayerLog("PREFETCH: " + reason + " - hit rate " + std::to_string(hitRate) + "% (" +
+                         std::to_string(g_prefetchHits) + "/" + std::to_string(g_prefetchPredicted) + " transitions)" +
+                         ", warmed samples: " + std::to_string(g_prefetchWarmedSamples.load()) +
+                         ", warmed files: " + std::to_string(g_prefetchWarmedFiles.load()) +
+                         ", known nodes: " + std::to_string(g_transitionCounts.size()), __LINE__);
+}
+
+void LoadTransitionTable() {
+    std::lock_guard<std::mutex> lock(g_prefetchMutex);
+    g_transitionCounts.clear();
+    
+    std::ifstream file(g_transitionTablePath);
+    if (!file.is_open()) {
+        return;
+    }
+    
+    size_t loaded = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        
+        size_t first = line.find('|');
+        size_t second = line.rfind('|');
+        if (first == std::string::npos || second == first) continue;
+        
+        try {
+            uint32_t count = static_cast<uint32_t>(std::stoul(line.substr(second + 1)));
+            if (count > 0) {
+                g_transitionCounts[line.substr(0, first)][line.substr(first + 1, second - first - 1)] = count;
+                loaded++;
+            }
+        } catch (...) {
+        }
+    }
+    
+    WriteToSoundPlayerLog("PREFETCH: Loaded " + std::to_string(loaded) + " transitions for " +
+                         std::to_string(g_transitionCounts.size()) + " nodes", __LINE__);
+}
+
+void SaveTransitionTable() {
+    if (g_transitionTablePath.empty()) return;
+    
+    std::string contents;
+    {
+        std::lock_guard<std::mutex> lock(g_prefetchMutex);
+        for (const auto& [from, successors] : g_transitionCounts) {
+            for (const auto& [to, count] : successors) {
+                contents += from + "|" + to + "|" + std::to_string(count) + "\n";
+            }
+        }
+    }
+    
+    try {
+        fs::path tempPath = g_transitionTablePath;
+        tempPath += ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc | std::ios::binary);
+            if (!file.is_open()) return;
+            file << contents;
+        }
+        fs::rename(tempPath, g_transitionTablePath);
+    } catch (...) {
+        logger::warn("Could not save prefetch transition table");
+    }
+}
+
+// Called from the OStim.log monitor after CheckAndPlaySound has handled the new node.
+void OnAnimationTransition(const std::string& previous, const std::string& current) {
+    if (!g_prefetchEnabled.load() || !g_prefetchActive.load()) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(g_prefetchMutex);
+        
+        if (!g_lastPredictions.empty()) {
+            g_prefetchPredicted++;
+            if (std::find(g_lastPredictions.begin(), g_lastPredictions.end(), current) != g_lastPredictions.end()) {
+                g_prefetchHits++;
+            }
+            if (g_prefetchPredicted % 25 == 0) {
+                LogPrefetchStats("Stats");
+            }
+        }
+        
+        if (!previous.empty()) {
+            auto& successors = g_transitionCounts[previous];
+            if (++successors[current] >= kPrefetchAgingThreshold) {
+                for (auto it = successors.begin(); it != successors.end();) {
+                    it->second /= 2;
+                    it = it->second == 0 ? successors.erase(it) : std::next(it);
+                }
+            }
+            if (successors.size() > kPrefetchMaxSuccessors) {
+                auto weakest = successors.end();
+                for (auto it = successors.begin(); it != successors.end(); ++it) {
+                    if (it->first != current && (weakest == successors.end() || it->second < weakest->second)) {
+                        weakest = it;
+                    }
+                }
+                if (weakest != successors.end()) successors.erase(weakest);
+            }
+            g_transitionsSinceSave++;
+        }
+        
+        g_lastPredictions.clear();
+        g_prefetchQueue.clear();
+        
+        auto known = g_transitionCounts.find(current);
+        if (known != g_transitionCounts.end()) {
+            std::vector<std::pair<uint32_t, const std::string*>> ranked;
+            ranked.reserve(known->second.size());
+            for (const auto& [to, count] : known->second) {
+                ranked.emplace_back(count, &to);
+            }
+            
+            size_t topK = std::min<size_t>(g_prefetchTopK.load(), ranked.size());
+            std::partial_sort(ranked.begin(), ranked.begin() + topK, ranked.end(),
+                              [](const auto& a, const auto& b) { return a.first > b.first; });
+            
+            for (size_t i = 0; i < topK; ++i) {
+                g_lastPredictions.push_back(*ranked[i].second);
+                g_prefetchQueue.push_back(*ranked[i].second);
+            }
+        }
+    }
+    
+    g_prefetchCondition.notify_one();
+}
+
+void WarmSoundFile(const fs::path& soundPath) {
+    std::wstring key = soundPath.wstring();
+    
+    if (g_bassInitialized && SampleCacheAvailable()) {
+        bool cached = false;
+        bool rejected = false;
+        {
+            std::lock_guard<std::mutex> lock(g_sampleCacheMutex);
+            cached = g_sampleCache.count(key) > 0;
+            rejected = g_sampleCacheRejected.count(key) > 0;
+        }
+        if (cached) return;
+        
+        if (!rejected) {
+            uint64_t bytes = 0;
+            AudioSample sample = LoadSampleFromDisk(soundPath, bytes);
+            
+            std::lock_guard<std::mutex> lock(g_sampleCacheMutex);
+            if (sample) {
+                InsertCachedSample(std::move(key), sample, bytes);
+                g_prefetchWarmedSamples++;
+                return;
+            }
+            g_sampleCacheRejected.insert(std::move(key));
+        }
+    }
+    
+    std::ifstream file(soundPath, std::ios::binary);
+    if (!file.is_open()) return;
+    
+    std::vector<char> buffer(64 * 1024);
+    size_t total = 0;
+    while (total < kPrefetchWarmBytes && file.read(buffer.data(), buffer.size())) {
+        total += buffer.size();
+    }
+    
+    g_prefetchWarmedFiles++;
+}
+
+void PrefetchAnimationSounds(const std::string& animationName) {
+    std::vector<std::string> soundFiles;
+    {
+        auto tables = GetSoundTables();
+        
+        uint32_t animationId = tables->FindAnimationId(animationName);
+        uint32_t familyId = animationId != kNoAnimationId
+                                ? tables->animationEntries[animationId].familyId
+                                : tables->FindAnimationId(GetAnimationBaseView(animationName));
+        
+        auto addOptions = [&tables, &soundFiles](uint32_t id) {
+            if (id == kNoAnimationId) return;
+            const auto& entry = tables->animationEntries[id];
+            for (uint32_t i = 0; i < entry.optionCount; ++i) {
+                soundFiles.push_back(tables->animationOptions[entry.optionOffset + i].soundFile);
+            }
+        };
+        addOptions(familyId);
+        if (animationId != familyId) addOptions(animationId);
+        
+        if (!tables->positionFragments.empty()) {
+            FragmentSet matched;
+            matched.Resize(tables->positionFragments.size());
+            tables->positionMatcher.Match(animationName, matched);
+            
+            for (size_t w = 0; w < matched.words.size(); ++w) {
+                uint64_t bits = matched.words[w];
+                while (bits) {
+                    size_t id = w * 64 + std::countr_zero(bits);
+                    bits &= bits - 1;
+                    
+                    const SoundConfigMultiple* config = tables->positionConfigs[id];
+                    for (const auto& [layerNum, sounds] : config->layers) {
+                        for (const auto& option : sounds) soundFiles.push_back(option.soundFile);
+                    }
+                    for (const auto& option : config->soundOptions) soundFiles.push_back(option.soundFile);
+                }
+            }
+        }
+    }
+    
+    std::sort(soundFiles.begin(), soundFiles.end());
+    soundFiles.erase(std::unique(soundFiles.begin(), soundFiles.end()), soundFiles.end());
+    
+    for (const auto& soundFile : soundFiles) {
+        if (!g_prefetchActive.load()) return;
+        
+        fs::path soundPath = FindSoundFile(soundFile);
+        if (!soundPath.empty()) {
+            WarmSoundFile(soundPath);
+        }
+    }
+}
+
+void PrefetchWorkerThreadFunction() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+    logger::info("Prefetch worker started");
+    
+    while (true) {
+        std::string animationName;
+        bool saveTable = false;
+        {
+            std::unique_lock<std::mutex> lock(g_prefetchMutex);
+            g_prefetchCondition.wait(lock, [] { return !g_prefetchActive.load() || !g_prefetchQueue.empty(); });
+            if (!g_prefetchActive.load()) break;
+            
+            animationName = std::move(g_prefetchQueue.front());
+            g_prefetchQueue.pop_front();
+            
+            if (g_transitionsSinceSave >= kPrefetchSaveInterval) {
+                g_transitionsSinceSave = 0;
+                saveTable = true;
+            }
+        }
+        
+        if (saveTable) {
+            SaveTransitionTable();
+        }
+        
+        try {
+            PrefetchAnimationSounds(animationName);
+        } catch (...) {
+            logger::error("Error prefetching sounds for {}", animationName);
+        }
+    }
+    
+    SaveTransitionTable();
+    logger::info("Prefetch worker stopped");
+}
+
+void StartPrefetcher() {
+    if (g_prefetchActive.load()) return;
+    
+    g_transitionTablePath = g_iniPath.parent_path() / "OSoundtracks-SA-Expansion-Sounds-NG-Transitions.txt";
+    LoadTransitionTable();
+    
+    g_prefetchActive = true;
+    g_prefetchThread = std::thread(PrefetchWorkerThreadFunction);
+}
+
+void StopPrefetcher() {
+    if (!g_prefetchActive.load()) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(g_prefetchMutex);
+        g_prefetchActive = false;
+        g_prefetchQueue.clear();
+        g_lastPredictions.clear();
+        if (g_prefetchPredicted > 0) {
+            LogPrefetchStats("Shutdown");
+        }
+    }
+    g_prefetchCondition.notify_all();
+    
+    if (g_prefetchThread.joinable()) {
+        g_prefetchThread.join();
+    }
+}
+
+// ========================================
+// Loudness Normalization
+// ========================================
+// Tracks from different authors are mastered at very different levels. Every sound the
+// mappings reference is decoded once by a small pool of background-priority workers,
+// measured (integrated loudness and true peak, see LoudnessMeter.h) and cached next to
+// the INI by path, size and modification time, so an analyzed library loads instantly.
+// Stream creation only looks the result up, checks it against the file's size and
+// modification time, and sets the stream's trim; a sound that is not analyzed yet, or
+// changed since, plays untrimmed. Nothing else here runs on the transition path.
+
+static constexpr size_t kLoudnessDecodeFrames = 16384;
+static constexpr float kLoudnessMaxCutDb = 24.0f;
+static constexpr float kLoudnessTruePeakCeilingDb = -1.0f;
+
+std::string SafeWideStringToString(const std::wstring& wstr);
+
+std::string LoudnessKey(const fs::path& soundPath) {
+    return SafeWideStringToString(soundPath.wstring());
+}
+
+bool ReadSoundFileStamp(const fs::path& soundPath, uint64_t& size, int64_t& writeTime) {
+    std::error_code ec;
+    size = fs::file_size(soundPath, ec);
+    if (ec) return false;
+    auto time = fs::last_write_time(soundPath, ec);
+    if (ec) return false;
+    writeTime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+void LogLoudnessStats(const std::string& reason) {
+    WriteToSoundPlayerLog("LOUDNESS: " + reason + " - cached: " + std::to_string(g_loudnessCache.size()) +
+                         ", analyzed: " + std::to_string(g_loudnessAnalyzed) +
+                         ", unchanged: " + std::to_string(g_loudnessUnchanged) +
+                         ", failed: " + std::to_string(g_loudnessFailed), __LINE__);
+}
+
+// One line per file: path|size|writeTime|lufs|truePeakDb. Parsed from the right, so a
+// '|' in a path does not matter.
+void LoadLoudnessCache() {
+    std::lock_guard<std::mutex> lock(g_loudnessMutex);
+    g_loudnessCache.clear();
+    g_loudnessChecked.clear();
+    
+    std::ifstream file(g_loudnessCachePath, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        
+        size_t cut[4];
+        size_t pos = line.size();
+        bool valid = true;
+        for (int i = 3; i >= 0 && valid; --i) {
+            pos = pos > 0 ? line.rfind('|', pos - 1) : std::string::npos;
+            valid = pos != std::string::npos && pos > 0;
+            cut[i] = pos;
+        }
+        if (!valid) continue;
+        
+        try {
+            LoudnessInfo info;
+            info.size = std::stoull(line.substr(cut[0] + 1, cut[1] - cut[0] - 1));
+            info.writeTime = std::stoll(line.substr(cut[1] + 1, cut[2] - cut[1] - 1));
+            info.lufs = std::stof(line.substr(cut[2] + 1, cut[3] - cut[2] - 1));
+            info.truePeakDb = std::stof(line.substr(cut[3] + 1));
+            g_loudnessCache[line.substr(0, cut[0])] = info;
+        } catch (...) {
+        }
+    }
+    
+    WriteToSoundPlayerLog("LOUDNESS: Loaded " + std::to_string(g_loudnessCache.size()) + " cached measurements", __LINE__);
+}
+
+void SaveLoudnessCache() {
+    if (g_loudnessCachePath.empty()) return;
+    
+    std::string contents;
+    {
+        std::lock_guard<std::mutex> lock(g_loudnessMutex);
+        if (!g_loudnessDirty) return;
+        g_loudnessDirty = false;
+        for (const auto& [key, info] : g_loudnessCache) {
+            contents += key + "|" + std::to_string(info.size) + "|" + std::to_string(info.writeTime) + "|" +
+                        std::to_string(info.lufs) + "|" + std::to_string(info.truePeakDb) + "\n";
+        }
+    }
+    
+    try {
+        fs::path tempPath = g_loudnessCachePath;
+        tempPath += ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc | std::ios::binary);
+            if (!file.is_open()) return;
+            file << contents;
+        }
+        fs::rename(tempPath, g_loudnessCachePath);
+    } catch (...) {
+        logger::warn("Could not save loudness cache");
+    }
+}
+
+// Linear trim for a new stream of this file; 1 when disabled, not analyzed yet, or the
+// file was edited or replaced since its measurement. A changed file is queued again.
+float LoudnessTrimFor(const fs::path& soundPath) {
+    if (!g_loudnessEnabled.load()) return 1.0f;
+    
+    std::string key = LoudnessKey(soundPath);
+    LoudnessInfo info;
+    {
+        std::lock_guard<std::mutex> lock(g_loudnessMutex);
+        auto it = g_loudnessCache.find(key);
+        if (it == g_loudnessCache.end()) return 1.0f;
+        info = it->second;
+    }
+    uint64_t size = 0;
+    int64_t writeTime = 0;
+    if (!ReadSoundFileStamp(soundPath, size, writeTime)) return 1.0f;
+    if (size != info.size || writeTime != info.writeTime) {
+        {
+            std::lock_guard<std::mutex> lock(g_loudnessMutex);
+            if (!g_loudnessQueued.insert(key).second) return 1.0f;
+            g_loudnessChecked.erase(key);
+            g_loudnessQueue.emplace_back(std::move(key), soundPath);
+        }
+        g_loudnessCondition.notify_all();
+        return 1.0f;
+    }
+    if (info.lufs <= static_cast<float>(LoudnessMeter::kSilence)) return 1.0f;
+    
+    float gainDb = std::clamp(g_loudnessTargetLufs.load() - info.lufs, -kLoudnessMaxCutDb, g_loudnessMaxBoostDb.load());
+    // A boost stops where the true peak would pass the ceiling, so quiet but peaky
+    // tracks are not left for the limiter to flatten.
+    if (gainDb > 0.0f) {
+        gainDb = std::min(gainDb, std::max(0.0f, kLoudnessTruePeakCeilingDb - info.truePeakDb));
+    }
+    return std::pow(10.0f, gainDb / 20.0f);
+}
+
+// Decodes the whole file through the active backend. Fails if the backend cannot
+// decode it, or was shut down or the analyzer stopped part way.
+bool MeasureLoudness(const fs::path& soundPath, LoudnessInfo& info) {
+    AudioFormat format;
+    AudioHandle decoder = 0;
+    uint64_t epoch = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_loudnessDecodeMutex);
+        if (!g_bassInitialized) return false;
+        decoder = g_audio->OpenDecoder(soundPath, format);
+        epoch = g_audioBackendEpoch;
+    }
+    if (!decoder) return false;
+    
+    LoudnessMeter meter;
+    bool supported = meter.Prepare(format.sampleRate, format.channels);
+    if (!supported) {
+        WriteToSoundPlayerLog("LOUDNESS: " + soundPath.filename().string() + " has " + std::to_string(format.channels) +
+                             " channels, no known layout - not measured", __LINE__);
+    }
+    std::vector<float> buffer(kLoudnessDecodeFrames * std::max<uint32_t>(format.channels, 1));
+    
+    bool complete = false;
+    while (supported && g_loudnessActive.load()) {
+        size_t frames = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_loudnessDecodeMutex);
+            if (g_audioBackendEpoch != epoch) return false;
+            frames = g_audio->Decode(decoder, buffer.data(), kLoudnessDecodeFrames);
+        }
+        if (frames == 0) {
+            complete = true;
+            break;
+        }
+        meter.Add(buffer.data(), frames);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(g_loudnessDecodeMutex);
+        if (g_audioBackendEpoch == epoch) g_audio->Free(decoder);
+    }
+    if (!complete) return false;
+    
+    info.lufs = static_cast<float>(meter.IntegratedLufs());
+    info.truePeakDb = static_cast<float>(std::max(meter.TruePeakDb(), -120.0));
+    return true;
+}
+
+// Queues every sound the published mappings reference and this session has not
+// checked yet. Only resolves names; the workers stat and decode.
+void QueueLoudnessAnalysis() {
+    if (!g_loudnessEnabled.load()) return;
+    
+    std::vector<std::string> soundFiles;
+    {
+        auto tables = GetSoundTables();
+        for (const auto* configs : {&tables->animation, &tables->effect, &tables->position, &tables->tag}) {
+            for (const auto& [name, config] : *configs) {
+                for (const auto& option : config.soundOptions) soundFiles.push_back(option.soundFile);
+                for (const auto& [layerNum, sounds] : config.layers) {
+                    for (const auto& option : sounds) soundFiles.push_back(option.soundFile);
+                }
+            }
+        }
+        soundFiles.insert(soundFiles.end(), tables->soundMenuKeyTracks.begin(), tables->soundMenuKeyTracks.end());
+    }
+    std::sort(soundFiles.begin(), soundFiles.end());
+    soundFiles.erase(std::unique(soundFiles.begin(), soundFiles.end()), soundFiles.end());
+    
+    std::vector<std::pair<std::string, fs::path>> resolved;
+    for (const auto& soundFile : soundFiles) {
+        fs::path soundPath = FindSoundFile(soundFile);
+        if (!soundPath.empty()) resolved.emplace_back(LoudnessKey(soundPath), std::move(soundPath));
+    }
+    
+    size_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_loudnessMutex);
+        for (auto& [key, soundPath] : resolved) {
+            if (g_loudnessChecked.count(key) || !g_loudnessQueued.insert(key).second) continue;
+            g_loudnessQueue.emplace_back(std::move(key), std::move(soundPath));
+            queued++;
+        }
+    }
+    
+    if (queued > 0) {
+        WriteToSoundPlayerLog("LOUDNESS: Queued " + std::to_string(queued) + " sounds for checking", __LINE__);
+        g_loudnessCondition.notify_all();
+    }
+}
+
+void LoudnessWorkerThreadFunction() {
+    // Background mode also lowers the thread's I/O priority, so reading a large library
+    // does not compete with streams being opened.
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+    
+    while (true) {
+        std::string key;
+        fs::path soundPath;
+        {
+            std::unique_lock<std::mutex> lock(g_loudnessMutex);
+            // Decoding needs an initialized backend, which does not notify; poll for it.
+            g_loudnessCondition.wait_for(lock, std::chrono::seconds(1), [] {
+                return !g_loudnessActive.load() || (!g_loudnessQueue.empty() && g_bassInitialized);
+            });
+            if (!g_loudnessActive.load()) break;
+            if (g_loudnessQueue.empty() || !g_bassInitialized) continue;
+            
+            key = std::move(g_loudnessQueue.front().first);
+            soundPath = std::move(g_loudnessQueue.front().second);
+            g_loudnessQueue.pop_front();
+            g_loudnessInFlight++;
+        }
+        
+        uint64_t size = 0;
+        int64_t writeTime = 0;
+        bool stamped = ReadSoundFileStamp(soundPath, size, writeTime);
+        bool unchanged = false;
+        if (stamped) {
+            std::lock_guard<std::mutex> lock(g_loudnessMutex);
+            auto it = g_loudnessCache.find(key);
+            unchanged = it != g_loudnessCache.end() && it->second.size == size && it->second.writeTime == writeTime;
+        }
+        
+        LoudnessInfo info;
+        bool measured = false;
+        if (stamped && !unchanged) {
+            try {
+                measured = MeasureLoudness(soundPath, info);
+            } catch (...) {
+                logger::error("Error measuring loudness of {}", soundPath.filename().string());
+            }
+            info.size = size;
+            info.writeTime = writeTime;
+        }
+        
+        bool drained = false;
+        {
+            std::lock_guard<std::mutex> lock(g_loudnessMutex);
+            g_loudnessQueued.erase(key);
+            if (unchanged) {
+                g_loudnessUnchanged++;
+            } else if (measured) {
+                g_loudnessCache[key] = info;
+                g_loudnessAnalyzed++;
+                g_loudnessDirty = true;
+            } else if (g_loudnessActive.load()) {
+                g_loudnessFailed++;
+            }
+            if (g_loudnessActive.load()) g_loudnessChecked.insert(key);
+            drained = --g_loudnessInFlight == 0 && g_loudnessQueue.empty();
+            if (drained && g_loudnessActive.load()) LogLoudnessStats("Library checked");
+        }
+        
+        if (measured) {
+            WriteToSoundPlayerLog("LOUDNESS: " + soundPath.filename().string() + " - " +
+                                 std::to_string(static_cast<int>(std::lround(info.lufs))) + " LUFS, true peak " +
+                                 std::to_string(static_cast<int>(std::lround(info.truePeakDb))) + " dBTP", __LINE__);
+        }
+        if (drained) {
+            SaveLoudnessCache();
+        }
+    }
+}
+
+void StartLoudnessAnalyzer() {
+    if (g_loudnessActive.load()) return;
+    
+    g_loudnessCachePath = g_iniPath.parent_path() / "OSoundtracks-SA-Expansion-Sounds-NG-Loudness.txt";
+    LoadLoudnessCache();
+    
+    g_loudnessActive = true;
+    unsigned workers = std::clamp(std::thread::hardware_concurrency() / 4, 1u, 2u);
+    for (unsigned i = 0; i < workers; ++i) {
+        g_loudnessWorkers.emplace_back(LoudnessWorkerThreadFunction);
+    }
+    QueueLoudnessAnalysis();
+}
+
+void StopLoudnessAnalyzer() {
+    if (!g_loudnessActive.load()) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(g_loudnessMutex);
+        g_loudnessActive = false;
+        g_loudnessQueue.clear();
+        g_loudnessQueued.clear();
+    }
+    g_loudnessCondition.notify_all();
+    
+    for (auto& worker : g_loudnessWorkers) {
+        if (worker.joinable()) worker.join();
+    }
+    g_loudnessWorkers.clear();
+    SaveLoudnessCache();
+}
+
+// ========================================
+// Replay Tracing
+// ========================================
+// Lets the replay benchmark follow one OStim transition across threads. The replay
+// thread sets t_replayTraceId around CheckAndPlaySound, MakeAudioCommand copies it into
+// the command and the audio thread restores it while executing that command, so the
+// benchmark backend knows which transition a Play belongs to. Outside a replay the id
+// is zero and the hooks cost one thread-local read.
+static thread_local uint32_t t_replayTraceId = 0;
+
+// Heap allocations are counted only in builds configured with OSOUNDTRACKS_BENCHMARK_ALLOCS,
+// since it takes replacing the global operator new for the whole plugin. Elsewhere the
+// count stays at zero and the report says allocations were not counted.
+#ifdef OSOUNDTRACKS_BENCHMARK_ALLOCS
+static constexpr bool kCountHeapAllocations = true;
+static thread_local uint64_t t_heapAllocations = 0;
+
+void* operator new(std::size_t size) {
+    ++t_heapAllocations;
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete(void* block, std::size_t) noexcept { std::free(block); }
+
+inline uint64_t HeapAllocations() { return t_heapAllocations; }
+#else
+static constexpr bool kCountHeapAllocations = false;
+
+inline uint64_t HeapAllocations() { return 0; }
+#endif
+
+uint64_t ReadThreadCycles() {
+    ULONG64 cycles = 0;
+    QueryThreadCycleTime(GetCurrentThread(), &cycles);
+    return cycles;
+}
+
+void NoteReplayCommand(uint32_t traceId);
+void NoteReplayAudioWork(uint32_t traceId, uint64_t cycles, uint64_t allocations);
+
+// ========================================
+// Transition Latency
+// ========================================
+// A Play command started from an OStim.log line carries monotonic stamps for each stage
+// of its trip: line read, classified, mapping resolved (command queued), file opened and
+// stream playing. The gaps go into fixed log-linear histograms (HDR style: exact below
+// 64 us, then 32 sub-buckets per power of two, so about 3% resolution up to an hour),
+// which makes recording a few relaxed atomic adds and lets readers copy them without a
+// lock. The append stage compares OStim's wall-clock stamp with ours, so it is only as
+// precise as that stamp. Replays never set the stamps and are not recorded.
+
+// Lines older than this were already in the file when we got to it (initial scan,
+// previous session) and would only swamp the append histogram.
+static constexpr int64_t kMaxAppendLagMs = 60 * 1000;
+static constexpr int64_t kMillisPerDay = 24LL * 60 * 60 * 1000;
+
+uint64_t MonotonicMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+int64_t LocalMillisOfDay() {
+    auto now = std::chrono::system_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+    std::time_t time_t = std::chrono::system_clock::to_time_t(now);
+    std::tm buf;
+    localtime_s(&buf, &time_t);
+    return ((static_cast<int64_t>(buf.tm_hour) * 60 + buf.tm_min) * 60 + buf.tm_sec) * 1000 + ms.count();
+}
+
+class LatencyHistogram {
+public:
+    static constexpr uint32_t kLinearBuckets = 64;
+    static constexpr uint32_t kSubBucketBits = 5;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr uint32_t kBucketCount = kLinearBuckets + (32 - 6) * kSubBuckets;
+
+    // Any thread; never blocks.
+    void Record(uint64_t micros) {
+        uint32_t value = static_cast<uint32_t>(std::min<uint64_t>(micros, UINT32_MAX));
+        buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        totalMicros.fetch_add(value, std::memory_order_relaxed);
+        uint32_t seen = maxMicros.load(std::memory_order_relaxed);
+        while (value > seen && !maxMicros.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Buckets are read one by one, so a snapshot taken during a Record may miss that
+    // sample; the count is whatever the buckets held when they were read.
+    void Snapshot(OSoundtracksAPI::LatencyStageStats& out) const {
+        std::array<uint32_t, kBucketCount> counts;
+        uint64_t count = 0;
+        for (uint32_t i = 0; i < kBucketCount; ++i) {
+            counts[i] = buckets[i].load(std::memory_order_relaxed);
+            count += counts[i];
+        }
+        out.count = count;
+        out.totalMicros = totalMicros.load(std::memory_order_relaxed);
+        out.maxMicros = maxMicros.load(std::memory_order_relaxed);
+        out.p50Micros = std::min(Percentile(counts, count, 50.0), out.maxMicros);
+        out.p90Micros = std::min(Percentile(counts, count, 90.0), out.maxMicros);
+        out.p99Micros = std::min(Percentile(counts, count, 99.0), out.maxMicros);
+    }
+
+private:
+    static uint32_t BucketIndex(uint32_t value) {
+        if (value < kLinearBuckets) return value;
+        uint32_t msb = static_cast<uint32_t>(std::bit_width(value)) - 1;
+        uint32_t shift = msb - kSubBucketBits;
+        return kLinearBuckets + (msb - 6) * kSubBuckets + ((value >> shift) - kSubBuckets);
+    }
+
+    // Largest value that lands in the bucket.
+    static uint32_t BucketUpperBound(uint32_t index) {
+        if (index < kLinearBuckets) return index;
+        uint32_t msb = (index - kLinearBuckets) / kSubBuckets + 6;
+        uint64_t sub = (index - kLinearBuckets) % kSubBuckets + kSubBuckets;
+        return static_cast<uint32_t>(((sub + 1) << (msb - kSubBucketBits)) - 1);
+    }
+
+    static uint32_t Percentile(const std::array<uint32_t, kBucketCount>& counts, uint64_t count, double percentile) {
+        if (count == 0) return 0;
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(count * percentile / 100.0)));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < kBucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return BucketUpperBound(i);
+        }
+        return BucketUpperBound(kBucketCount - 1);
+    }
+
+    std::array<std::atomic<uint32_t>, kBucketCount> buckets{};
+    std::atomic<uint64_t> totalMicros{0};
+    std::atomic<uint32_t> maxMicros{0};
+};
+
+static std::array<LatencyHistogram, OSoundtracksAPI::kLatencyStageCount> g_latencyHistograms;
+static const uint64_t g_latencyEpochMicros = MonotonicMicros();
+
+// Set by ProcessOStimLog around CheckAndPlaySound; MakeAudioCommand copies it into Play
+// commands the same way it copies t_replayTraceId.
+struct TransitionStamps {
+    uint64_t readMicros = 0;
+    uint64_t classifiedMicros = 0;
+};
+static thread_local TransitionStamps t_transitionStamps;
+
+void RecordLatency(OSoundtracksAPI::LatencyStage stage, uint64_t fromMicros, uint64_t toMicros) {
+    if (fromMicros && toMicros >= fromMicros) {
+        g_latencyHistograms[stage].Record(toMicros - fromMicros);
+    }
+}
+
+void ReadLatencyStats(OSoundtracksAPI::LatencyStats& out) {
+    out.version = OSoundtracksAPI::kLatencyStatsVersion;
+    out.stageCount = OSoundtracksAPI::kLatencyStageCount;
+    out.sinceMicros = MonotonicMicros() - g_latencyEpochMicros;
+    for (uint32_t i = 0; i < OSoundtracksAPI::kLatencyStageCount; ++i) {
+        g_latencyHistograms[i].Snapshot(out.stages[i]);
+    }
+}
+
+// ========================================
+// Audio Command Thread
+// ========================================
+// Every channel operation is posted to a single worker instead of running on the
+// caller's thread. Producers (OStim monitor, UI event sinks, INI monitor, timers) only
+// allocate a node and do one atomic exchange, so opening the Journal never waits
+// behind a file open or another thread's BASS call. The queue is an intrusive
+// Vyukov MPSC list: producers swap the head, the one consumer walks from the tail.
+
+enum class AudioCommandType {
+    Play, Stop, Pause, Resume, SetVolume, UpdateVolume, UpdateVolumes, SoundMenuKeyPreload, SoundMenuKeyAdvance, RefreshNowPlaying,
+    PauseGroups, ResumeGroups, ReleaseOutput
+};
+
+struct AudioCommand {
+    AudioCommandType type = AudioCommandType::Play;
+    ScriptType channel = SCRIPT_BASE;
+    std::string soundFile;
+    bool loop = true;
+    float volume = 1.0f;
+    uint32_t fadeMs = 0;
+    uint64_t sequence = 0;
+    uint32_t traceId = 0;
+    uint64_t readMicros = 0;
+    uint64_t classifiedMicros = 0;
+    uint64_t resolvedMicros = 0;
+    uint32_t groups = 0;
+    AudioHandle stream = 0;
+    AudioHandle ended = 0;  // SoundMenuKeyAdvance: the stream whose end triggered it
+    AudioOutput* output = nullptr;  // null: the live output
+    std::atomic<AudioCommand*> next{nullptr};
+};
+
+class AudioCommandQueue {
+public:
+    AudioCommandQueue() : head(&stub), tail(&stub) {}
+
+    // Any thread; never blocks.
+    void Push(AudioCommand* command) {
+        command->next.store(nullptr, std::memory_order_relaxed);
+        AudioCommand* previous = head.exchange(command, std::memory_order_acq_rel);
+        previous->next.store(command, std::memory_order_release);
+    }
+
+    // Consumer thread only. Returns nullptr when empty, and also while a producer sits
+    // between its exchange and its link; that producer's wake-up follows the link.
+    AudioCommand* Pop() {
+        AudioCommand* current = tail;
+        AudioCommand* next = current->next.load(std::memory_order_acquire);
+
+        if (current == &stub) {
+            if (!next) return nullptr;
+            tail = next;
+            current = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            tail = next;
+            return current;
+        }
+
+        if (current != head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        Push(&stub);
+        next = current->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return current;
+        }
+        return nullptr;
+    }
+
+private:
+    AudioCommand stub;
+    std::atomic<AudioCommand*> head;
+    AudioCommand* tail;
+};
+
+static AudioCommandQueue g_audioCommands;
+static std::atomic<uint32_t> g_audioCommandSignal(0);
+static std::atomic<uint64_t> g_audioCommandSequence(0);
+static std::atomic<uint64_t> g_audioCommandsExecuted(0);
+static std::atomic<bool> g_audioWorkerActive(false);
+static std::atomic<uint32_t> g_audioPostsInFlight(0);
+static std::thread g_audioWorkerThread;
+
+// SoundMenuKey playlist advance: a position sync a few seconds before the end posts a
+// preload command, the audio thread opens and pre-buffers the next track without
+// playing it, and a mixtime end sync starts it in the same BASS update the old track
+// runs out. Preload state is owned by the audio thread except for the handle swap.
+static constexpr double kSoundMenuKeyPreloadSeconds = 5.0;
+static std::atomic<AudioHandle> g_soundMenuKeyPreloadStream(0);
+static std::string g_soundMenuKeyPreloadTrack;
+
+// The end sync must not allocate on the mixer thread, so instead of posting a command it
+// packs the ended stream (high word) and the one it started (low word) into this slot
+// and wakes the audio thread, which takes it in DrainAudioCommands.
+static std::atomic<uint64_t> g_soundMenuKeyEndedStreams(0);
+
+void PostAudioCommand(AudioCommand* command);
+AudioCommand* MakeAudioCommand(AudioCommandType type, ScriptType channel);
+bool HoldChannelForPausedGroup(ScriptType type);
+void PlayBASSSound(const std::string& soundFile, ScriptType type, bool loop);
+
+void SoundMenuKeyPreloadSync(AudioHandle channel) {
+    AudioCommand* command = MakeAudioCommand(AudioCommandType::SoundMenuKeyPreload, SCRIPT_CHECK);
+    command->stream = channel;
+    PostAudioCommand(command);
+}
+
+// Mixtime sync: runs in the BASS update thread as the last sample is mixed. Only the
+// handle swap and the play happen here; the bookkeeping is handed to the audio thread.
+void SoundMenuKeyEndSync(AudioHandle channel) {
+    // A stream that was replaced or faded out can still run into its end; ignore it.
+    if (GetChannel(SCRIPT_CHECK)->Handle() != channel) return;
+    
+    AudioHandle next = g_soundMenuKeyPreloadStream.exchange(0);
+    if (next) {
+        Audio()->Play(next);
+    }
+    
+    g_soundMenuKeyEndedStreams.store((static_cast<uint64_t>(channel) << 32) | next, std::memory_order_release);
+    g_audioCommandSignal.fetch_add(1, std::memory_order_release);
+    g_audioCommandSignal.notify_one();
+}
+
+void ArmSoundMenuKeySyncs(AudioHandle stream) {
+    double length = Audio()->Length(stream);
+    if (length > 0.0) {
+        Audio()->SyncAt(stream, std::max(length - kSoundMenuKeyPreloadSeconds, 0.0), SoundMenuKeyPreloadSync);
+    }
+    
+    Audio()->SyncEnd(stream, SoundMenuKeyEndSync);
+}
+
+void DiscardSoundMenuKeyPreload() {
+    AudioHandle preloaded = g_soundMenuKeyPreloadStream.exchange(0);
+    if (preloaded) {
+        Audio()->Stop(preloaded);
+        Audio()->Free(preloaded);
+    }
+    if (!g_soundMenuKeyPreloadTrack.empty()) {
+        ReleaseSoundMenuKeyReservation(false);
+    }
+    g_soundMenuKeyPreloadTrack.clear();
+}
+
+void ExecuteSoundMenuKeyPreload(const AudioCommand& command) {
+    Channel* channel = GetChannel(SCRIPT_CHECK);
+    if (!g_soundMenuKeyActive.load() || channel->Handle() != command.stream) {
+        return;
+    }
+    
+    DiscardSoundMenuKeyPreload();
+    
+    size_t position = 0;
+    size_t total = 0;
+    std::string track = AdvanceSoundMenuKeyPlaylist(position, total, true);
+    if (track.empty()) return;
+    
+    g_soundMenuKeyPreloadTrack = track;
+    
+    fs::path soundPath = FindSoundFile(track);
+    if (soundPath.empty()) return;
+    
+    AudioHandle next = CreateBASSChannel(soundPath, false);
+    if (!next) return;
+    
+    Audio()->SetLevel(next, channel->TargetVolume());
+    Audio()->Prebuffer(next);
+    
+    g_soundMenuKeyPreloadStream = next;
+    WriteToSoundPlayerLog("SoundMenuKey: Preloaded '" + track + "' (" + std::to_string(position) + "/" +
+                         std::to_string(total) + ")", __LINE__);
+}
+
+void ExecuteSoundMenuKeyAdvance(const AudioCommand& command) {
+    Channel* channel = GetChannel(SCRIPT_CHECK);
+    std::string track = std::move(g_soundMenuKeyPreloadTrack);
+    g_soundMenuKeyPreloadTrack.clear();
+    
+    // A Play or Stop that ran between the end sync and this command has already replaced
+    // the ended track; the preloaded one must not take over from the user's pick.
+    if (!g_soundMenuKeyActive.load() || channel->Handle() != command.ended) {
+        if (command.stream) {
+            Audio()->Stop(command.stream);
+            Audio()->Free(command.stream);
+        }
+        if (!track.empty()) {
+            ReleaseSoundMenuKeyReservation(false);
+        }
+        return;
+    }
+    
+    if (!track.empty()) {
+        ReleaseSoundMenuKeyReservation(true);
+    }
+    
+    if (command.stream) {
+        {
+            std::lock_guard<std::mutex> lock(g_bassMutex);
+            channel->Adopt(command.stream);
+            if (g_soundMenuKeyPaused.load()) {
+                channel->Pause();
+            } else {
+                HoldChannelForPausedGroup(SCRIPT_CHECK);
+            }
+        }
+        ArmSoundMenuKeySyncs(command.stream);
+        g_currentSoundMenuKeyTrack = track;
+        Output().tracks[SCRIPT_CHECK] = track;
+        
+        WriteToSoundPlayerLog("SoundMenuKey: Gapless advance to '" + track + "'", __LINE__);
+        
+        std::string displayName = track;
+        size_t dotPos = displayName.find_last_of('.');
+        if (dotPos != std::string::npos) {
+            displayName = displayName.substr(0, dotPos);
+        }
+        ShowGameNotification("OSoundtracks - \"" + displayName + "\" is played");
+        return;
+    }
+    
+    WriteToSoundPlayerLog("SoundMenuKey: Track finished, playing next", __LINE__);
+    if (!track.empty()) {
+        g_currentSoundMenuKeyTrack = track;
+        PlayBASSSound(track, SCRIPT_CHECK, false);
+    } else {
+        PlayNextSoundMenuKeyTrack();
+    }
+}
+
+// Group pause/resume and the hold for streams started into a paused group. Callers
+// hold g_bassMutex; the pause and resume themselves only run on the audio thread.
+// Groups cover the outputs on g_audio: the live one and the mixed scenes', whose streams
+// are held like position layers. The replay's output plays on regardless.
+bool HoldChannelForPausedGroup(ScriptType type) {
+    ChannelGroupState& group = GetChannelGroup(ChannelGroupOf(type));
+    if (!group.paused || Output().backend) return false;
+    Output().channels[type].Pause();
+    if (t_audioOutput) {
+        group.streams.push_back(Output().channels[type].Handle());
+    } else {
+        group.channels |= 1u << type;
+    }
+    return true;
+}
+
+bool HoldStreamForPausedGroup(uint32_t groupId, AudioHandle stream) {
+    ChannelGroupState& group = GetChannelGroup(groupId);
+    if (!group.paused || !stream || Output().backend) return false;
+    g_audio->Pause(stream);
+    group.streams.push_back(stream);
+    return true;
+}
+
+// A live position layer, or any stream of a mixed scene.
+bool IsOStimGroupStream(AudioHandle stream) {
+    auto inLayers = [stream](const AudioOutput& output) {
+        for (const auto& [fragment, layers] : output.positionStreams) {
+            for (const auto& [layerNum, layerStream] : layers) {
+                if (layerStream == stream) return true;
+            }
+        }
+        return false;
+    };
+    if (inLayers(g_liveOutput)) return true;
+    for (const AudioOutput* output : g_sceneOutputs) {
+        if (inLayers(*output)) return true;
+        for (const auto& channel : output->channels) {
+            if (channel.Handle() == stream) return true;
+        }
+    }
+    return false;
+}
+
+const char* ChannelGroupName(uint32_t group) {
+    switch (group) {
+        case kGroupOStim: return "OStim";
+        case kGroupMenu: return "Menu";
+        case kGroupPreview: return "Preview";
+        default: return "?";
+    }
+}
+
+void PauseChannelGroupLocked(uint32_t groupId, uint32_t fadeMs) {
+    ChannelGroupState& group = GetChannelGroup(groupId);
+    if (group.paused) return;
+    group.paused = true;
+    group.channels = 0;
+    group.streams.clear();
+    
+    auto fadeOut = [fadeMs](AudioHandle stream) {
+        AudioActivity activity = g_audio->Activity(stream);
+        if (activity != AudioActivity::Playing && activity != AudioActivity::Stalled) return false;
+        g_audio->FadeOutAndPause(stream, fadeMs);
+        return true;
+    };
+    
+    for (size_t i = 0; i < g_liveOutput.channels.size(); ++i) {
+        AudioHandle stream = g_liveOutput.channels[i].Handle();
+        if (ChannelGroupOf(static_cast<ScriptType>(i)) == groupId && stream && fadeOut(stream)) {
+            group.channels |= 1u << i;
+        }
+    }
+    if (groupId == kGroupOStim) {
+        for (const auto& [fragment, layers] : g_liveOutput.positionStreams) {
+            for (const auto& [layerNum, stream] : layers) {
+                if (stream && fadeOut(stream)) group.streams.push_back(stream);
+            }
+        }
+        for (const AudioOutput* output : g_sceneOutputs) {
+            for (const auto& channel : output->channels) {
+                AudioHandle stream = channel.Handle();
+                if (stream && fadeOut(stream)) group.streams.push_back(stream);
+            }
+            for (const auto& [fragment, layers] : output->positionStreams) {
+                for (const auto& [layerNum, stream] : layers) {
+                    if (stream && fadeOut(stream)) group.streams.push_back(stream);
+                }
+            }
+        }
+    }
+    if (groupId == kGroupPreview && g_authorPreviewStream && fadeOut(g_authorPreviewStream)) {
+        group.streams.push_back(g_authorPreviewStream);
+    }
+    
+    WriteToSoundPlayerLog("GROUP PAUSE: " + std::string(ChannelGroupName(groupId)) + " - " +
+                         std::to_string(std::popcount(group.channels)) + " channels, " +
+                         std::to_string(group.streams.size()) + " loose streams, fade=" + std::to_string(fadeMs) + "ms", __LINE__);
+}
+
+void ResumeChannelGroupLocked(uint32_t groupId, uint32_t fadeMs) {
+    ChannelGroupState& group = GetChannelGroup(groupId);
+    if (!group.paused) return;
+    group.paused = false;
+    
+    // A fade-out may still be running or may have left the stream at zero; either way
+    // the ramp starts from wherever the volume is now. Levels were never touched.
+    auto fadeIn = [fadeMs](AudioHandle stream) {
+        g_audio->Play(stream);
+        if (fadeMs > 0) {
+            g_audio->SlideVolume(stream, 1.0f, fadeMs);
+        } else {
+            g_audio->SetVolume(stream, 1.0f);
+        }
+    };
+    
+    int resumedChannels = 0;
+    for (size_t i = 0; i < g_liveOutput.channels.size(); ++i) {
+        AudioHandle stream = g_liveOutput.channels[i].Handle();
+        if ((group.channels & (1u << i)) && stream) {
+            fadeIn(stream);
+            resumedChannels++;
         }
     }
     
-    g_bassInitialized = true;
-    logger::info("BASS Audio Library initialized successfully from: {}", bassPath.string());
-    WriteToSoundPlayerLog("BASS Audio Library initialized successfully", __LINE__);
-    return true;
+    // Layers stopped or replaced while paused are gone from the position streams; their
+    // handles may already be freed, so only ones still listed are touched.
+    size_t resumedStreams = 0;
+    for (AudioHandle stream : group.streams) {
+        if ((groupId == kGroupPreview && stream == g_authorPreviewStream) ||
+            (groupId == kGroupOStim && IsOStimGroupStream(stream))) {
+            fadeIn(stream);
+            resumedStreams++;
+        }
+    }
+    group.channels = 0;
+    group.streams.clear();
+    
+    WriteToSoundPlayerLog("GROUP RESUME: " + std::string(ChannelGroupName(groupId)) + " - " +
+                         std::to_string(resumedChannels) + " channels, " + std::to_string(resumedStreams) +
+                         " loose streams, fade=" + std::to_string(fadeMs) + "ms", __LINE__);
 }
 
-void ShutdownBASSLibrary() {
-    std::lock_guard<std::mutex> lock(g_bassMutex);
-    
-    if (g_baseStream) { if (pBASS_StreamFree) pBASS_StreamFree(g_baseStream); g_baseStream = 0; }
-    if (g_menuStream) { if (pBASS_StreamFree) pBASS_StreamFree(g_menuStream); g_menuStream = 0; }
-    if (g_specificStream) { if (pBASS_StreamFree) pBASS_StreamFree(g_specificStream); g_specificStream = 0; }
-    if (g_effectStream) { if (pBASS_StreamFree) pBASS_StreamFree(g_effectStream); g_effectStream = 0; }
-    if (g_tagStream) { if (pBASS_StreamFree) pBASS_StreamFree(g_tagStream); g_tagStream = 0; }
-    if (g_soundMenuKeyStream) { if (pBASS_StreamFree) pBASS_StreamFree(g_soundMenuKeyStream); g_soundMenuKeyStream = 0; }
-    if (g_authorPreviewStream) { if (pBASS_StreamFree) pBASS_StreamFree(g_authorPreviewStream); g_authorPreviewStream = 0; }
+void ExecuteChannelGroupCommand(const AudioCommand& command) {
+    if (!g_bassInitialized) return;
     
-    for (auto& [fragment, layers] : g_positionStreams) {
-        for (auto& [layerNum, stream] : layers) {
-            if (stream && pBASS_StreamFree) {
-                pBASS_StreamFree(stream);
-                stream = 0;
+    std::lock_guard<std::mutex> lock(g_bassMutex);
+    for (uint32_t group = kGroupOStim; group <= kGroupPreview; group <<= 1) {
+        if (!(command.groups & group)) continue;
+        if (command.type == AudioCommandType::PauseGroups) {
+            PauseChannelGroupLocked(group, command.fadeMs);
+        } else {
+            ResumeChannelGroupLocked(group, command.fadeMs);
+        }
+    }
+}
+
+// ========================================
+// Voice Budget
+// ========================================
+// Caps how many streams play at once; position layers would otherwise stack without
+// bound on top of the channels. Every voice has a priority, fixed per channel and one
+// step lower per position layer. A start that would go over [Audio Engine] MaxVoices
+// fades out the lowest-priority voice at or below its own, and is dropped if every
+// voice outranks it. Paused and retiring streams don't count. The author preview counts
+// but is never stolen and never refused. The outputs on g_audio (the live one and the
+// mixed scenes') share one budget and the live output's counters; the replay's output
+// has its own. Guarded by g_bassMutex.
+
+// Indexed by ScriptType.
+static constexpr std::array<uint8_t, 7> kChannelVoicePriority = {
+    80,  // BASE
+    90,  // SPECIFIC
+    95,  // MENU
+    85,  // SOUNDMENUKEY
+    60,  // EFFECT
+    50,  // POSITION
+    70,  // TAG
+};
+static constexpr int kPositionLayerVoicePriority = 40;  // layer 0; each further layer is one lower
+static constexpr uint32_t kVoiceStealFadeMs = 300;
+
+static std::atomic<uint32_t> g_maxVoices(16);
+static std::atomic<float> g_decodeCpuPercent(0.0f);
+
+struct Voice {
+    AudioHandle stream = 0;
+    uint8_t priority = 0;
+    int channel = -1;                       // ScriptType, or -1 for a position layer
+    const std::string* fragment = nullptr;  // position layers only
+    int layer = 0;
+    AudioOutput* output = nullptr;
+};
+
+// The output whose counters the current output's voices count against.
+AudioOutput& BudgetOutput() { return Output().backend ? Output() : g_liveOutput; }
+
+uint8_t PositionLayerVoicePriority(int layer) {
+    return static_cast<uint8_t>(kPositionLayerVoicePriority - std::clamp(layer, 0, kPositionLayerVoicePriority - 1));
+}
+
+bool IsVoicePlaying(AudioHandle stream) {
+    AudioActivity activity = Audio()->Activity(stream);
+    return activity == AudioActivity::Playing || activity == AudioActivity::Stalled;
+}
+
+// Fills `voices` with everything that could be stolen and returns the total count,
+// which also includes the author preview. Mixed scenes come first, so they lose ties
+// with the live output.
+size_t CollectVoicesLocked(std::vector<Voice>& voices) {
+    voices.clear();
+    auto collect = [&voices](AudioOutput& output) {
+        for (size_t i = 0; i < output.channels.size(); ++i) {
+            AudioHandle stream = output.channels[i].Handle();
+            if (stream && IsVoicePlaying(stream)) {
+                voices.push_back({stream, kChannelVoicePriority[i], static_cast<int>(i), nullptr, 0, &output});
+            }
+        }
+        for (const auto& [fragment, layers] : output.positionStreams) {
+            for (const auto& [layerNum, stream] : layers) {
+                if (stream && IsVoicePlaying(stream)) {
+                    voices.push_back({stream, PositionLayerVoicePriority(layerNum), -1, &fragment, layerNum, &output});
+                }
             }
         }
+    };
+    if (Output().backend) {
+        collect(Output());
+    } else {
+        for (AudioOutput* output : g_sceneOutputs) collect(*output);
+        collect(g_liveOutput);
     }
-    g_positionStreams.clear();
-    g_activePositionFragments.clear();
-    g_positionLayersActiveBeforePause.clear();
-    
-    if (g_bassInitialized && pBASS_Free) {
-        pBASS_Free();
+    bool previewPlaying = g_authorPreviewStream && IsVoicePlaying(g_authorPreviewStream);
+    return voices.size() + (previewPlaying ? 1 : 0);
+}
+
+void NoteVoiceCount(size_t count) {
+    AudioOutput& output = BudgetOutput();
+    uint32_t active = static_cast<uint32_t>(count);
+    output.activeVoices = active;
+    uint32_t peak = output.peakVoices.load();
+    while (active > peak && !output.peakVoices.compare_exchange_weak(peak, active)) {}
+}
+
+// Channels are only stolen from the audio thread, which owns the outputs' tracks.
+void StealVoiceLocked(const Voice& voice) {
+    std::string name;
+    AudioOutput& output = *voice.output;
+    if (voice.channel >= 0) {
+        Channel& channel = output.channels[voice.channel];
+        channel.Stop(kVoiceStealFadeMs);
+        channel.PlayFailed(output.startSequences[voice.channel]);
+        output.tracks[voice.channel].clear();
+        name = channel.Name();
+    } else {
+        output.positionStreams[*voice.fragment].erase(voice.layer);
+        Audio()->FadeOutAndFree(voice.stream, kVoiceStealFadeMs);
+        name = "position '" + *voice.fragment + "' layer " + std::to_string(voice.layer);
     }
-    
-    if (g_bassModule) {
-        FreeLibrary(g_bassModule);
-        g_bassModule = nullptr;
+    if (&output != &g_liveOutput && !output.backend) name += " of a mixed scene";
+    BudgetOutput().stolenVoices++;
+    WriteToSoundPlayerLog("VOICES: Stole " + name + " (priority " + std::to_string(voice.priority) + ")", __LINE__);
+}
+
+// Makes room for one more voice of the given priority. `replacing` is the stream the new
+// one takes over from (a channel's current track), which gives its slot back. Returns
+// false if the start has to be dropped.
+bool AdmitVoiceLocked(uint8_t priority, AudioHandle replacing, bool mayStealChannels, const std::string& what) {
+    static std::vector<Voice> voices;
+    size_t count = CollectVoicesLocked(voices);
+    if (replacing && std::any_of(voices.begin(), voices.end(), [&](const Voice& v) { return v.stream == replacing; })) {
+        count--;
+    }
+    
+    uint32_t maxVoices = g_maxVoices.load();
+    while (maxVoices > 0 && count >= maxVoices) {
+        auto victim = voices.end();
+        for (auto it = voices.begin(); it != voices.end(); ++it) {
+            if (it->stream == replacing || (it->channel >= 0 && !mayStealChannels)) continue;
+            if (victim == voices.end() || it->priority < victim->priority) victim = it;
+        }
+        if (victim == voices.end() || victim->priority > priority) {
+            BudgetOutput().refusedVoiceStarts++;
+            WriteToSoundPlayerLog("VOICES: All " + std::to_string(maxVoices) + " voices outrank " + what +
+                                 " (priority " + std::to_string(priority) + ") - not started", __LINE__);
+            return false;
+        }
+        StealVoiceLocked(*victim);
+        voices.erase(victim);
+        count--;
     }
     
-    g_bassInitialized = false;
-    WriteToSoundPlayerLog("BASS Audio Library shutdown complete (multi-layer position cleaned)", __LINE__);
+    NoteVoiceCount(count + 1);
+    return true;
 }
 
-fs::path FindSoundFile(const std::string& baseName) {
-    if (baseName.empty()) return fs::path();
+// The budget shared by the live output and the mixed scenes. Never waits for
+// g_bassMutex; if the audio thread holds it, the last counts are reported.
+void ReadVoiceStats(OSoundtracksAPI::VoiceStats& out) {
+    {
+        std::unique_lock<std::mutex> lock(g_bassMutex, std::try_to_lock);
+        if (lock.owns_lock() && g_bassInitialized) {
+            std::vector<Voice> voices;
+            NoteVoiceCount(CollectVoicesLocked(voices));
+        }
+    }
+    out.version = OSoundtracksAPI::kVoiceStatsVersion;
+    out.maxVoices = g_maxVoices.load();
+    out.activeVoices = g_liveOutput.activeVoices.load();
+    out.peakVoices = g_liveOutput.peakVoices.load();
+    out.stolenVoices = g_liveOutput.stolenVoices.load();
+    out.refusedStarts = g_liveOutput.refusedVoiceStarts.load();
+    out.decodeCpuPercent = g_decodeCpuPercent.load();
+}
+
+// Called once per heartbeat, the only caller of TakeCpuPercent, so the API and the stats
+// file both report the same full window. Skipped (the window grows) while the audio
+// thread holds g_bassMutex.
+void SampleDecodeCpu() {
+    std::unique_lock<std::mutex> lock(g_bassMutex, std::try_to_lock);
+    if (lock.owns_lock() && g_bassInitialized) {
+        g_decodeCpuPercent = g_audio->TakeCpuPercent();
+    }
+}
+
+bool ExecutePlayCommand(const AudioCommand& command) {
+    const std::string& soundFile = command.soundFile;
+    bool loop = command.loop;
     
-    std::string nameWithoutExt = baseName;
-    std::string originalExt = "";
+    if (!g_bassInitialized) {
+        if (!InitializeBASSLibrary()) return false;
+    }
     
-    size_t lastDot = baseName.find_last_of('.');
-    if (lastDot != std::string::npos) {
-        originalExt = baseName.substr(lastDot);
-        nameWithoutExt = baseName.substr(0, lastDot);
+    Channel* channel = GetChannel(command.channel);
+    if (!channel) {
+        return false;
     }
     
-    fs::path testPath = g_soundsDirectory / baseName;
-    if (!originalExt.empty() && fs::exists(testPath)) {
-        return testPath;
+    fs::path soundPath = FindSoundFile(soundFile);
+    if (soundPath.empty()) {
+        return false;
     }
     
-    fs::path wavPath = g_soundsDirectory / (nameWithoutExt + ".wav");
-    if (fs::exists(wavPath)) {
-        return wavPath;
+    AudioHandle stream = CreateBASSChannel(soundPath, loop);
+    
+    if (!stream) {
+        int error = Audio()->LastError();
+        logger::error("BASS: Failed to create stream for {}: error {}", soundPath.string(), error);
+        WriteToSoundPlayerLog("BASS ERROR: Failed to create stream, error " + std::to_string(error), __LINE__);
+        return false;
     }
+    uint64_t openedMicros = command.readMicros ? MonotonicMicros() : 0;
     
-    fs::path mp3Path = g_soundsDirectory / (nameWithoutExt + ".mp3");
-    if (fs::exists(mp3Path)) {
-        return mp3Path;
+    uint32_t fadeMs = command.fadeMs;
+    {
+        std::lock_guard<std::mutex> lock(g_bassMutex);
+        if (!AdmitVoiceLocked(kChannelVoicePriority[command.channel], channel->Handle(), true,
+                              std::string(channel->Name()) + " '" + soundFile + "'")) {
+            Audio()->Free(stream);
+            return false;
+        }
+        if (!channel->Start(stream, fadeMs)) {
+            int error = Audio()->LastError();
+            logger::error("BASS: Failed to play stream: error {}", error);
+            return false;
+        }
+        Output().startSequences[command.channel] = command.sequence;
+        if (HoldChannelForPausedGroup(command.channel)) {
+            WriteToSoundPlayerLog("BASS: " + std::string(channel->Name()) + " started into a paused group - held", __LINE__);
+        }
+    }
+    if (command.readMicros) {
+        uint64_t playingMicros = MonotonicMicros();
+        RecordLatency(OSoundtracksAPI::kStageClassifiedToResolved, command.classifiedMicros, command.resolvedMicros);
+        RecordLatency(OSoundtracksAPI::kStageResolvedToOpened, command.resolvedMicros, openedMicros);
+        RecordLatency(OSoundtracksAPI::kStageOpenedToPlaying, openedMicros, playingMicros);
+        RecordLatency(OSoundtracksAPI::kStageTotal, command.readMicros, playingMicros);
     }
+    Output().tracks[command.channel] = soundFile;
     
-    fs::path oggPath = g_soundsDirectory / (nameWithoutExt + ".ogg");
-    if (fs::exists(oggPath)) {
-        return oggPath;
+    if (command.channel == SCRIPT_CHECK && !loop) {
+        ArmSoundMenuKeySyncs(stream);
     }
     
-    logger::warn("Sound file not found: {} (tried .wav, .mp3, .ogg)", baseName);
-    WriteToSoundPlayerLog("BASS WARNING: Sound file not found: " + baseName, __LINE__);
-    return fs::path();
+    float volume = channel->TargetVolume();
+    std::string displayName = soundFile;
+    if (displayName.size() >= 4 && displayName.substr(displayName.size() - 4) == ".wav") {
+        displayName = displayName.substr(0, displayName.size() - 4);
+    }
+    
+    WriteToSoundPlayerLog("BASS: Playing " + displayName + " [" + channel->Name() + "] (loop=" + (loop ? "true" : "false") + ", vol=" + std::to_string(static_cast<int>(volume * 100)) + "%, fade=" + std::to_string(fadeMs) + "ms)", __LINE__);
+    
+    if (soundFile != "Debug.wav") {
+        std::string notificationMsg = "OSoundtracks - \"" + displayName + "\" is played";
+        ShowGameNotification(notificationMsg);
+    }
+    
+    return true;
 }
 
-HSTREAM PlayBASSSound(const std::string& soundFile, ScriptType type, bool loop = true) {
-    if (!g_bassInitialized) {
-        if (!InitializeBASSLibrary()) return 0;
-    }
+void ExecuteUpdateVolumesCommand() {
+    if (!g_bassInitialized) return;
     
-    fs::path soundPath = FindSoundFile(soundFile);
-    if (soundPath.empty()) {
-        return 0;
+    float baseVol = g_volumeControlEnabled.load() ? g_baseVolume.load() : 1.0f;
+    float menuVol = g_volumeControlEnabled.load() ? g_menuVolume.load() : 1.0f;
+    float specificVol = g_volumeControlEnabled.load() ? g_specificVolume.load() : 1.0f;
+    float effectVol = g_volumeControlEnabled.load() ? g_effectVolume.load() : 1.0f;
+    float positionVol = g_volumeControlEnabled.load() ? g_positionVolume.load() : 1.0f;
+    float tagVol = g_volumeControlEnabled.load() ? g_tagVolume.load() : 1.0f;
+    float soundMenuKeyVol = g_volumeControlEnabled.load() ? g_soundMenuKeyVolume.load() : 1.0f;
+    
+    {
+        std::lock_guard<std::mutex> lock(g_bassMutex);
+        AudioOutput& output = Output();
+        for (const auto& channel : output.channels) {
+            channel.SetLevel(channel.TargetVolume());
+        }
+        float layerVolume = PositionLayerVolume();
+        for (const auto& [fragment, layers] : output.positionStreams) {
+            for (const auto& [layerNum, stream] : layers) {
+                if (stream) Audio()->SetLevel(stream, layerVolume);
+            }
+        }
     }
     
-    std::lock_guard<std::mutex> lock(g_bassMutex);
+    WriteToSoundPlayerLog("BASS: Volumes updated - Base: " + std::to_string(static_cast<int>(baseVol * 100)) + 
+                         "%, Menu: " + std::to_string(static_cast<int>(menuVol * 100)) + 
+                         "%, Specific: " + std::to_string(static_cast<int>(specificVol * 100)) +
+                         "%, Effect: " + std::to_string(static_cast<int>(effectVol * 100)) +
+                         "%, Position: " + std::to_string(static_cast<int>(positionVol * 100)) +
+                         "%, Tag: " + std::to_string(static_cast<int>(tagVol * 100)) + 
+                         "%, SoundMenuKey: " + std::to_string(static_cast<int>(soundMenuKeyVol * 100)) + "%", __LINE__);
+}
+
+// The last command posted into a mixed scene's output: stops what is left in it and
+// frees it.
+void ExecuteReleaseOutputCommand(const AudioCommand& command) {
+    if (!command.output) return;
+    {
+        std::lock_guard<std::mutex> lock(g_bassMutex);
+        StopOutputLocked(*command.output, command.fadeMs);
+        std::erase(g_sceneOutputs, command.output);
+    }
+    delete command.output;
+}
+
+void ExecuteAudioCommand(const AudioCommand& command) {
+    Channel* channel = GetChannel(command.channel);
     
-    HSTREAM* targetStream = nullptr;
-    float volume = 1.0f;
-    std::string typeName;
+    if (command.channel == SCRIPT_CHECK &&
+        (command.type == AudioCommandType::Play || command.type == AudioCommandType::Stop)) {
+        DiscardSoundMenuKeyPreload();
+    }
     
-    switch (type) {
-        case SCRIPT_BASE:
-            targetStream = &g_baseStream;
-            volume = g_volumeControlEnabled.load() ? g_baseVolume.load() : 1.0f;
-            typeName = "BASE";
-            break;
-        case SCRIPT_MENU:
-            targetStream = &g_menuStream;
-            volume = g_volumeControlEnabled.load() ? g_menuVolume.load() : 1.0f;
-            typeName = "MENU";
-            break;
-        case SCRIPT_SPECIFIC:
-            targetStream = &g_specificStream;
-            volume = g_volumeControlEnabled.load() ? g_specificVolume.load() : 1.0f;
-            typeName = "SPECIFIC";
+    switch (command.type) {
+        case AudioCommandType::SoundMenuKeyPreload:
+            ExecuteSoundMenuKeyPreload(command);
+            return;
+        case AudioCommandType::SoundMenuKeyAdvance:
+            ExecuteSoundMenuKeyAdvance(command);
+            return;
+        case AudioCommandType::Play:
+            if (!ExecutePlayCommand(command) && channel) {
+                channel->PlayFailed(command.sequence);
+            }
+            return;
+        case AudioCommandType::UpdateVolumes:
+            ExecuteUpdateVolumesCommand();
+            return;
+        case AudioCommandType::RefreshNowPlaying:
+            // Nothing to execute; DrainAudioCommands republishes after the batch.
+            return;
+        case AudioCommandType::PauseGroups:
+        case AudioCommandType::ResumeGroups:
+            ExecuteChannelGroupCommand(command);
+            return;
+        case AudioCommandType::ReleaseOutput:
+            ExecuteReleaseOutputCommand(command);
+            return;
+        default:
             break;
-        case SCRIPT_EFFECT:
-            targetStream = &g_effectStream;
-            volume = g_volumeControlEnabled.load() ? g_effectVolume.load() : 1.0f;
-            typeName = "EFFECT";
+    }
+    
+    if (!channel) return;
+    
+    std::lock_guard<std::mutex> lock(g_bassMutex);
+    switch (command.type) {
+        case AudioCommandType::Stop:
+            channel->Stop(command.fadeMs);
+            Output().tracks[command.channel].clear();
             break;
-        case SCRIPT_POSITION:
-            targetStream = &g_positionStream;
-            volume = g_volumeControlEnabled.load() ? g_positionVolume.load() : 1.0f;
-            typeName = "POSITION";
+        case AudioCommandType::Pause:
+            // An explicit pause also takes the channel out of its paused group's resume.
+            channel->Pause();
+            GetChannelGroup(ChannelGroupOf(command.channel)).channels &= ~(1u << command.channel);
             break;
-        case SCRIPT_TAG:
-            targetStream = &g_tagStream;
-            volume = g_volumeControlEnabled.load() ? g_tagVolume.load() : 1.0f;
-            typeName = "TAG";
+        case AudioCommandType::Resume:
+            if (!HoldChannelForPausedGroup(command.channel)) channel->Resume();
             break;
-        case SCRIPT_CHECK:
-            targetStream = &g_soundMenuKeyStream;
-            volume = g_volumeControlEnabled.load() ? g_soundMenuKeyVolume.load() : 1.0f;
-            typeName = "SOUNDMENUKEY";
+        case AudioCommandType::SetVolume: channel->SetLevel(command.volume); break;
+        case AudioCommandType::UpdateVolume:
+            if (!g_bassInitialized) break;
+            channel->SetLevel(channel->TargetVolume());
+            if (command.channel == SCRIPT_POSITION) {
+                float layerVolume = PositionLayerVolume();
+                for (const auto& [fragment, layers] : Output().positionStreams) {
+                    for (const auto& [layerNum, stream] : layers) {
+                        if (stream) Audio()->SetLevel(stream, layerVolume);
+                    }
+                }
+            }
+            WriteToSoundPlayerLog("BASS: " + std::string(channel->Name()) + " volume updated - " +
+                                 std::to_string(static_cast<int>(channel->TargetVolume() * 100)) + "%", __LINE__);
             break;
-        default:
-            return 0;
+        default: break;
+    }
+}
+
+// ========================================
+// Now-Playing State Block
+// ========================================
+// The audio thread republishes the per-channel state after every batch of commands.
+// Readers in other DLLs copy it under a seqlock: an odd counter means a write is in
+// progress, and a counter that moved during the copy means the copy is torn. Neither
+// side takes a lock. Positions are anchored to the publish tick and extrapolated by
+// the accessor, so nothing has to be republished while a track simply keeps playing.
+
+struct NowPlayingBlock {
+    std::atomic<uint64_t> seqlock{0};
+    OSoundtracksAPI::NowPlaying state{};
+    uint64_t anchorMs = 0;
+};
+
+static NowPlayingBlock g_nowPlaying;
+static std::atomic<uint64_t> g_nowPlayingSequence(0);
+static std::mutex g_nowPlayingWriteMutex;
+static std::atomic<bool> g_nowPlayingPublished(false);
+static std::string g_nowPlayingMenuTrack;
+static std::string g_nowPlayingMenuAuthor;
+
+uint32_t HashTrackName(const std::string& name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+std::string FindSoundMenuKeyAuthor(const std::string& track) {
+    auto tables = GetSoundTables();
+    for (const auto& [author, range] : tables->soundMenuKeyRanges) {
+        for (uint32_t id = range.first; id < range.first + range.second; ++id) {
+            if (tables->soundMenuKeyTracks[id] == track) return author;
+        }
+    }
+    return std::string();
+}
+
+void SignalNowPlayingNotifier();
+
+void PublishNowPlaying() {
+    using namespace OSoundtracksAPI;
+    
+    std::lock_guard<std::mutex> writeLock(g_nowPlayingWriteMutex);
+    
+    NowPlaying next{};
+    next.version = kNowPlayingVersion;
+    
+    {
+        std::lock_guard<std::mutex> lock(g_bassMutex);
+        for (uint32_t i = 0; i < kChannelCount; ++i) {
+            ChannelState& out = next.channels[i];
+            AudioHandle stream = g_liveOutput.channels[i].Handle();
+            if (!stream || !g_bassInitialized) continue;
+            
+            AudioActivity active = g_audio->Activity(stream);
+            if (active == AudioActivity::Stopped) continue;
+            out.status = active == AudioActivity::Paused ? kPaused : kPlaying;
+            
+            double position = g_audio->Position(stream);
+            if (position >= 0.0) {
+                out.position = static_cast<float>(position);
+            }
+            double duration = g_audio->Length(stream);
+            if (duration >= 0.0) {
+                out.duration = static_cast<float>(duration);
+            }
+        }
+    }
+    
+    for (uint32_t i = 0; i < kChannelCount; ++i) {
+        ChannelState& out = next.channels[i];
+        if (out.status == kStopped) continue;
+        
+        const std::string& track = g_liveOutput.tracks[i];
+        out.trackId = HashTrackName(track);
+        std::snprintf(out.track, sizeof(out.track), "%s", track.c_str());
+        
+        if (i == kChannelSoundMenuKey) {
+            if (track != g_nowPlayingMenuTrack) {
+                g_nowPlayingMenuTrack = track;
+                g_nowPlayingMenuAuthor = FindSoundMenuKeyAuthor(track);
+            }
+            std::snprintf(out.author, sizeof(out.author), "%s", g_nowPlayingMenuAuthor.c_str());
+        }
+    }
+    
+    if (g_soundMenuKeyActive.load() && next.channels[kChannelSoundMenuKey].status != kStopped) {
+        next.activeSystem = kSystemSoundMenuKey;
+    } else if (next.channels[kChannelSpecific].status != kStopped || next.channels[kChannelBase].status != kStopped) {
+        next.activeSystem = kSystemSoundKey;
+    }
+    
+    // Position alone does not count as a change; everything else does.
+    const NowPlaying& current = g_nowPlaying.state;
+    bool changed = !g_nowPlayingPublished.load() || next.activeSystem != current.activeSystem;
+    for (uint32_t i = 0; i < kChannelCount && !changed; ++i) {
+        const ChannelState& a = next.channels[i];
+        const ChannelState& b = current.channels[i];
+        changed = a.trackId != b.trackId || a.status != b.status || a.duration != b.duration ||
+                  std::strcmp(a.track, b.track) != 0 || std::strcmp(a.author, b.author) != 0;
+    }
+    next.sequence = current.sequence + (changed ? 1 : 0);
+    
+    uint64_t lock = g_nowPlaying.seqlock.load(std::memory_order_relaxed);
+    g_nowPlaying.seqlock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    g_nowPlaying.state = next;
+    g_nowPlaying.anchorMs = GetTickCount64();
+    g_nowPlaying.seqlock.store(lock + 2, std::memory_order_release);
+    
+    g_nowPlayingSequence.store(next.sequence, std::memory_order_release);
+    g_nowPlayingPublished = true;
+    
+    SignalNowPlayingNotifier();
+}
+
+bool ReadNowPlaying(OSoundtracksAPI::NowPlaying& out) {
+    if (!g_nowPlayingPublished.load(std::memory_order_acquire)) return false;
+    
+    uint64_t anchorMs = 0;
+    for (;;) {
+        uint64_t before = g_nowPlaying.seqlock.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::memcpy(&out, &g_nowPlaying.state, sizeof(out));
+        anchorMs = g_nowPlaying.anchorMs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (g_nowPlaying.seqlock.load(std::memory_order_relaxed) == before) break;
+    }
+    
+    float elapsed = static_cast<float>(GetTickCount64() - anchorMs) / 1000.0f;
+    for (auto& channel : out.channels) {
+        if (channel.status != OSoundtracksAPI::kPlaying) continue;
+        channel.position += elapsed;
+        if (channel.duration > 0.0f && channel.position > channel.duration) {
+            channel.position = std::fmod(channel.position, channel.duration);
+        }
+    }
+    return true;
+}
+
+// ========================================
+// Now-Playing Notifications
+// ========================================
+// Listeners registered by other plugins are called from one notifier thread, so a slow
+// consumer (Prisma invoking its view) never holds up the audio thread. The notifier
+// wakes on every publish and diffs the snapshot against what it last delivered. While
+// something plays it also ticks every kNowPlayingProgressInterval: the tick posts a
+// refresh so the audio thread republishes from BASS (which also catches tracks that
+// ended on their own) and the resulting publish is delivered with kEventProgress.
+
+struct NowPlayingSubscriber {
+    OSoundtracksAPI::NowPlayingListener listener;
+    void* context;
+    bool primed;
+};
+
+static constexpr auto kNowPlayingProgressInterval = std::chrono::seconds(2);
+static std::mutex g_nowPlayingListenersMutex;
+static std::vector<NowPlayingSubscriber> g_nowPlayingListeners;
+static std::mutex g_nowPlayingSignalMutex;
+static std::condition_variable g_nowPlayingSignal;
+static uint64_t g_nowPlayingSignals = 0;
+static std::thread g_nowPlayingNotifierThread;
+static std::atomic<bool> g_nowPlayingNotifierActive(false);
+
+bool AnyChannelPlaying(const OSoundtracksAPI::NowPlaying& state) {
+    for (const auto& channel : state.channels) {
+        if (channel.status == OSoundtracksAPI::kPlaying) return true;
+    }
+    return false;
+}
+
+uint32_t DiffNowPlaying(const OSoundtracksAPI::NowPlaying& previous, const OSoundtracksAPI::NowPlaying& current) {
+    using namespace OSoundtracksAPI;
+    
+    uint32_t events = previous.activeSystem != current.activeSystem ? kEventSystem : 0;
+    for (uint32_t i = 0; i < kChannelCount; ++i) {
+        const ChannelState& a = previous.channels[i];
+        const ChannelState& b = current.channels[i];
+        if (a.trackId != b.trackId || a.duration != b.duration || std::strcmp(a.track, b.track) != 0 ||
+            std::strcmp(a.author, b.author) != 0) {
+            events |= kEventTrack;
+        }
+        if (a.status != b.status) events |= kEventStatus;
+    }
+    return events;
+}
+
+void DeliverNowPlaying(const OSoundtracksAPI::NowPlaying& state, uint32_t events) {
+    constexpr uint32_t kAllEvents = OSoundtracksAPI::kEventTrack | OSoundtracksAPI::kEventStatus |
+                                    OSoundtracksAPI::kEventSystem | OSoundtracksAPI::kEventProgress;
+    
+    std::lock_guard<std::mutex> lock(g_nowPlayingListenersMutex);
+    for (auto& subscriber : g_nowPlayingListeners) {
+        uint32_t mask = subscriber.primed ? events : kAllEvents;
+        if (!mask) continue;
+        subscriber.primed = true;
+        try {
+            subscriber.listener(&state, mask, subscriber.context);
+        } catch (...) {
+            logger::error("Now-playing listener threw an exception");
+        }
+    }
+}
+
+void NowPlayingNotifierThreadFunction() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+    logger::info("Now-playing notifier started");
+    
+    OSoundtracksAPI::NowPlaying delivered{};
+    uint64_t seenSignals = 0;
+    bool progressDue = false;
+    auto lastTick = std::chrono::steady_clock::now();
+    
+    while (g_nowPlayingNotifierActive.load()) {
+        bool signalled = false;
+        {
+            std::unique_lock<std::mutex> lock(g_nowPlayingSignalMutex);
+            auto woken = [&] { return !g_nowPlayingNotifierActive.load() || g_nowPlayingSignals != seenSignals; };
+            if (AnyChannelPlaying(delivered)) {
+                g_nowPlayingSignal.wait_until(lock, lastTick + kNowPlayingProgressInterval, woken);
+            } else {
+                g_nowPlayingSignal.wait(lock, woken);
+            }
+            signalled = g_nowPlayingSignals != seenSignals;
+            seenSignals = g_nowPlayingSignals;
+        }
+        if (!g_nowPlayingNotifierActive.load()) break;
+        
+        if (!signalled) {
+            progressDue = true;
+            lastTick = std::chrono::steady_clock::now();
+            PostAudioCommand(MakeAudioCommand(AudioCommandType::RefreshNowPlaying, SCRIPT_BASE));
+            continue;
+        }
+        
+        OSoundtracksAPI::NowPlaying current{};
+        if (!ReadNowPlaying(current)) {
+            current.version = OSoundtracksAPI::kNowPlayingVersion;
+        }
+        
+        uint32_t events = DiffNowPlaying(delivered, current);
+        if (progressDue && AnyChannelPlaying(current)) {
+            events |= OSoundtracksAPI::kEventProgress;
+            progressDue = false;
+        }
+        if (events & OSoundtracksAPI::kEventTrack) {
+            lastTick = std::chrono::steady_clock::now();
+        }
+        
+        DeliverNowPlaying(current, events);
+        delivered = current;
+    }
+    
+    logger::info("Now-playing notifier stopped");
+}
+
+void SignalNowPlayingNotifier() {
+    {
+        std::lock_guard<std::mutex> lock(g_nowPlayingSignalMutex);
+        ++g_nowPlayingSignals;
     }
+    g_nowPlayingSignal.notify_one();
+}
+
+void StartNowPlayingNotifier() {
+    if (g_nowPlayingNotifierActive.exchange(true)) return;
+    g_nowPlayingNotifierThread = std::thread(NowPlayingNotifierThreadFunction);
+}
+
+void StopNowPlayingNotifier() {
+    if (!g_nowPlayingNotifierActive.exchange(false)) return;
     
-    if (*targetStream) {
-        pBASS_ChannelStop(*targetStream);
-        pBASS_StreamFree(*targetStream);
-        *targetStream = 0;
+    SignalNowPlayingNotifier();
+    if (g_nowPlayingNotifierThread.joinable()) {
+        g_nowPlayingNotifierThread.join();
     }
+}
+
+// ========================================
+// Exported Now-Playing API (see OSoundtracks_API.h)
+// ========================================
+
+extern "C" __declspec(dllexport) bool OSoundtracks_GetNowPlaying(OSoundtracksAPI::NowPlaying* out) {
+    return out && ReadNowPlaying(*out);
+}
+
+extern "C" __declspec(dllexport) uint64_t OSoundtracks_GetNowPlayingSequence() {
+    return g_nowPlayingSequence.load(std::memory_order_acquire);
+}
+
+extern "C" __declspec(dllexport) bool OSoundtracks_RegisterNowPlayingListener(OSoundtracksAPI::NowPlayingListener listener,
+                                                                               void* context) {
+    if (!listener || g_isShuttingDown) return false;
     
-    DWORD flags = BASS_UNICODE;
-    if (loop) flags |= BASS_SAMPLE_LOOP;
-    
-    *targetStream = pBASS_StreamCreateFile(
-        FALSE,
-        soundPath.wstring().c_str(),
-        0, 0,
-        flags
-    );
-    
-    if (!*targetStream) {
-        int error = pBASS_ErrorGetCode ? pBASS_ErrorGetCode() : -1;
-        logger::error("BASS: Failed to create stream for {}: error {}", soundPath.string(), error);
-        WriteToSoundPlayerLog("BASS ERROR: Failed to create stream, error " + std::to_string(error), __LINE__);
-        return 0;
+    {
+        std::lock_guard<std::mutex> lock(g_nowPlayingListenersMutex);
+        for (const auto& subscriber : g_nowPlayingListeners) {
+            if (subscriber.listener == listener && subscriber.context == context) return true;
+        }
+        g_nowPlayingListeners.push_back({listener, context, false});
     }
     
-    if (pBASS_ChannelSetAttribute) {
-        pBASS_ChannelSetAttribute(*targetStream, BASS_ATTRIB_VOL, volume);
+    StartNowPlayingNotifier();
+    SignalNowPlayingNotifier();
+    return true;
+}
+
+extern "C" __declspec(dllexport) void OSoundtracks_UnregisterNowPlayingListener(OSoundtracksAPI::NowPlayingListener listener,
+                                                                                 void* context) {
+    std::lock_guard<std::mutex> lock(g_nowPlayingListenersMutex);
+    std::erase_if(g_nowPlayingListeners, [&](const NowPlayingSubscriber& subscriber) {
+        return subscriber.listener == listener && subscriber.context == context;
+    });
+}
+
+extern "C" __declspec(dllexport) bool OSoundtracks_GetLatencyStats(OSoundtracksAPI::LatencyStats* out) {
+    if (!out) return false;
+    ReadLatencyStats(*out);
+    return true;
+}
+
+extern "C" __declspec(dllexport) bool OSoundtracks_GetVoiceStats(OSoundtracksAPI::VoiceStats* out) {
+    if (!out) return false;
+    ReadVoiceStats(*out);
+    return true;
+}
+
+// Single-value getters for consumers written against the older per-field exports.
+// Strings point at thread-local copies that stay valid until the next call.
+const OSoundtracksAPI::NowPlaying& NowPlayingForExport() {
+    thread_local OSoundtracksAPI::NowPlaying snapshot{};
+    if (!ReadNowPlaying(snapshot)) snapshot = OSoundtracksAPI::NowPlaying{};
+    return snapshot;
+}
+
+extern "C" __declspec(dllexport) const char* OSoundtracks_GetCurrentMenuTrack() {
+    return NowPlayingForExport().channels[OSoundtracksAPI::kChannelSoundMenuKey].track;
+}
+
+extern "C" __declspec(dllexport) const char* OSoundtracks_GetCurrentMenuAuthor() {
+    return NowPlayingForExport().channels[OSoundtracksAPI::kChannelSoundMenuKey].author;
+}
+
+extern "C" __declspec(dllexport) int OSoundtracks_GetMenuStatus() {
+    return NowPlayingForExport().channels[OSoundtracksAPI::kChannelSoundMenuKey].status;
+}
+
+extern "C" __declspec(dllexport) float OSoundtracks_GetMenuProgress() {
+    const auto& channel = NowPlayingForExport().channels[OSoundtracksAPI::kChannelSoundMenuKey];
+    return channel.duration > 0.0f ? channel.position / channel.duration : 0.0f;
+}
+
+extern "C" __declspec(dllexport) const char* OSoundtracks_GetCurrentBaseTrack() {
+    return NowPlayingForExport().channels[OSoundtracksAPI::kChannelBase].track;
+}
+
+extern "C" __declspec(dllexport) const char* OSoundtracks_GetSpecificTrack() {
+    return NowPlayingForExport().channels[OSoundtracksAPI::kChannelSpecific].track;
+}
+
+extern "C" __declspec(dllexport) int OSoundtracks_GetSpecificStatus() {
+    return NowPlayingForExport().channels[OSoundtracksAPI::kChannelSpecific].status;
+}
+
+extern "C" __declspec(dllexport) const char* OSoundtracks_GetActiveSystem() {
+    switch (NowPlayingForExport().activeSystem) {
+        case OSoundtracksAPI::kSystemSoundMenuKey: return "SoundMenuKey";
+        case OSoundtracksAPI::kSystemSoundKey: return "SoundKey";
+        default: return "none";
     }
-    
-    if (!pBASS_ChannelPlay(*targetStream, FALSE)) {
-        int error = pBASS_ErrorGetCode ? pBASS_ErrorGetCode() : -1;
-        logger::error("BASS: Failed to play stream: error {}", error);
-        return 0;
+}
+
+void DrainAudioCommands() {
+    bool executed = false;
+    while (AudioCommand* command = g_audioCommands.Pop()) {
+        uint32_t traceId = command->traceId;
+        uint64_t cycles = traceId ? ReadThreadCycles() : 0;
+        uint64_t allocations = HeapAllocations();
+        t_replayTraceId = traceId;
+        t_audioOutput = command->output;
+        try {
+            ExecuteAudioCommand(*command);
+        } catch (...) {
+            logger::error("Error executing audio command");
+        }
+        t_audioOutput = nullptr;
+        t_replayTraceId = 0;
+        if (traceId) {
+            NoteReplayAudioWork(traceId, ReadThreadCycles() - cycles, HeapAllocations() - allocations);
+        }
+        delete command;
+        g_audioCommandsExecuted.fetch_add(1, std::memory_order_release);
+        executed = true;
+    }
+    
+    // The end sync's hand-off runs after the commands posted before it, as it did when
+    // the advance was queued behind them.
+    if (uint64_t streams = g_soundMenuKeyEndedStreams.exchange(0, std::memory_order_acquire)) {
+        AudioCommand advance;
+        advance.type = AudioCommandType::SoundMenuKeyAdvance;
+        advance.channel = SCRIPT_CHECK;
+        advance.ended = static_cast<AudioHandle>(streams >> 32);
+        advance.stream = static_cast<AudioHandle>(streams);
+        try {
+            ExecuteAudioCommand(advance);
+        } catch (...) {
+            logger::error("Error executing audio command");
+        }
+        executed = true;
     }
     
-    std::string displayName = soundFile;
-    if (displayName.size() >= 4 && displayName.substr(displayName.size() - 4) == ".wav") {
-        displayName = displayName.substr(0, displayName.size() - 4);
+    if (executed) {
+        try {
+            PublishNowPlaying();
+        } catch (...) {
+            logger::error("Error publishing now-playing state");
+        }
     }
+}
+
+void AudioWorkerThreadFunction() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+    logger::info("Audio command thread started");
     
-    WriteToSoundPlayerLog("BASS: Playing " + displayName + " [" + typeName + "] (loop=" + (loop ? "true" : "false") + ", vol=" + std::to_string(static_cast<int>(volume * 100)) + "%)", __LINE__);
-    
-    if (soundFile != "Debug.wav") {
-        std::string notificationMsg = "OSoundtracks - \"" + displayName + "\" is played";
-        ShowGameNotification(notificationMsg);
+    while (g_audioWorkerActive.load()) {
+        uint32_t observed = g_audioCommandSignal.load(std::memory_order_acquire);
+        DrainAudioCommands();
+        if (!g_audioWorkerActive.load()) break;
+        g_audioCommandSignal.wait(observed, std::memory_order_acquire);
     }
     
-    return *targetStream;
+    DrainAudioCommands();
+    logger::info("Audio command thread stopped");
 }
 
-void StopBASSStream(ScriptType type) {
-    std::lock_guard<std::mutex> lock(g_bassMutex);
+void StartAudioWorker() {
+    if (g_audioWorkerActive.load()) return;
     
-    HSTREAM* targetStream = nullptr;
+    g_audioWorkerActive = true;
+    g_audioWorkerThread = std::thread(AudioWorkerThreadFunction);
+}
+
+void StopAudioWorker() {
+    if (!g_audioWorkerActive.load()) return;
     
-    switch (type) {
-        case SCRIPT_BASE: targetStream = &g_baseStream; break;
-        case SCRIPT_MENU: targetStream = &g_menuStream; break;
-        case SCRIPT_SPECIFIC: targetStream = &g_specificStream; break;
-        case SCRIPT_EFFECT: targetStream = &g_effectStream; break;
-        case SCRIPT_POSITION: targetStream = &g_positionStream; break;
-        case SCRIPT_TAG: targetStream = &g_tagStream; break;
-        case SCRIPT_CHECK: targetStream = &g_soundMenuKeyStream; break;
-        default: return;
+    g_audioWorkerActive = false;
+    g_audioCommandSignal.fetch_add(1, std::memory_order_release);
+    g_audioCommandSignal.notify_one();
+    
+    if (g_audioWorkerThread.joinable()) {
+        g_audioWorkerThread.join();
     }
     
-    if (*targetStream) {
-        if (pBASS_ChannelStop) pBASS_ChannelStop(*targetStream);
-        if (pBASS_StreamFree) pBASS_StreamFree(*targetStream);
-        *targetStream = 0;
+    // A producer that saw the worker running may not have pushed yet; its command
+    // belongs to this last drain.
+    while (g_audioPostsInFlight.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
     }
+    DrainAudioCommands();
 }
 
-void StopAllBASSStreams() {
-    StopBASSStream(SCRIPT_BASE);
-    StopBASSStream(SCRIPT_MENU);
-    StopBASSStream(SCRIPT_SPECIFIC);
-    StopBASSStream(SCRIPT_EFFECT);
-    StopBASSStream(SCRIPT_POSITION);
-    StopBASSStream(SCRIPT_TAG);
-    StopBASSStream(SCRIPT_CHECK);
-    
-    for (auto& [fragment, layers] : g_positionStreams) {
-        for (auto& [layerNum, stream] : layers) {
-            if (stream) {
-                if (pBASS_ChannelStop) pBASS_ChannelStop(stream);
-                if (pBASS_StreamFree) pBASS_StreamFree(stream);
-                stream = 0;
-            }
-        }
+// Before the worker starts (or after it stops) commands run on the caller's thread,
+// which is what every call did before the worker existed. The in-flight count is raised
+// before the flag is read, so StopAudioWorker waits for every push it could miss.
+void PostAudioCommand(AudioCommand* command) {
+    g_audioPostsInFlight.fetch_add(1);
+    if (!g_audioWorkerActive.load()) {
+        g_audioPostsInFlight.fetch_sub(1, std::memory_order_release);
+        ExecuteAudioCommand(*command);
+        delete command;
+        g_audioCommandsExecuted.fetch_add(1, std::memory_order_release);
+        PublishNowPlaying();
+        return;
     }
-    g_positionStreams.clear();
-    g_activePositionFragments.clear();
     
-    g_soundMenuKeyActive = false;
-    g_currentSoundMenuKeyTrack = "";
-    WriteToSoundPlayerLog("BASS: All streams stopped (including SoundMenuKey and multi-layer Position)", __LINE__);
+    g_audioCommands.Push(command);
+    g_audioCommandSignal.fetch_add(1, std::memory_order_release);
+    g_audioCommandSignal.notify_one();
+    g_audioPostsInFlight.fetch_sub(1, std::memory_order_release);
 }
 
-void PauseBASSStream(ScriptType type) {
-    std::lock_guard<std::mutex> lock(g_bassMutex);
+AudioCommand* MakeAudioCommand(AudioCommandType type, ScriptType channel) {
+    auto* command = new AudioCommand();
+    command->type = type;
+    command->channel = channel;
+    command->sequence = ++g_audioCommandSequence;
+    command->traceId = t_replayTraceId;
+    command->output = t_audioOutput;
+    if (command->traceId && type == AudioCommandType::Play) {
+        NoteReplayCommand(command->traceId);
+    }
+    if (type == AudioCommandType::Play && t_transitionStamps.readMicros) {
+        command->readMicros = t_transitionStamps.readMicros;
+        command->classifiedMicros = t_transitionStamps.classifiedMicros;
+        command->resolvedMicros = MonotonicMicros();
+    }
+    return command;
+}
+
+void PlayBASSSound(const std::string& soundFile, ScriptType type, bool loop = true) {
+    Channel* channel = GetChannel(type);
+    if (!channel) return;
     
-    HSTREAM stream = 0;
-    switch (type) {
-        case SCRIPT_BASE: stream = g_baseStream; break;
-        case SCRIPT_MENU: stream = g_menuStream; break;
-        case SCRIPT_SPECIFIC: stream = g_specificStream; break;
-        case SCRIPT_EFFECT: stream = g_effectStream; break;
-        case SCRIPT_POSITION: stream = g_positionStream; break;
-        case SCRIPT_TAG: stream = g_tagStream; break;
-        case SCRIPT_CHECK: stream = g_soundMenuKeyStream; break;
-        default: return;
-    }
+    AudioCommand* command = MakeAudioCommand(AudioCommandType::Play, type);
+    command->soundFile = soundFile;
+    command->loop = loop;
+    command->fadeMs = g_crossfadeMs.load();
+    channel->MarkRequested(true, command->sequence);
+    PostAudioCommand(command);
+}
+
+void StopBASSStream(ScriptType type) {
+    Channel* channel = GetChannel(type);
+    if (!channel) return;
     
-    if (stream && pBASS_ChannelPause) {
-        pBASS_ChannelPause(stream);
-    }
+    AudioCommand* command = MakeAudioCommand(AudioCommandType::Stop, type);
+    command->fadeMs = g_crossfadeMs.load();
+    channel->MarkRequested(false, command->sequence);
+    PostAudioCommand(command);
+}
+
+void PauseBASSStream(ScriptType type) {
+    PostAudioCommand(MakeAudioCommand(AudioCommandType::Pause, type));
 }
 
 void ResumeBASSStream(ScriptType type) {
-    std::lock_guard<std::mutex> lock(g_bassMutex);
-    
-    HSTREAM stream = 0;
-    switch (type) {
-        case SCRIPT_BASE: stream = g_baseStream; break;
-        case SCRIPT_MENU: stream = g_menuStream; break;
-        case SCRIPT_SPECIFIC: stream = g_specificStream; break;
-        case SCRIPT_EFFECT: stream = g_effectStream; break;
-        case SCRIPT_POSITION: stream = g_positionStream; break;
-        case SCRIPT_TAG: stream = g_tagStream; break;
-        case SCRIPT_CHECK: stream = g_soundMenuKeyStream; break;
-        default: return;
-    }
-    
-    if (stream && pBASS_ChannelPlay) {
-        pBASS_ChannelPlay(stream, FALSE);
-    }
+    PostAudioCommand(MakeAudioCommand(AudioCommandType::Resume, type));
+}
+
+void PauseChannelGroups(uint32_t groups, uint32_t fadeMs) {
+    AudioCommand* command = MakeAudioCommand(AudioCommandType::PauseGroups, SCRIPT_BASE);
+    command->groups = groups;
+    command->fadeMs = fadeMs;
+    PostAudioCommand(command);
+}
+
+void ResumeChannelGroups(uint32_t groups, uint32_t fadeMs) {
+    AudioCommand* command = MakeAudioCommand(AudioCommandType::ResumeGroups, SCRIPT_BASE);
+    command->groups = groups;
+    command->fadeMs = fadeMs;
+    PostAudioCommand(command);
 }
 
 void SetBASSVolume(ScriptType type, float volume) {
-    std::lock_guard<std::mutex> lock(g_bassMutex);
-    
-    HSTREAM stream = 0;
-    switch (type) {
-        case SCRIPT_BASE: stream = g_baseStream; break;
-        case SCRIPT_MENU: stream = g_menuStream; break;
-        case SCRIPT_SPECIFIC: stream = g_specificStream; break;
-        case SCRIPT_EFFECT: stream = g_effectStream; break;
-        case SCRIPT_POSITION: stream = g_positionStream; break;
-        case SCRIPT_TAG: stream = g_tagStream; break;
-        case SCRIPT_CHECK: stream = g_soundMenuKeyStream; break;
-        default: return;
-    }
-    
-    if (stream && pBASS_ChannelSetAttribute) {
-        pBASS_ChannelSetAttribute(stream, BASS_ATTRIB_VOL, volume);
-    }
+    AudioCommand* command = MakeAudioCommand(AudioCommandType::SetVolume, type);
+    command->volume = volume;
+    PostAudioCommand(command);
+}
+
+// Re-reads one channel's volume setting; position layers follow SCRIPT_POSITION.
+void UpdateBASSVolume(ScriptType type) {
+    PostAudioCommand(MakeAudioCommand(AudioCommandType::UpdateVolume, type));
 }
 
 void UpdateAllBASSVolumes() {
-    if (!g_bassInitialized) return;
-    
-    float baseVol = g_volumeControlEnabled.load() ? g_baseVolume.load() : 1.0f;
-    float menuVol = g_volumeControlEnabled.load() ? g_menuVolume.load() : 1.0f;
-    float specificVol = g_volumeControlEnabled.load() ? g_specificVolume.load() : 1.0f;
-    float effectVol = g_volumeControlEnabled.load() ? g_effectVolume.load() : 1.0f;
-    float positionVol = g_volumeControlEnabled.load() ? g_positionVolume.load() : 1.0f;
-    float tagVol = g_volumeControlEnabled.load() ? g_tagVolume.load() : 1.0f;
-    float soundMenuKeyVol = g_volumeControlEnabled.load() ? g_soundMenuKeyVolume.load() : 1.0f;
+    PostAudioCommand(MakeAudioCommand(AudioCommandType::UpdateVolumes, SCRIPT_BASE));
+}
+
+// Hands a mixed scene's output to the audio thread, which stops and frees it after the
+// commands already posted into it.
+void ReleaseAudioOutput(AudioOutput* output) {
+    AudioCommand* command = MakeAudioCommand(AudioCommandType::ReleaseOutput, SCRIPT_BASE);
+    command->output = output;
+    command->fadeMs = g_crossfadeMs.load();
+    PostAudioCommand(command);
+}
+
+void StopAllBASSStreams() {
+    StopBASSStream(SCRIPT_BASE);
+    StopBASSStream(SCRIPT_MENU);
+    StopBASSStream(SCRIPT_SPECIFIC);
+    StopBASSStream(SCRIPT_EFFECT);
+    StopBASSStream(SCRIPT_POSITION);
+    StopBASSStream(SCRIPT_TAG);
+    StopBASSStream(SCRIPT_CHECK);
     
     {
         std::lock_guard<std::mutex> lock(g_bassMutex);
-        if (g_baseStream && pBASS_ChannelSetAttribute) {
-            pBASS_ChannelSetAttribute(g_baseStream, BASS_ATTRIB_VOL, baseVol);
-        }
-        if (g_menuStream && pBASS_ChannelSetAttribute) {
-            pBASS_ChannelSetAttribute(g_menuStream, BASS_ATTRIB_VOL, menuVol);
-        }
-        if (g_specificStream && pBASS_ChannelSetAttribute) {
-            pBASS_ChannelSetAttribute(g_specificStream, BASS_ATTRIB_VOL, specificVol);
-        }
-        if (g_effectStream && pBASS_ChannelSetAttribute) {
-            pBASS_ChannelSetAttribute(g_effectStream, BASS_ATTRIB_VOL, effectVol);
-        }
-        if (g_positionStream && pBASS_ChannelSetAttribute) {
-            pBASS_ChannelSetAttribute(g_positionStream, BASS_ATTRIB_VOL, positionVol);
-        }
-        if (g_tagStream && pBASS_ChannelSetAttribute) {
-            pBASS_ChannelSetAttribute(g_tagStream, BASS_ATTRIB_VOL, tagVol);
-        }
-        if (g_soundMenuKeyStream && pBASS_ChannelSetAttribute) {
-            pBASS_ChannelSetAttribute(g_soundMenuKeyStream, BASS_ATTRIB_VOL, soundMenuKeyVol);
+        auto& positionStreams = Output().positionStreams;
+        for (auto& [fragment, layers] : positionStreams) {
+            for (auto& [layerNum, stream] : layers) {
+                if (stream) {
+                    Audio()->Stop(stream);
+                    Audio()->Free(stream);
+                    stream = 0;
+                }
+            }
         }
+        positionStreams.clear();
     }
+    Output().positionStreamsEpoch++;
     
-    WriteToSoundPlayerLog("BASS: Volumes updated - Base: " + std::to_string(static_cast<int>(baseVol * 100)) + 
-                         "%, Menu: " + std::to_string(static_cast<int>(menuVol * 100)) + 
-                         "%, Specific: " + std::to_string(static_cast<int>(specificVol * 100)) +
-                         "%, Effect: " + std::to_string(static_cast<int>(effectVol * 100)) +
-                         "%, Position: " + std::to_string(static_cast<int>(positionVol * 100)) +
-                         "%, Tag: " + std::to_string(static_cast<int>(tagVol * 100)) + 
-                         "%, SoundMenuKey: " + std::to_string(static_cast<int>(soundMenuKeyVol * 100)) + "%", __LINE__);
+    // The SoundMenuKey only ever plays on the live output.
+    if (!t_audioOutput) {
+        g_soundMenuKeyActive = false;
+        g_currentSoundMenuKeyTrack = "";
+    }
+    WriteToSoundPlayerLog("BASS: All streams stopped (including SoundMenuKey and multi-layer Position)", __LINE__);
 }
 
 // ========================================
@@ -1075,131 +4452,448 @@ fs::path GetHeartbeatLogPath() {
     return paths.primary / "OSoundtracks-SA-Expansion-Sounds-NG-Animations-Game.log";
 }
 
-void WriteToSoundPlayerLog(const std::string& message, int lineNumber, bool isAnimationEntry) {
-    std::lock_guard<std::mutex> lock(g_logMutex);
+// ========================================
+// Asynchronous Sound Player Log
+// ========================================
+// WriteToSoundPlayerLog formats a line and copies it into a bounded ring of fixed-size
+// records; one writer thread owns both log files, keeps them open and appends in
+// batches. Producers never take a lock or touch the disk, so logging while holding
+// g_bassMutex or from the audio thread costs a format and a memcpy. Lines longer than
+// one record span consecutive slots claimed in a single CAS, so they never interleave.
+// When the ring is full the line is dropped and counted rather than waiting.
+
+static constexpr size_t kLogRecordText = 240;
+static constexpr size_t kLogRingCapacity = 4096;
+static constexpr auto kLogFlushInterval = std::chrono::milliseconds(100);
+
+struct LogRecord {
+    std::atomic<uint64_t> sequence{0};
+    uint16_t length = 0;
+    bool continued = false;
+    char text[kLogRecordText];
+};
+
+class LogRing {
+public:
+    LogRing() : records(std::make_unique<LogRecord[]>(kLogRingCapacity)) {
+        for (size_t i = 0; i < kLogRingCapacity; ++i) {
+            records[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any thread; never blocks. Returns false if the line was dropped.
+    bool Push(std::string_view line) {
+        size_t needed = std::max<size_t>(1, (line.size() + kLogRecordText - 1) / kLogRecordText);
+        if (needed > kLogRingCapacity / 4) {
+            needed = kLogRingCapacity / 4;
+            line = line.substr(0, needed * kLogRecordText);
+        }
+
+        uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            // The consumer frees slots in order, so if the last slot is free for this lap
+            // every slot before it is too.
+            uint64_t last = position + needed - 1;
+            uint64_t sequence = records[last % kLogRingCapacity].sequence.load(std::memory_order_acquire);
+            int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(last);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + needed, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        for (size_t i = 0; i < needed; ++i) {
+            LogRecord& record = records[(position + i) % kLogRingCapacity];
+            std::string_view chunk = line.substr(std::min(line.size(), i * kLogRecordText), kLogRecordText);
+            std::memcpy(record.text, chunk.data(), chunk.size());
+            record.length = static_cast<uint16_t>(chunk.size());
+            record.continued = i + 1 < needed;
+            record.sequence.store(position + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Writer thread only. Appends every published record to out, '\n' after each line.
+    size_t Drain(std::string& out) {
+        uint64_t position = dequeuePosition.load(std::memory_order_relaxed);
+        size_t drained = 0;
+        for (;;) {
+            LogRecord& record = records[position % kLogRingCapacity];
+            if (record.sequence.load(std::memory_order_acquire) != position + 1) break;
+
+            out.append(record.text, record.length);
+            if (!record.continued) out += '\n';
+            record.sequence.store(position + kLogRingCapacity, std::memory_order_release);
+            position++;
+            drained++;
+        }
+        dequeuePosition.store(position, std::memory_order_relaxed);
+        return drained;
+    }
+
+    size_t Pending() const {
+        return static_cast<size_t>(enqueuePosition.load(std::memory_order_relaxed) -
+                                   dequeuePosition.load(std::memory_order_relaxed));
+    }
 
+private:
+    std::unique_ptr<LogRecord[]> records;
+    alignas(64) std::atomic<uint64_t> enqueuePosition{0};
+    alignas(64) std::atomic<uint64_t> dequeuePosition{0};
+};
+
+static LogRing g_logRing;
+static std::ofstream g_soundPlayerLogSecondary;
+static std::mutex g_logFileMutex;
+static std::mutex g_logWakeMutex;
+static std::condition_variable g_logWake;
+static std::thread g_logWriterThread;
+static std::atomic<bool> g_logWriterActive(false);
+static std::atomic<uint64_t> g_logDroppedLines(0);
+
+// Reopens both Sound Player logs; truncate starts a fresh session file.
+void OpenSoundPlayerLogFiles(bool truncate) {
+    std::lock_guard<std::mutex> lock(g_logFileMutex);
     auto paths = GetAllSKSELogsPaths();
+    auto mode = std::ios::out | (truncate ? std::ios::trunc : std::ios::app);
     
-    std::vector<fs::path> logPaths = {
-        paths.primary / "OSoundtracks-SA-Expansion-Sounds-NG-Sound-Player.log",
-        paths.secondary / "OSoundtracks-SA-Expansion-Sounds-NG-Sound-Player.log"
-    };
+    try {
+        if (g_soundPlayerLog.is_open()) g_soundPlayerLog.close();
+        if (g_soundPlayerLogSecondary.is_open()) g_soundPlayerLogSecondary.close();
+        g_soundPlayerLog.open(paths.primary / "OSoundtracks-SA-Expansion-Sounds-NG-Sound-Player.log", mode);
+        g_soundPlayerLogSecondary.open(paths.secondary / "OSoundtracks-SA-Expansion-Sounds-NG-Sound-Player.log", mode);
+    } catch (...) {
+    }
+}
 
-    for (const auto& logPath : logPaths) {
-        try {
-            std::ofstream logFile(logPath, std::ios::app);
-            if (logFile.is_open()) {
-                std::stringstream ss;
-                ss << "[" << GetCurrentTimeStringWithMillis() << "] ";
-                ss << "[log] [info] ";
-
-                if (lineNumber > 0) {
-                    ss << "[plugin.cpp:" << lineNumber << "] ";
-                } else {
-                    ss << "[plugin.cpp:0] ";
-                }
+void FlushSoundPlayerLog(std::string& batch) {
+    batch.clear();
+    g_logRing.Drain(batch);
+    
+    uint64_t dropped = g_logDroppedLines.exchange(0);
+    if (dropped > 0) {
+        batch += "[" + GetCurrentTimeStringWithMillis() + "] [log] [warn] [plugin.cpp:" + std::to_string(__LINE__) +
+                 "] Log ring full, " + std::to_string(dropped) + " lines dropped\n";
+    }
+    if (batch.empty()) return;
+    
+    std::lock_guard<std::mutex> lock(g_logFileMutex);
+    try {
+        for (std::ofstream* file : {&g_soundPlayerLog, &g_soundPlayerLogSecondary}) {
+            if (file->is_open()) {
+                file->write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                file->flush();
+            }
+        }
+    } catch (...) {
+    }
+}
+
+void LogWriterThreadFunction() {
+    std::string batch;
+    batch.reserve(64 * 1024);
+    
+    while (g_logWriterActive.load()) {
+        {
+            std::unique_lock<std::mutex> lock(g_logWakeMutex);
+            g_logWake.wait_for(lock, kLogFlushInterval);
+        }
+        FlushSoundPlayerLog(batch);
+    }
+    
+    FlushSoundPlayerLog(batch);
+}
+
+// Called from InitializePlugin in place of the old truncate-on-start. On a second call
+// (new game) the files are truncated under the writer's file lock.
+void StartSoundPlayerLogger() {
+    OpenSoundPlayerLogFiles(true);
+    
+    if (g_logWriterActive.load()) return;
+    g_logWriterActive = true;
+    g_logWriterThread = std::thread(LogWriterThreadFunction);
+}
+
+void StopSoundPlayerLogger() {
+    if (g_logWriterActive.exchange(false)) {
+        g_logWake.notify_one();
+        if (g_logWriterThread.joinable()) {
+            g_logWriterThread.join();
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(g_logFileMutex);
+    g_soundPlayerLog.close();
+    g_soundPlayerLogSecondary.close();
+}
+
+void WriteToSoundPlayerLog(const std::string& message, int lineNumber, bool isAnimationEntry) {
+    (void)isAnimationEntry;
+    
+    // localtime_s is only worth calling once per second per thread.
+    thread_local std::time_t cachedSecond = 0;
+    thread_local char cachedStamp[32] = {};
+    thread_local std::string line;
+    
+    auto now = std::chrono::system_clock::now();
+    std::time_t second = std::chrono::system_clock::to_time_t(now);
+    if (second != cachedSecond) {
+        std::tm buf;
+        localtime_s(&buf, &second);
+        std::strftime(cachedStamp, sizeof(cachedStamp), "%Y-%m-%d %H:%M:%S", &buf);
+        cachedSecond = second;
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    
+    char prefix[96];
+    int prefixLength = std::snprintf(prefix, sizeof(prefix), "[%s.%03d] [log] [info] [plugin.cpp:%d] ", cachedStamp,
+                                     static_cast<int>(ms), lineNumber > 0 ? lineNumber : 0);
+    
+    line.assign(prefix, prefixLength > 0 ? static_cast<size_t>(prefixLength) : 0);
+    line += message;
+    
+    if (!g_logRing.Push(line)) {
+        g_logDroppedLines++;
+    }
+    if (g_logRing.Pending() > kLogRingCapacity / 2) {
+        g_logWake.notify_one();
+    }
+}
+
+// ========================================
+// Memory-Mapped Tail Logs (Actions, heartbeat)
+// ========================================
+// Fixed-capacity circular log files. Layout: a 64-byte header followed by capacity
+// slots of kTailLogSlotSize bytes, each a uint16 length and the line text. head counts
+// every record ever appended, so the newest record lives in slot (head - 1) % capacity
+// and a reader renders the last min(head, capacity) records starting at head -
+// capacity. Appending is one slot write plus a release store of head; the file is
+// never rewritten. Prisma's log panel reads the same format (ReadTailLog there).
+
+static constexpr uint32_t kTailLogMagic = 0x4C52534F;  // "OSRL"
+static constexpr uint32_t kTailLogVersion = 1;
+static constexpr uint32_t kTailLogSlotSize = 256;
+static constexpr uint32_t kActionsLogCapacity = 200;
+static constexpr uint32_t kHeartbeatLogCapacity = 20;
+
+struct TailLogHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotSize;
+    uint32_t capacity;
+    uint64_t head;
+    uint8_t reserved[40];
+};
+static_assert(sizeof(TailLogHeader) == 64, "TailLogHeader must stay 64 bytes");
+
+class MappedTailLog {
+public:
+    ~MappedTailLog() { Close(); }
+
+    // Creates or resets the file; the previous session's records are discarded.
+    bool Open(const fs::path& path, uint32_t slots) {
+        Close();
+        
+        uint64_t bytes = sizeof(TailLogHeader) + uint64_t(slots) * kTailLogSlotSize;
+        file = CreateFileW(path.wstring().c_str(), GENERIC_READ | GENERIC_WRITE,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            file = nullptr;
+            return false;
+        }
+        
+        // Size the file before mapping it; a mapped file cannot be truncated, and an
+        // older, larger layout would otherwise leave stale bytes past the last slot.
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(bytes);
+        if (!SetFilePointerEx(file, size, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            Close();
+            return false;
+        }
+        
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(bytes >> 32),
+                                     static_cast<DWORD>(bytes), nullptr);
+        view = mapping ? static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, bytes)) : nullptr;
+        if (!view) {
+            Close();
+            return false;
+        }
+        
+        std::memset(view, 0, bytes);
+        auto* header = reinterpret_cast<TailLogHeader*>(view);
+        header->magic = kTailLogMagic;
+        header->version = kTailLogVersion;
+        header->slotSize = kTailLogSlotSize;
+        header->capacity = slots;
+        capacity = slots;
+        return true;
+    }
 
-                if (isAnimationEntry) {
-                    ss << message;
-                } else {
-                    ss << message;
-                }
+    void Append(std::string_view line) {
+        if (!view) return;
+        
+        auto* header = reinterpret_cast<TailLogHeader*>(view);
+        std::atomic_ref<uint64_t> head(header->head);
+        uint64_t index = head.load(std::memory_order_relaxed);
+        
+        uint8_t* slot = view + sizeof(TailLogHeader) + (index % capacity) * kTailLogSlotSize;
+        uint16_t length = static_cast<uint16_t>(std::min<size_t>(line.size(), kTailLogSlotSize - sizeof(uint16_t)));
+        std::memcpy(slot, &length, sizeof(length));
+        std::memcpy(slot + sizeof(length), line.data(), length);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    void Close() {
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file) CloseHandle(file);
+        view = nullptr;
+        mapping = nullptr;
+        file = nullptr;
+        capacity = 0;
+    }
+
+private:
+    HANDLE file = nullptr;
+    HANDLE mapping = nullptr;
+    uint8_t* view = nullptr;
+    uint32_t capacity = 0;
+};
 
-                logFile << ss.str() << std::endl;
-                logFile.close();
-            }
-        } catch (...) {
+// Primary and secondary SKSE folders, like the text logs. Guarded by g_logMutex.
+static std::array<MappedTailLog, 2> g_actionsTailLogs;
+static std::array<MappedTailLog, 2> g_heartbeatTailLogs;
+
+void OpenTailLogs() {
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    auto paths = GetAllSKSELogsPaths();
+    std::array<fs::path, 2> folders = {paths.primary, paths.secondary};
+    
+    for (size_t i = 0; i < folders.size(); ++i) {
+        if (folders[i].empty()) continue;
+        if (!g_actionsTailLogs[i].Open(folders[i] / "OSoundtracks-SA-Expansion-Sounds-NG-Actions.ringlog",
+                                       kActionsLogCapacity)) {
+            logger::warn("Could not map Actions log in {}", folders[i].string());
+        }
+        if (!g_heartbeatTailLogs[i].Open(folders[i] / "OSoundtracks-SA-Expansion-Sounds-NG-Animations-Game.ringlog",
+                                         kHeartbeatLogCapacity)) {
+            logger::warn("Could not map heartbeat log in {}", folders[i].string());
         }
     }
 }
 
-void WriteToActionsLog(const std::string& message, int lineNumber) {
+void CloseTailLogs() {
     std::lock_guard<std::mutex> lock(g_logMutex);
+    for (auto& log : g_actionsTailLogs) log.Close();
+    for (auto& log : g_heartbeatTailLogs) log.Close();
+}
 
-    auto paths = GetAllSKSELogsPaths();
-
-    std::vector<fs::path> logPaths = {
-        paths.primary / "OSoundtracks-SA-Expansion-Sounds-NG-Actions.log",
-        paths.secondary / "OSoundtracks-SA-Expansion-Sounds-NG-Actions.log"
-    };
-
+void WriteToActionsLog(const std::string& message, int lineNumber) {
     auto now = std::chrono::system_clock::now();
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
     std::time_t time_t = std::chrono::system_clock::to_time_t(now);
     std::tm buf;
     localtime_s(&buf, &time_t);
 
-    std::stringstream ss;
-    ss << "[" << std::put_time(&buf, "%Y-%m-%d %H:%M:%S");
-    ss << "." << std::setfill('0') << std::setw(3) << ms.count() << "] ";
-    ss << "[log] [info] ";
-    ss << "[plugin.cpp:" << lineNumber << "] ";
-    ss << message;
-
-    std::string newLine = ss.str();
-    g_actionLines.push_back(newLine);
-
-    if (g_actionLines.size() > 200) {
-        g_actionLines.pop_front();
-    }
+    char line[kTailLogSlotSize];
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &buf);
+    int length = std::snprintf(line, sizeof(line), "[%s.%03d] [log] [info] [plugin.cpp:%d] %s", stamp,
+                               static_cast<int>(ms.count()), lineNumber, message.c_str());
+    if (length < 0) return;
 
-    for (const auto& logPath : logPaths) {
-        try {
-            std::ofstream actionsFile(logPath, std::ios::trunc);
-            if (actionsFile.is_open()) {
-                for (const auto& line : g_actionLines) {
-                    actionsFile << line << std::endl;
-                }
-                actionsFile.close();
-            }
-        } catch (...) {
-        }
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    for (auto& log : g_actionsTailLogs) {
+        log.Append(std::string_view(line, std::min<size_t>(length, sizeof(line) - 1)));
     }
 }
 
 void WriteHeartbeat() {
-    std::lock_guard<std::mutex> lock(g_logMutex);
-
-    std::stringstream ss;
-    ss << "[" << GetCurrentTimeString() << "] [log] [info] the game is on";
-    std::string newLine = ss.str();
+    std::string line = "[" + GetCurrentTimeString() + "] [log] [info] the game is on";
 
-    g_heartbeatLines.push_back(newLine);
-
-    if (g_heartbeatLines.size() > 20) {
-        g_heartbeatLines.pop_front();
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    for (auto& log : g_heartbeatTailLogs) {
+        log.Append(line);
     }
+}
 
-    auto paths = GetAllSKSELogsPaths();
-    
-    std::vector<fs::path> heartbeatPaths = {
-        paths.primary / "OSoundtracks-SA-Expansion-Sounds-NG-Animations-Game.log",
-        paths.secondary / "OSoundtracks-SA-Expansion-Sounds-NG-Animations-Game.log"
-    };
-
-    for (const auto& heartbeatPath : heartbeatPaths) {
-        try {
-            std::ofstream heartbeatFile(heartbeatPath, std::ios::trunc);
-            if (heartbeatFile.is_open()) {
-                for (const auto& line : g_heartbeatLines) {
-                    heartbeatFile << line << std::endl;
-                }
-                heartbeatFile.close();
-            }
-        } catch (...) {
+// Rewritten every [Benchmark] LatencyStatsSeconds from the heartbeat thread and once
+// more when it stops. Goes through a temp file so readers never see half a document.
+void WriteLatencyStatsFile() {
+    try {
+        auto paths = GetAllSKSELogsPaths();
+        if (paths.primary.empty()) return;
+
+        OSoundtracksAPI::LatencyStats stats{};
+        ReadLatencyStats(stats);
+
+        std::ostringstream json;
+        json << "{\n  \"version\": " << stats.version << ",\n  \"generated\": \"" << GetCurrentTimeString()
+             << "\",\n  \"since_seconds\": " << stats.sinceMicros / 1000000 << ",\n  \"stages\": {\n";
+        for (uint32_t i = 0; i < stats.stageCount; ++i) {
+            const auto& stage = stats.stages[i];
+            json << "    \"" << OSoundtracksAPI::kLatencyStageNames[i] << "\": {\"count\": " << stage.count
+                 << ", \"mean_us\": " << (stage.count ? stage.totalMicros / stage.count : 0)
+                 << ", \"p50_us\": " << stage.p50Micros << ", \"p90_us\": " << stage.p90Micros
+                 << ", \"p99_us\": " << stage.p99Micros << ", \"max_us\": " << stage.maxMicros << "}"
+                 << (i + 1 < stats.stageCount ? ",\n" : "\n");
+        }
+        json << "  },\n";
+
+        OSoundtracksAPI::VoiceStats voices{};
+        ReadVoiceStats(voices);
+        json << "  \"voices\": {\"max\": " << voices.maxVoices << ", \"active\": " << voices.activeVoices
+             << ", \"peak\": " << voices.peakVoices << ", \"stolen\": " << voices.stolenVoices
+             << ", \"refused\": " << voices.refusedStarts << ", \"decode_cpu_percent\": " << std::fixed
+             << std::setprecision(1) << voices.decodeCpuPercent << "}\n}\n";
+
+        fs::path target = paths.primary / "OSoundtracks-SA-Expansion-Sounds-NG-Latency.json";
+        fs::path temp = target;
+        temp += ".tmp";
+        {
+            std::ofstream file(temp, std::ios::out | std::ios::trunc);
+            if (!file.is_open()) return;
+            file << json.str();
+        }
+        std::error_code error;
+        fs::rename(temp, target, error);
+        if (error) {
+            logger::warn("Could not replace latency stats file: {}", error.message());
         }
+    } catch (...) {
+        logger::error("Error writing latency stats");
     }
 }
 
 void HeartbeatThreadFunction() {
     logger::info("Heartbeat thread started");
-    g_heartbeatLines.clear();
 
+    auto lastLatencyDump = std::chrono::steady_clock::now();
     while (g_heartbeatActive.load() && !g_isShuttingDown.load()) {
         WriteHeartbeat();
+        SaveSoundMenuKeyStates();
+        SampleDecodeCpu();
+
+        uint32_t latencySeconds = g_latencyStatsSeconds.load();
+        auto now = std::chrono::steady_clock::now();
+        if (latencySeconds > 0 && now - lastLatencyDump >= std::chrono::seconds(latencySeconds)) {
+            WriteLatencyStatsFile();
+            lastLatencyDump = now;
+        }
+
         std::this_thread::sleep_for(std::chrono::seconds(3));
     }
 
+    if (g_latencyStatsSeconds.load() > 0) {
+        WriteLatencyStatsFile();
+    }
+
     logger::info("Heartbeat thread stopped");
 }
 
@@ -1308,7 +5002,8 @@ void ClassifyAnimations() {
     g_specificTracks.clear();
     g_menuTracks.clear();
 
-    for (const auto& [animName, config] : g_animationSoundMap) {
+    auto tables = GetSoundTables();
+    for (const auto& [animName, config] : tables->animation) {
         for (const auto& option : config.soundOptions) {
             if (IsMenuSound(animName)) {
                 g_menuTracks.push_back(option.soundFile);
@@ -1590,22 +5285,50 @@ void ProcessBackupUpdate() {
     }
 }
 
-bool LoadIniSettings() {
-    try {
-        if (!fs::exists(g_iniPath)) {
-            logger::warn("INI file not found: {}", g_iniPath.string());
-            WriteToSoundPlayerLog("WARNING: INI file not found at: " + g_iniPath.string(), __LINE__);
-            return false;
+// Parses the INI into [Section] Key -> Value, trimmed, comments and blank lines dropped.
+// A key repeated within a section keeps its last value, as the old line-by-line reader did.
+bool ReadIniValues(const fs::path& path, IniValues& values) {
+    std::ifstream iniFile(path);
+    if (!iniFile.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    std::string currentSection;
+    while (std::getline(iniFile, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+
+        if (line.empty() || line[0] == ';' || line[0] == '#') {
+            continue;
         }
 
-        std::ifstream iniFile(g_iniPath);
-        if (!iniFile.is_open()) {
-            logger::error("Could not open INI file");
-            return false;
+        if (line[0] == '[' && line[line.length() - 1] == ']') {
+            currentSection = line.substr(1, line.length() - 2);
+            continue;
         }
 
-        std::string line;
-        std::string currentSection;
+        size_t equalPos = line.find('=');
+        if (equalPos != std::string::npos) {
+            std::string key = line.substr(0, equalPos);
+            std::string value = line.substr(equalPos + 1);
+
+            key.erase(0, key.find_first_not_of(" \t"));
+            key.erase(key.find_last_not_of(" \t") + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            value.erase(value.find_last_not_of(" \t") + 1);
+
+            values[{currentSection, key}] = value;
+        }
+    }
+    return true;
+}
+
+// Applies the keys in `changed` on top of the current settings (LoadIniSettings passes
+// every key) and records `values`, the parse they came from, as applied at `writeTime`.
+// A key only moves its own setting, so the result matches re-reading the whole file.
+bool ApplyIniValues(const IniValues& changed, const IniValues& values, fs::file_time_type writeTime) {
+    try {
         bool newStartupSound = g_startupSoundEnabled.load();
         bool newTopNotifications = g_topNotificationsVisible.load();
         bool newMuteGameMusic = g_muteGameMusicDuringOStim.load();
@@ -1619,193 +5342,431 @@ bool LoadIniSettings() {
         bool newVolumeEnabled = g_volumeControlEnabled.load();
         SoundMenuKeyMode newSoundMenuKeyMode = g_soundMenuKeyMode;
         std::string newSoundMenuKeyAuthor = g_soundMenuKeyAuthor;
+        uint32_t newSoundMenuKeyNoRepeat = g_soundMenuKeyNoRepeat.load();
         std::string newMuteMusicCode = g_muteMusicCode;
+        bool newSampleCacheEnabled = g_sampleCacheEnabled.load();
+        uint32_t newSampleCacheMaxClipKB = g_sampleCacheMaxClipKB.load();
+        float newSampleCacheMaxClipSeconds = g_sampleCacheMaxClipSeconds.load();
+        uint32_t newSampleCacheBudgetMB = g_sampleCacheBudgetMB.load();
+        bool newPrefetchEnabled = g_prefetchEnabled.load();
+        uint32_t newPrefetchTopK = g_prefetchTopK.load();
+        bool newLoudnessEnabled = g_loudnessEnabled.load();
+        float newLoudnessTargetLufs = g_loudnessTargetLufs.load();
+        float newLoudnessMaxBoostDb = g_loudnessMaxBoostDb.load();
+        uint32_t newCrossfadeMs = g_crossfadeMs.load();
+        uint32_t newPauseFadeMs = g_pauseFadeMs.load();
+        uint32_t newMaxVoices = g_maxVoices.load();
+        ScenePolicy newScenePolicy = g_scenePolicy.load();
+        float newSceneDuckVolume = g_sceneDuckVolume.load();
+        std::string newAudioBackendName;
+        std::string newOfflineRenderFile;
+        {
+            std::lock_guard<std::mutex> lock(g_bassMutex);
+            newAudioBackendName = g_audioBackendName;
+            newOfflineRenderFile = g_offlineRenderFile;
+        }
+        std::string newReplaySession;
+        float newReplaySpeed = 1.0f;
+        uint32_t newReplayLoops = 1;
+        uint32_t newLatencyStatsSeconds = g_latencyStatsSeconds.load();
+        {
+            std::lock_guard<std::mutex> lock(g_replayMutex);
+            newReplaySession = g_replaySession;
+            newReplaySpeed = g_replaySpeed;
+            newReplayLoops = g_replayLoops;
+        }
 
         if (g_lastAuthorName.empty()) {
             g_lastAuthorName = g_soundMenuKeyAuthor;
         }
 
-        while (std::getline(iniFile, line)) {
-            line.erase(0, line.find_first_not_of(" \t\r\n"));
-            line.erase(line.find_last_not_of(" \t\r\n") + 1);
-
-            if (line.empty() || line[0] == ';' || line[0] == '#') {
-                continue;
-            }
-
-            if (line[0] == '[' && line[line.length() - 1] == ']') {
-                currentSection = line.substr(1, line.length() - 2);
-                continue;
-            }
-
-            size_t equalPos = line.find('=');
-            if (equalPos != std::string::npos) {
-                std::string key = line.substr(0, equalPos);
-                std::string value = line.substr(equalPos + 1);
-
-                key.erase(0, key.find_first_not_of(" \t"));
-                key.erase(key.find_last_not_of(" \t") + 1);
-                value.erase(0, value.find_first_not_of(" \t"));
-                value.erase(value.find_last_not_of(" \t") + 1);
-
-                if (currentSection == "Startup Sound" && key == "Startup") {
+        for (const auto& [name, parsedValue] : changed) {
+            const std::string& currentSection = name.first;
+            const std::string& key = name.second;
+            std::string value = parsedValue;
+
+            if (currentSection == "Startup Sound" && key == "Startup") {
+                std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+                newStartupSound = (value == "true" || value == "1" || value == "yes");
+            } else if (currentSection == "Top Notifications" && key == "Visible") {
+                std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+                newTopNotifications = (value == "true" || value == "1" || value == "yes");
+            } else if (currentSection == "Skyrim Audio") {
+                if (key == "MuteGameMusicDuringOStim") {
+                    std::string lowerValue = value;
+                    std::transform(lowerValue.begin(), lowerValue.end(), lowerValue.begin(), ::tolower);
+                    if (lowerValue == "false" || lowerValue == "0" || lowerValue == "disabled") {
+                        newMuteGameMusic = false;
+                        newMuteMusicCode = "";
+                    } else if (lowerValue == "true" || lowerValue == "1" || lowerValue == "yes") {
+                        newMuteGameMusic = true;
+                        newMuteMusicCode = "0010486c";
+                    } else if (lowerValue == "muscombatboss") {
+                        newMuteGameMusic = true;
+                        newMuteMusicCode = "MUSCombatBoss";
+                    } else if (lowerValue == "musspecialdeath") {
+                        newMuteGameMusic = true;
+                        newMuteMusicCode = "MUSSpecialDeath";
+                    } else if (lowerValue == "0010486c") {
+                        newMuteGameMusic = true;
+                        newMuteMusicCode = "0010486c";
+                    } else {
+                        newMuteGameMusic = true;
+                        newMuteMusicCode = "0010486c";
+                    }
+                }
+            } else if (currentSection == "Menu Sound") {
+                if (key == "SoundMenuKey") {
+                    std::string lowerValue = value;
+                    std::transform(lowerValue.begin(), lowerValue.end(), lowerValue.begin(), ::tolower);
+                    if (lowerValue == "false" || lowerValue == "0" || lowerValue == "disabled") {
+                        newSoundMenuKeyMode = SoundMenuKeyMode::DISABLED;
+                    } else if (lowerValue == "all_order") {
+                        newSoundMenuKeyMode = SoundMenuKeyMode::ALL_ORDER;
+                    } else if (lowerValue == "all_random") {
+                        newSoundMenuKeyMode = SoundMenuKeyMode::ALL_RANDOM;
+                    } else if (lowerValue == "all_weighted") {
+                        newSoundMenuKeyMode = SoundMenuKeyMode::ALL_WEIGHTED;
+                    } else if (lowerValue == "author_order") {
+                        newSoundMenuKeyMode = SoundMenuKeyMode::AUTHOR_ORDER;
+                    } else if (lowerValue == "author_random") {
+                        newSoundMenuKeyMode = SoundMenuKeyMode::AUTHOR_RANDOM;
+                    } else {
+                        logger::warn("Unknown SoundMenuKey mode: {}", value);
+                    }
+                } else if (key == "Author") {
+                    newSoundMenuKeyAuthor = value;
+                } else if (key == "NoRepeatWindow") {
+                    try {
+                        int window = std::stoi(value);
+                        if (window >= 0 && window <= static_cast<int>(PlaylistEngine::kMaxNoRepeat)) {
+                            newSoundMenuKeyNoRepeat = static_cast<uint32_t>(window);
+                        } else {
+                            logger::warn("NoRepeatWindow out of range (0-{}): {}", PlaylistEngine::kMaxNoRepeat, window);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid NoRepeatWindow value: {}", value);
+                    }
+                }
+            } else if (currentSection == "Backup update") {
+                if (key == "BackupINI") {
+                    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+                    g_backupUpdateEnabled = (value == "true" || value == "1" || value == "yes");
+                }
+            } else if (currentSection == "Volume Control") {
+                if (key == "BaseVolume") {
+                    try {
+                        float vol = std::stof(value);
+                        if (vol >= 0.0f && vol <= 2.0f) {
+                            newBaseVolume = vol;
+                        } else {
+                            logger::warn("BaseVolume out of range (0.0-2.0): {}", vol);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid BaseVolume value: {}", value);
+                    }
+                } else if (key == "MenuVolume") {
+                    try {
+                        float vol = std::stof(value);
+                        if (vol >= 0.0f && vol <= 2.0f) {
+                            newMenuVolume = vol;
+                        } else {
+                            logger::warn("MenuVolume out of range (0.0-2.0): {}", vol);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid MenuVolume value: {}", value);
+                    }
+                } else if (key == "SpecificVolume") {
+                    try {
+                        float vol = std::stof(value);
+                        if (vol >= 0.0f && vol <= 2.0f) {
+                            newSpecificVolume = vol;
+                        } else {
+                            logger::warn("SpecificVolume out of range (0.0-2.0): {}", vol);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid SpecificVolume value: {}", value);
+                    }
+                } else if (key == "EffectVolume") {
+                    try {
+                        float vol = std::stof(value);
+                        if (vol >= 0.0f && vol <= 2.0f) {
+                            newEffectVolume = vol;
+                        } else {
+                            logger::warn("EffectVolume out of range (0.0-2.0): {}", vol);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid EffectVolume value: {}", value);
+                    }
+                } else if (key == "PositionVolume") {
+                    try {
+                        float vol = std::stof(value);
+                        if (vol >= 0.0f && vol <= 2.0f) {
+                            newPositionVolume = vol;
+                        } else {
+                            logger::warn("PositionVolume out of range (0.0-2.0): {}", vol);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid PositionVolume value: {}", value);
+                    }
+                } else if (key == "TAGVolume") {
+                    try {
+                        float vol = std::stof(value);
+                        if (vol >= 0.0f && vol <= 2.0f) {
+                            newTagVolume = vol;
+                        } else {
+                            logger::warn("TAGVolume out of range (0.0-2.0): {}", vol);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid TAGVolume value: {}", value);
+                    }
+                } else if (key == "SoundMenuKeyVolume") {
+                    try {
+                        float vol = std::stof(value);
+                        if (vol >= 0.0f && vol <= 2.0f) {
+                            newSoundMenuKeyVolume = vol;
+                        } else {
+                            logger::warn("SoundMenuKeyVolume out of range (0.0-2.0): {}", vol);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid SoundMenuKeyVolume value: {}", value);
+                    }
+                } else if (key == "MasterVolumeEnabled") {
                     std::transform(value.begin(), value.end(), value.begin(), ::tolower);
-                    newStartupSound = (value == "true" || value == "1" || value == "yes");
-                } else if (currentSection == "Top Notifications" && key == "Visible") {
+                    newVolumeEnabled = (value == "true" || value == "1" || value == "yes");
+                }
+            } else if (currentSection == "Audio Engine") {
+                if (key == "SampleCache") {
                     std::transform(value.begin(), value.end(), value.begin(), ::tolower);
-                    newTopNotifications = (value == "true" || value == "1" || value == "yes");
-                } else if (currentSection == "Skyrim Audio") {
-                    if (key == "MuteGameMusicDuringOStim") {
-                        std::string lowerValue = value;
-                        std::transform(lowerValue.begin(), lowerValue.end(), lowerValue.begin(), ::tolower);
-                        if (lowerValue == "false" || lowerValue == "0" || lowerValue == "disabled") {
-                            newMuteGameMusic = false;
-                            newMuteMusicCode = "";
-                        } else if (lowerValue == "true" || lowerValue == "1" || lowerValue == "yes") {
-                            newMuteGameMusic = true;
-                            newMuteMusicCode = "0010486c";
-                        } else if (lowerValue == "muscombatboss") {
-                            newMuteGameMusic = true;
-                            newMuteMusicCode = "MUSCombatBoss";
-                        } else if (lowerValue == "musspecialdeath") {
-                            newMuteGameMusic = true;
-                            newMuteMusicCode = "MUSSpecialDeath";
-                        } else if (lowerValue == "0010486c") {
-                            newMuteGameMusic = true;
-                            newMuteMusicCode = "0010486c";
+                    newSampleCacheEnabled = (value == "true" || value == "1" || value == "yes");
+                } else if (key == "SampleCacheMaxClipKB") {
+                    try {
+                        int kb = std::stoi(value);
+                        if (kb >= 0 && kb <= 65536) {
+                            newSampleCacheMaxClipKB = static_cast<uint32_t>(kb);
                         } else {
-                            newMuteGameMusic = true;
-                            newMuteMusicCode = "0010486c";
+                            logger::warn("SampleCacheMaxClipKB out of range (0-65536): {}", kb);
                         }
+                    } catch (...) {
+                        logger::warn("Invalid SampleCacheMaxClipKB value: {}", value);
                     }
-                } else if (currentSection == "Menu Sound") {
-                    if (key == "SoundMenuKey") {
-                        std::string lowerValue = value;
-                        std::transform(lowerValue.begin(), lowerValue.end(), lowerValue.begin(), ::tolower);
-                        if (lowerValue == "false" || lowerValue == "0" || lowerValue == "disabled") {
-                            newSoundMenuKeyMode = SoundMenuKeyMode::DISABLED;
-                        } else if (lowerValue == "all_order") {
-                            newSoundMenuKeyMode = SoundMenuKeyMode::ALL_ORDER;
-                        } else if (lowerValue == "all_random") {
-                            newSoundMenuKeyMode = SoundMenuKeyMode::ALL_RANDOM;
-                        } else if (lowerValue == "author_order") {
-                            newSoundMenuKeyMode = SoundMenuKeyMode::AUTHOR_ORDER;
-                        } else if (lowerValue == "author_random") {
-                            newSoundMenuKeyMode = SoundMenuKeyMode::AUTHOR_RANDOM;
+                } else if (key == "SampleCacheMaxClipSeconds") {
+                    try {
+                        float seconds = std::stof(value);
+                        if (seconds >= 0.0f && seconds <= 600.0f) {
+                            newSampleCacheMaxClipSeconds = seconds;
                         } else {
-                            logger::warn("Unknown SoundMenuKey mode: {}", value);
+                            logger::warn("SampleCacheMaxClipSeconds out of range (0-600): {}", seconds);
                         }
-                    } else if (key == "Author") {
-                        newSoundMenuKeyAuthor = value;
+                    } catch (...) {
+                        logger::warn("Invalid SampleCacheMaxClipSeconds value: {}", value);
                     }
-                } else if (currentSection == "Backup update") {
-                    if (key == "BackupINI") {
-                        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
-                        g_backupUpdateEnabled = (value == "true" || value == "1" || value == "yes");
+                } else if (key == "SampleCacheBudgetMB") {
+                    try {
+                        int mb = std::stoi(value);
+                        if (mb >= 0 && mb <= 2048) {
+                            newSampleCacheBudgetMB = static_cast<uint32_t>(mb);
+                        } else {
+                            logger::warn("SampleCacheBudgetMB out of range (0-2048): {}", mb);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid SampleCacheBudgetMB value: {}", value);
                     }
-                } else if (currentSection == "Volume Control") {
-                    if (key == "BaseVolume") {
-                        try {
-                            float vol = std::stof(value);
-                            if (vol >= 0.0f && vol <= 2.0f) {
-                                newBaseVolume = vol;
-                            } else {
-                                logger::warn("BaseVolume out of range (0.0-2.0): {}", vol);
-                            }
-                        } catch (...) {
-                            logger::warn("Invalid BaseVolume value: {}", value);
+                } else if (key == "Prefetch") {
+                    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+                    newPrefetchEnabled = (value == "true" || value == "1" || value == "yes");
+                } else if (key == "PrefetchTopK") {
+                    try {
+                        int topK = std::stoi(value);
+                        if (topK >= 1 && topK <= 8) {
+                            newPrefetchTopK = static_cast<uint32_t>(topK);
+                        } else {
+                            logger::warn("PrefetchTopK out of range (1-8): {}", topK);
                         }
-                    } else if (key == "MenuVolume") {
-                        try {
-                            float vol = std::stof(value);
-                            if (vol >= 0.0f && vol <= 2.0f) {
-                                newMenuVolume = vol;
-                            } else {
-                                logger::warn("MenuVolume out of range (0.0-2.0): {}", vol);
-                            }
-                        } catch (...) {
-                            logger::warn("Invalid MenuVolume value: {}", value);
+                    } catch (...) {
+                        logger::warn("Invalid PrefetchTopK value: {}", value);
+                    }
+                } else if (key == "LoudnessNormalization") {
+                    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+                    newLoudnessEnabled = (value == "true" || value == "1" || value == "yes");
+                } else if (key == "LoudnessTargetLUFS") {
+                    try {
+                        float lufs = std::stof(value);
+                        if (lufs >= -30.0f && lufs <= -10.0f) {
+                            newLoudnessTargetLufs = lufs;
+                        } else {
+                            logger::warn("LoudnessTargetLUFS out of range (-30 to -10): {}", lufs);
                         }
-                    } else if (key == "SpecificVolume") {
-                        try {
-                            float vol = std::stof(value);
-                            if (vol >= 0.0f && vol <= 2.0f) {
-                                newSpecificVolume = vol;
-                            } else {
-                                logger::warn("SpecificVolume out of range (0.0-2.0): {}", vol);
-                            }
-                        } catch (...) {
-                            logger::warn("Invalid SpecificVolume value: {}", value);
+                    } catch (...) {
+                        logger::warn("Invalid LoudnessTargetLUFS value: {}", value);
+                    }
+                } else if (key == "LoudnessMaxBoostDb") {
+                    try {
+                        float db = std::stof(value);
+                        if (db >= 0.0f && db <= 12.0f) {
+                            newLoudnessMaxBoostDb = db;
+                        } else {
+                            logger::warn("LoudnessMaxBoostDb out of range (0-12): {}", db);
                         }
-                    } else if (key == "EffectVolume") {
-                        try {
-                            float vol = std::stof(value);
-                            if (vol >= 0.0f && vol <= 2.0f) {
-                                newEffectVolume = vol;
-                            } else {
-                                logger::warn("EffectVolume out of range (0.0-2.0): {}", vol);
-                            }
-                        } catch (...) {
-                            logger::warn("Invalid EffectVolume value: {}", value);
+                    } catch (...) {
+                        logger::warn("Invalid LoudnessMaxBoostDb value: {}", value);
+                    }
+                } else if (key == "CrossfadeMs") {
+                    try {
+                        int ms = std::stoi(value);
+                        if (ms >= 0 && ms <= 5000) {
+                            newCrossfadeMs = static_cast<uint32_t>(ms);
+                        } else {
+                            logger::warn("CrossfadeMs out of range (0-5000): {}", ms);
                         }
-                    } else if (key == "PositionVolume") {
-                        try {
-                            float vol = std::stof(value);
-                            if (vol >= 0.0f && vol <= 2.0f) {
-                                newPositionVolume = vol;
-                            } else {
-                                logger::warn("PositionVolume out of range (0.0-2.0): {}", vol);
-                            }
-                        } catch (...) {
-                            logger::warn("Invalid PositionVolume value: {}", value);
+                    } catch (...) {
+                        logger::warn("Invalid CrossfadeMs value: {}", value);
+                    }
+                } else if (key == "PauseFadeMs") {
+                    try {
+                        int ms = std::stoi(value);
+                        if (ms >= 0 && ms <= 2000) {
+                            newPauseFadeMs = static_cast<uint32_t>(ms);
+                        } else {
+                            logger::warn("PauseFadeMs out of range (0-2000): {}", ms);
                         }
-                    } else if (key == "TAGVolume") {
-                        try {
-                            float vol = std::stof(value);
-                            if (vol >= 0.0f && vol <= 2.0f) {
-                                newTagVolume = vol;
-                            } else {
-                                logger::warn("TAGVolume out of range (0.0-2.0): {}", vol);
-                            }
-                        } catch (...) {
-                            logger::warn("Invalid TAGVolume value: {}", value);
+                    } catch (...) {
+                        logger::warn("Invalid PauseFadeMs value: {}", value);
+                    }
+                } else if (key == "ScenePolicy") {
+                    std::string policy = value;
+                    std::transform(policy.begin(), policy.end(), policy.begin(),
+                                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                    if (policy == "player") {
+                        newScenePolicy = ScenePolicy::Player;
+                    } else if (policy == "latest") {
+                        newScenePolicy = ScenePolicy::Latest;
+                    } else if (policy == "npc-ducked") {
+                        newScenePolicy = ScenePolicy::NpcDucked;
+                    } else {
+                        logger::warn("Invalid ScenePolicy value (player, latest, npc-ducked): {}", value);
+                    }
+                } else if (key == "SceneDuckVolume") {
+                    try {
+                        float volume = std::stof(value);
+                        if (volume >= 0.0f && volume <= 1.0f) {
+                            newSceneDuckVolume = volume;
+                        } else {
+                            logger::warn("SceneDuckVolume out of range (0.0-1.0): {}", volume);
                         }
-                    } else if (key == "SoundMenuKeyVolume") {
-                        try {
-                            float vol = std::stof(value);
-                            if (vol >= 0.0f && vol <= 2.0f) {
-                                newSoundMenuKeyVolume = vol;
-                            } else {
-                                logger::warn("SoundMenuKeyVolume out of range (0.0-2.0): {}", vol);
-                            }
-                        } catch (...) {
-                            logger::warn("Invalid SoundMenuKeyVolume value: {}", value);
+                    } catch (...) {
+                        logger::warn("Invalid SceneDuckVolume value: {}", value);
+                    }
+                } else if (key == "MaxVoices") {
+                    try {
+                        int voices = std::stoi(value);
+                        if (voices == 0 || (voices >= 4 && voices <= 64)) {
+                            newMaxVoices = static_cast<uint32_t>(voices);
+                        } else {
+                            logger::warn("MaxVoices out of range (0 or 4-64): {}", voices);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid MaxVoices value: {}", value);
+                    }
+                } else if (key == "Backend") {
+                    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+                    if (value == "bass" || value == "null" || value == "offline") {
+                        newAudioBackendName = value;
+                    } else {
+                        logger::warn("Invalid Backend value (bass/null/offline): {}", value);
+                    }
+                } else if (key == "OfflineRenderFile") {
+                    newOfflineRenderFile = value;
+                }
+            } else if (currentSection == "Benchmark") {
+                if (key == "ReplaySession") {
+                    newReplaySession = value;
+                } else if (key == "ReplaySpeed") {
+                    try {
+                        float speed = std::stof(value);
+                        if (speed >= 0.0f && speed <= 1000.0f) {
+                            newReplaySpeed = speed;
+                        } else {
+                            logger::warn("ReplaySpeed out of range (0-1000): {}", speed);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid ReplaySpeed value: {}", value);
+                    }
+                } else if (key == "ReplayLoops") {
+                    try {
+                        int loops = std::stoi(value);
+                        if (loops >= 1 && loops <= 100) {
+                            newReplayLoops = static_cast<uint32_t>(loops);
+                        } else {
+                            logger::warn("ReplayLoops out of range (1-100): {}", loops);
+                        }
+                    } catch (...) {
+                        logger::warn("Invalid ReplayLoops value: {}", value);
+                    }
+                } else if (key == "LatencyStatsSeconds") {
+                    try {
+                        int seconds = std::stoi(value);
+                        if (seconds >= 0 && seconds <= 3600) {
+                            newLatencyStatsSeconds = static_cast<uint32_t>(seconds);
+                        } else {
+                            logger::warn("LatencyStatsSeconds out of range (0-3600): {}", seconds);
                         }
-                    } else if (key == "MasterVolumeEnabled") {
-                        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
-                        newVolumeEnabled = (value == "true" || value == "1" || value == "yes");
+                    } catch (...) {
+                        logger::warn("Invalid LatencyStatsSeconds value: {}", value);
                     }
                 }
             }
         }
 
-        iniFile.close();
-
         bool startupChanged = (newStartupSound != g_startupSoundEnabled.load());
         bool notificationsChanged = (newTopNotifications != g_topNotificationsVisible.load());
         bool muteGameMusicChanged = (newMuteGameMusic != g_muteGameMusicDuringOStim.load());
-        bool volumeChanged = (newBaseVolume != g_baseVolume.load() || 
-                             newMenuVolume != g_menuVolume.load() || 
-                             newSpecificVolume != g_specificVolume.load() ||
-                             newEffectVolume != g_effectVolume.load() ||
-                             newPositionVolume != g_positionVolume.load() ||
-                             newTagVolume != g_tagVolume.load() ||
-                             newSoundMenuKeyVolume != g_soundMenuKeyVolume.load() ||
-                             newVolumeEnabled != g_volumeControlEnabled.load());
+        bool volumeEnabledChanged = (newVolumeEnabled != g_volumeControlEnabled.load());
+        std::vector<ScriptType> volumeChannels;
+        if (newBaseVolume != g_baseVolume.load()) volumeChannels.push_back(SCRIPT_BASE);
+        if (newSpecificVolume != g_specificVolume.load()) volumeChannels.push_back(SCRIPT_SPECIFIC);
+        if (newMenuVolume != g_menuVolume.load()) volumeChannels.push_back(SCRIPT_MENU);
+        if (newSoundMenuKeyVolume != g_soundMenuKeyVolume.load()) volumeChannels.push_back(SCRIPT_CHECK);
+        if (newEffectVolume != g_effectVolume.load()) volumeChannels.push_back(SCRIPT_EFFECT);
+        if (newPositionVolume != g_positionVolume.load()) volumeChannels.push_back(SCRIPT_POSITION);
+        if (newTagVolume != g_tagVolume.load()) volumeChannels.push_back(SCRIPT_TAG);
+        bool volumeChanged = volumeEnabledChanged || !volumeChannels.empty();
 
         bool soundMenuKeyChanged = (newSoundMenuKeyMode != g_soundMenuKeyMode ||
-                                   newSoundMenuKeyAuthor != g_soundMenuKeyAuthor);
+                                   newSoundMenuKeyAuthor != g_soundMenuKeyAuthor ||
+                                   newSoundMenuKeyNoRepeat != g_soundMenuKeyNoRepeat.load());
         bool authorChanged = (newSoundMenuKeyAuthor != g_soundMenuKeyAuthor);
+        bool sampleCacheChanged = (newSampleCacheEnabled != g_sampleCacheEnabled.load() ||
+                                  newSampleCacheMaxClipKB != g_sampleCacheMaxClipKB.load() ||
+                                  newSampleCacheMaxClipSeconds != g_sampleCacheMaxClipSeconds.load() ||
+                                  newSampleCacheBudgetMB != g_sampleCacheBudgetMB.load());
+        bool prefetchChanged = (newPrefetchEnabled != g_prefetchEnabled.load() ||
+                               newPrefetchTopK != g_prefetchTopK.load());
+        bool loudnessChanged = (newLoudnessEnabled != g_loudnessEnabled.load() ||
+                                newLoudnessTargetLufs != g_loudnessTargetLufs.load() ||
+                                newLoudnessMaxBoostDb != g_loudnessMaxBoostDb.load());
+        bool crossfadeChanged = (newCrossfadeMs != g_crossfadeMs.load());
+        bool pauseFadeChanged = (newPauseFadeMs != g_pauseFadeMs.load());
+        bool maxVoicesChanged = (newMaxVoices != g_maxVoices.load());
+        bool scenePolicyChanged = (newScenePolicy != g_scenePolicy.load() ||
+                                   newSceneDuckVolume != g_sceneDuckVolume.load());
+        bool backendChanged = false;
+        {
+            // Read once by InitializeBASSLibrary; a change needs the audio library to be reinitialized.
+            std::lock_guard<std::mutex> lock(g_bassMutex);
+            backendChanged = (newAudioBackendName != g_audioBackendName);
+            g_audioBackendName = newAudioBackendName;
+            g_offlineRenderFile = newOfflineRenderFile;
+        }
+        bool replayChanged = false;
+        {
+            std::lock_guard<std::mutex> lock(g_replayMutex);
+            replayChanged = (newReplaySession != g_replaySession || newReplaySpeed != g_replaySpeed ||
+                             newReplayLoops != g_replayLoops);
+            g_replaySession = newReplaySession;
+            g_replaySpeed = newReplaySpeed;
+            g_replayLoops = newReplayLoops;
+        }
 
         g_startupSoundEnabled = newStartupSound;
         g_topNotificationsVisible = newTopNotifications;
@@ -1819,6 +5780,22 @@ bool LoadIniSettings() {
         g_soundMenuKeyVolume = newSoundMenuKeyVolume;
         g_volumeControlEnabled = newVolumeEnabled;
         g_muteMusicCode = newMuteMusicCode;
+        g_sampleCacheEnabled = newSampleCacheEnabled;
+        g_sampleCacheMaxClipKB = newSampleCacheMaxClipKB;
+        g_sampleCacheMaxClipSeconds = newSampleCacheMaxClipSeconds;
+        g_sampleCacheBudgetMB = newSampleCacheBudgetMB;
+        g_prefetchEnabled = newPrefetchEnabled;
+        g_prefetchTopK = newPrefetchTopK;
+        g_loudnessEnabled = newLoudnessEnabled;
+        g_loudnessTargetLufs = newLoudnessTargetLufs;
+        g_loudnessMaxBoostDb = newLoudnessMaxBoostDb;
+        g_crossfadeMs = newCrossfadeMs;
+        g_pauseFadeMs = newPauseFadeMs;
+        g_maxVoices = newMaxVoices;
+        g_scenePolicy = newScenePolicy;
+        g_sceneDuckVolume = newSceneDuckVolume;
+        if (scenePolicyChanged) g_scenePolicyChanged = true;
+        g_latencyStatsSeconds = newLatencyStatsSeconds;
 
         if (authorChanged && !newSoundMenuKeyAuthor.empty() && !g_iniFirstLoad) {
             WriteToSoundPlayerLog("AUTHOR CHANGED: '" + g_soundMenuKeyAuthor + "' -> '" + newSoundMenuKeyAuthor + "'", __LINE__);
@@ -1835,6 +5812,7 @@ bool LoadIniSettings() {
         
         if (soundMenuKeyChanged || (authorChanged && !g_iniFirstLoad)) {
             g_soundMenuKeyMode = newSoundMenuKeyMode;
+            g_soundMenuKeyNoRepeat = newSoundMenuKeyNoRepeat;
             if (!authorChanged) {
                 g_soundMenuKeyAuthor = newSoundMenuKeyAuthor;
             }
@@ -1843,22 +5821,22 @@ bool LoadIniSettings() {
                 WriteToSoundPlayerLog("SoundMenuKey DISABLED via INI change", __LINE__);
                 StopSoundMenuKey();
             }
-            else if (g_soundMenuKeyActive.load()) {
-                WriteToSoundPlayerLog("SoundMenuKey config/author changed - RESTARTING AUDIO STREAM", __LINE__);
+            else if (g_soundMenuKeyActive.load() && authorChanged) {
+                WriteToSoundPlayerLog("SoundMenuKey author changed - RESTARTING AUDIO STREAM", __LINE__);
                 
                 BuildSoundMenuKeyPlaylist();
                 
                 StopBASSStream(SCRIPT_CHECK);
                 g_currentSoundMenuKeyTrack = "";
                 
+                // While a menu is open the Menu group is paused, so the new track starts held.
                 PlayNextSoundMenuKeyTrack();
-                
-                if (g_soundsPaused.load()) {
-                    PauseBASSStream(SCRIPT_CHECK);
-                    g_soundMenuKeyPaused = true;
-                    g_soundMenuKeyWasActiveBeforePause = true;
-                    WriteToSoundPlayerLog("SoundMenuKey updated and immediately PAUSED (Menu open detected)", __LINE__);
-                }
+            }
+            else if (g_soundMenuKeyActive.load()) {
+                // Mode or no-repeat window only: the current track plays out and the
+                // playlist is rebuilt in the new order when it advances.
+                WriteToSoundPlayerLog("SoundMenuKey playlist mode changed - applies from the next track", __LINE__);
+                InvalidateSoundMenuKeyPlaylist();
             }
         }
 
@@ -1879,16 +5857,101 @@ bool LoadIniSettings() {
                                 ", Menu: " + std::to_string(newMenuVolume) + 
                                 ", Specific: " + std::to_string(newSpecificVolume) + 
                                 ", Control: " + std::string(newVolumeEnabled ? "enabled" : "disabled"), __LINE__);
-            UpdateAllBASSVolumes();
+            if (volumeEnabledChanged) {
+                UpdateAllBASSVolumes();
+            } else {
+                for (ScriptType type : volumeChannels) {
+                    UpdateBASSVolume(type);
+                }
+            }
+        }
+
+        if (sampleCacheChanged) {
+            WriteToSoundPlayerLog("Sample cache - " + std::string(newSampleCacheEnabled ? "enabled" : "disabled") +
+                                ", max clip: " + std::to_string(newSampleCacheMaxClipKB) + " KB / " +
+                                std::to_string(newSampleCacheMaxClipSeconds) + " s" +
+                                ", budget: " + std::to_string(newSampleCacheBudgetMB) + " MB", __LINE__);
+            ApplySampleCacheSettings();
+        }
+
+        if (prefetchChanged) {
+            WriteToSoundPlayerLog("Prefetch - " + std::string(newPrefetchEnabled ? "enabled" : "disabled") +
+                                ", top-K: " + std::to_string(newPrefetchTopK), __LINE__);
+        }
+
+        if (loudnessChanged) {
+            WriteToSoundPlayerLog("Loudness normalization - " + std::string(newLoudnessEnabled ? "enabled" : "disabled") +
+                                ", target: " + std::to_string(static_cast<int>(std::lround(newLoudnessTargetLufs))) + " LUFS" +
+                                ", max boost: " + std::to_string(static_cast<int>(std::lround(newLoudnessMaxBoostDb))) +
+                                " dB (applies to the next start)", __LINE__);
+            if (newLoudnessEnabled) QueueLoudnessAnalysis();
+        }
+
+        if (crossfadeChanged) {
+            WriteToSoundPlayerLog("Crossfade set to " + std::to_string(newCrossfadeMs) + "ms", __LINE__);
+        }
+
+        if (pauseFadeChanged) {
+            WriteToSoundPlayerLog("Pause fade set to " + std::to_string(newPauseFadeMs) + "ms", __LINE__);
+        }
+
+        if (scenePolicyChanged) {
+            WriteToSoundPlayerLog(std::string("Scene policy set to ") + ScenePolicyName(newScenePolicy) + ", duck volume " +
+                                std::to_string(static_cast<int>(newSceneDuckVolume * 100)) + "%", __LINE__);
+        }
+
+        if (maxVoicesChanged) {
+            WriteToSoundPlayerLog("Voice budget set to " + (newMaxVoices ? std::to_string(newMaxVoices) + " voices" : std::string("unlimited")) +
+                                " (applies to the next start)", __LINE__);
+        }
+
+        if (backendChanged) {
+            WriteToSoundPlayerLog("Audio backend set to '" + newAudioBackendName + "'" +
+                                (g_bassInitialized ? " (applies on next game launch)" : ""), __LINE__);
+        }
+
+        // The first load happens before the plugin is initialized; InitializePlugin
+        // starts that replay itself.
+        if (replayChanged && !newReplaySession.empty() && g_isInitialized) {
+            StartReplayBenchmark();
+        }
+
+        WriteToSoundPlayerLog(
+            "INI settings loaded - Startup Sound: " + std::string(g_startupSoundEnabled.load() ? "enabled" : "disabled") +
+                ", Top Notifications: " + std::string(g_topNotificationsVisible.load() ? "enabled" : "disabled") +
+                ", Volume Control: " + std::string(g_volumeControlEnabled.load() ? "enabled" : "disabled"),
+            __LINE__);
+
+        g_iniAppliedValues = values;
+        g_iniAppliedWriteTime = writeTime;
+
+        return true;
+
+    } catch (const std::exception& e) {
+        logger::error("Error applying INI settings: {}", e.what());
+        return false;
+    }
+}
+
+bool LoadIniSettings() {
+    try {
+        if (!fs::exists(g_iniPath)) {
+            logger::warn("INI file not found: {}", g_iniPath.string());
+            WriteToSoundPlayerLog("WARNING: INI file not found at: " + g_iniPath.string(), __LINE__);
+            return false;
+        }
+
+        // Taken before the read, so a write that lands during it still looks new to the watcher.
+        std::error_code timeError;
+        fs::file_time_type writeTime = fs::last_write_time(g_iniPath, timeError);
+
+        IniValues iniValues;
+        if (!ReadIniValues(g_iniPath, iniValues)) {
+            logger::error("Could not open INI file");
+            return false;
         }
 
-        WriteToSoundPlayerLog(
-            "INI settings loaded - Startup Sound: " + std::string(g_startupSoundEnabled.load() ? "enabled" : "disabled") +
-                ", Top Notifications: " + std::string(g_topNotificationsVisible.load() ? "enabled" : "disabled") +
-                ", Volume Control: " + std::string(g_volumeControlEnabled.load() ? "enabled" : "disabled"),
-            __LINE__);
-
-        return true;
+        return ApplyIniValues(iniValues, iniValues, writeTime);
 
     } catch (const std::exception& e) {
         logger::error("Error loading INI settings: {}", e.what());
@@ -1896,28 +5959,147 @@ bool LoadIniSettings() {
     }
 }
 
+// Applies the settings whose INI keys differ from what was last applied, from the same
+// parse the differences were taken from. Returns false when the file could not be read,
+// so the caller can try again on the next wakeup.
+bool ApplyIniChanges() {
+    std::error_code timeError;
+    fs::file_time_type writeTime = fs::last_write_time(g_iniPath, timeError);
+    if (timeError) {
+        return false;
+    }
+    if (writeTime == g_iniAppliedWriteTime) {
+        return true;
+    }
+
+    IniValues values;
+    if (!ReadIniValues(g_iniPath, values)) {
+        return false;
+    }
+
+    IniValues changed;
+    std::vector<std::string> changes;
+    auto describe = [](const IniValues::key_type& name) { return "[" + name.first + "] " + name.second; };
+    for (const auto& [name, value] : values) {
+        auto previous = g_iniAppliedValues.find(name);
+        if (previous == g_iniAppliedValues.end()) {
+            changes.push_back(describe(name) + " = " + value);
+            changed.emplace(name, value);
+        } else if (previous->second != value) {
+            changes.push_back(describe(name) + ": " + previous->second + " -> " + value);
+            changed.emplace(name, value);
+        }
+    }
+    for (const auto& [name, value] : g_iniAppliedValues) {
+        if (!values.contains(name)) {
+            changes.push_back(describe(name) + " removed");
+        }
+    }
+
+    if (changes.empty()) {
+        // The MCM rewrites the whole file on every save, touched key or not.
+        g_iniAppliedWriteTime = writeTime;
+        return true;
+    }
+
+    WriteToSoundPlayerLog("INI file changed (" + std::to_string(changes.size()) + " setting" +
+                              (changes.size() == 1 ? "" : "s") + "), applying...", __LINE__);
+    for (const auto& change : changes) {
+        WriteToSoundPlayerLog("  " + change, __LINE__);
+    }
+    CreateIniBackup();
+    return ApplyIniValues(changed, values, writeTime);
+}
+
+// True when the INI's write time differs from the one last applied, or cannot be read.
+bool IniWriteTimeChanged() {
+    std::error_code timeError;
+    fs::file_time_type writeTime = fs::last_write_time(g_iniPath, timeError);
+    return timeError || writeTime != g_iniAppliedWriteTime;
+}
+
 void IniMonitorThreadFunction() {
+    constexpr DWORD kIniQuietMs = 300;
+    constexpr DWORD kIniRetryMs = 1000;
+    constexpr DWORD kIniFallbackPollMs = 5000;
+    constexpr auto kIniMaxDelay = std::chrono::seconds(2);
+
     logger::info("INI monitoring thread started");
 
+    fs::path folder = g_iniPath.parent_path();
+    HANDLE changeHandle = INVALID_HANDLE_VALUE;
+    // The first pass catches anything written between the initial load and now, e.g. a
+    // backup restore, and refreshes the backup as the old polling loop did on startup.
+    bool pending = true;
+    CreateIniBackup();
+
     while (g_monitoringIni.load() && !g_isShuttingDown.load()) {
-        try {
-            if (fs::exists(g_iniPath)) {
-                auto currentModTime = fs::last_write_time(g_iniPath);
-                auto currentModTimeT = std::chrono::system_clock::to_time_t(
-                    std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                        currentModTime - fs::file_time_type::clock::now() + std::chrono::system_clock::now()));
-
-                if (currentModTimeT > g_lastIniCheckTime) {
-                    WriteToSoundPlayerLog("INI file changed, reloading settings...", __LINE__);
-                    CreateIniBackup();
-                    LoadIniSettings();
-                    g_lastIniCheckTime = currentModTimeT;
+        if (pending) {
+            try {
+                pending = !ApplyIniChanges();
+            } catch (...) {
+                pending = false;
+            }
+        }
+
+        if (changeHandle == INVALID_HANDLE_VALUE) {
+            changeHandle = FindFirstChangeNotificationW(
+                folder.wstring().c_str(), FALSE,
+                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+
+            if (changeHandle == INVALID_HANDLE_VALUE) {
+                if (WaitForSingleObject(g_iniStopEvent, 5000) == WAIT_OBJECT_0) {
+                    break;
                 }
+                pending = true;
+                continue;
             }
-        } catch (...) {
         }
 
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        // A short timeout while a read failed (the MCM may still hold the file open).
+        // Otherwise a slow poll, since notifications may never arrive, e.g. under MO2's
+        // virtual file system; ApplyIniChanges compares the write time first, so an idle
+        // poll costs one stat.
+        HANDLE handles[2] = {g_iniStopEvent, changeHandle};
+        DWORD result = WaitForMultipleObjects(2, handles, FALSE, pending ? kIniRetryMs : kIniFallbackPollMs);
+
+        if (result == WAIT_OBJECT_0) {
+            break;
+        }
+
+        if (result == WAIT_OBJECT_0 + 1) {
+            bool rearmed = FindNextChangeNotification(changeHandle) != FALSE;
+
+            // The plugin keeps its own files next to the INI (the -Playlist, -Transitions and
+            // -Loudness .txt files); changes that leave the INI's write time alone are ignored.
+            if (rearmed && !IniWriteTimeChanged()) {
+                continue;
+            }
+
+            // An MCM page writes one key at a time; wait for the burst to go quiet, but not
+            // forever if something keeps writing to the folder.
+            auto burstStart = std::chrono::steady_clock::now();
+            while (rearmed && WaitForSingleObject(changeHandle, kIniQuietMs) == WAIT_OBJECT_0 &&
+                   std::chrono::steady_clock::now() - burstStart < kIniMaxDelay) {
+                rearmed = FindNextChangeNotification(changeHandle) != FALSE;
+            }
+
+            if (!rearmed) {
+                FindCloseChangeNotification(changeHandle);
+                changeHandle = INVALID_HANDLE_VALUE;
+            }
+            pending = true;
+        } else if (result == WAIT_TIMEOUT) {
+            pending = true;
+        } else {
+            FindCloseChangeNotification(changeHandle);
+            changeHandle = INVALID_HANDLE_VALUE;
+            pending = true;
+        }
+    }
+
+    if (changeHandle != INVALID_HANDLE_VALUE) {
+        FindCloseChangeNotification(changeHandle);
     }
 
     logger::info("INI monitoring thread stopped");
@@ -1925,6 +6107,10 @@ void IniMonitorThreadFunction() {
 
 void StartIniMonitoring() {
     if (!g_monitoringIni.load()) {
+        if (!g_iniStopEvent) {
+            g_iniStopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        }
+        ResetEvent(g_iniStopEvent);
         g_monitoringIni = true;
         g_iniMonitorThread = std::thread(IniMonitorThreadFunction);
     }
@@ -1933,17 +6119,22 @@ void StartIniMonitoring() {
 void StopIniMonitoring() {
     if (g_monitoringIni.load()) {
         g_monitoringIni = false;
+        if (g_iniStopEvent) {
+            SetEvent(g_iniStopEvent);
+        }
         if (g_iniMonitorThread.joinable()) {
             g_iniMonitorThread.join();
         }
     }
 }
 
-std::string GetAnimationBase(const std::string& animationName) {
+std::string_view GetAnimationBaseView(std::string_view animationName) {
     size_t lastDash = animationName.rfind('-');
-    if (lastDash != std::string::npos) {
-        std::string suffix = animationName.substr(lastDash + 1);
-        bool isNumber = !suffix.empty() && std::all_of(suffix.begin(), suffix.end(), ::isdigit);
+    if (lastDash != std::string_view::npos) {
+        std::string_view suffix = animationName.substr(lastDash + 1);
+        bool isNumber = !suffix.empty() && std::all_of(suffix.begin(), suffix.end(), [](char ch) {
+            return std::isdigit(static_cast<unsigned char>(ch)) != 0;
+        });
         if (isNumber) {
             return animationName.substr(0, lastDash);
         }
@@ -3180,15 +7371,8 @@ void StopAllScripts() {
     }
 
     g_scriptsInitialized = false;
-    g_currentBaseAnimation = "";
-    g_currentSpecificAnimation = "";
     g_currentPositionFragment = "";
-    g_lastAnimation = "";
-
-    {
-        std::lock_guard<std::mutex> lock(g_throttleMutex);
-        g_lastPlayTime.clear();
-    }
+    ForgetScenes();
 
     g_activationMessageShown = false;
     WriteToSoundPlayerLog("Activation message flag reset - will show on next initialization", __LINE__);
@@ -3202,65 +7386,10 @@ void PauseAllSounds() {
     if (!g_soundsPaused.load()) {
         g_soundsPaused = true;
 
-        WriteToSoundPlayerLog("PAUSING ALL SOUNDS (BASS + MULTI-LAYER POSITION)", __LINE__);
-
-        g_baseWasActiveBeforePause = (g_baseStream != 0);
-        g_menuWasActiveBeforePause = (g_menuStream != 0);
-        g_specificWasActiveBeforePause = (g_specificStream != 0);
-        g_soundMenuKeyWasActiveBeforePause = (g_soundMenuKeyActive.load() && !g_soundMenuKeyPaused.load());
-        g_effectWasActiveBeforePause = (g_effectStream != 0);
-        g_tagWasActiveBeforePause = (g_tagStream != 0);
-
-        if (g_baseWasActiveBeforePause) {
-            PauseBASSStream(SCRIPT_BASE);
-            WriteToSoundPlayerLog("Base stream paused", __LINE__);
-        }
-
-        if (g_menuWasActiveBeforePause) {
-            PauseBASSStream(SCRIPT_MENU);
-            WriteToSoundPlayerLog("Menu stream paused", __LINE__);
-        }
-
-        if (g_specificWasActiveBeforePause) {
-            PauseBASSStream(SCRIPT_SPECIFIC);
-            WriteToSoundPlayerLog("Specific stream paused", __LINE__);
-        }
-
-        if (g_soundMenuKeyWasActiveBeforePause) {
-            PauseBASSStream(SCRIPT_CHECK);
-            g_soundMenuKeyPaused = true;
-            WriteToSoundPlayerLog("SoundMenuKey stream paused", __LINE__);
-        }
-
-        if (g_effectWasActiveBeforePause) {
-            PauseBASSStream(SCRIPT_EFFECT);
-            WriteToSoundPlayerLog("Effect stream paused", __LINE__);
-        }
-
-        if (g_tagWasActiveBeforePause) {
-            PauseBASSStream(SCRIPT_TAG);
-            WriteToSoundPlayerLog("Tag stream paused", __LINE__);
-        }
-
-        g_positionLayersActiveBeforePause.clear();
-        int totalPositionStreams = 0;
-        
-        for (auto& [fragment, layers] : g_positionStreams) {
-            for (auto& [layerNum, stream] : layers) {
-                if (stream && pBASS_ChannelPause) {
-                    pBASS_ChannelPause(stream);
-                    g_positionLayersActiveBeforePause[fragment][layerNum] = true;
-                    totalPositionStreams++;
-                }
-            }
-        }
-        
-        if (totalPositionStreams > 0) {
-            WriteToSoundPlayerLog("Position streams paused: " + std::to_string(totalPositionStreams) + 
-                                 " streams across " + std::to_string(g_positionStreams.size()) + " fragments", __LINE__);
-        }
-
-        logger::info("BASS: ALL streams paused (Base, Menu, Specific, SoundMenuKey, Effect, Tag, Position x{})", totalPositionStreams);
+        // The author preview stays audible: it is what the player is listening to in the menu.
+        WriteToSoundPlayerLog("PAUSING ALL SOUNDS (OStim + Menu groups)", __LINE__);
+        PauseChannelGroups(kGroupOStim | kGroupMenu, g_pauseFadeMs.load());
+        logger::info("BASS: OStim and Menu groups paused");
     }
 }
 
@@ -3270,69 +7399,38 @@ void ResumeAllSounds() {
     if (g_soundsPaused.load()) {
         g_soundsPaused = false;
 
-        WriteToSoundPlayerLog("RESUMING ALL SOUNDS (BASS + MULTI-LAYER POSITION)", __LINE__);
-
-        if (g_baseWasActiveBeforePause && g_baseStream) {
-            ResumeBASSStream(SCRIPT_BASE);
-            WriteToSoundPlayerLog("Base stream resumed", __LINE__);
-        }
-
-        if (g_menuWasActiveBeforePause && g_menuStream) {
-            ResumeBASSStream(SCRIPT_MENU);
-            WriteToSoundPlayerLog("Menu stream resumed", __LINE__);
-        }
-
-        if (g_specificWasActiveBeforePause && g_specificStream) {
-            ResumeBASSStream(SCRIPT_SPECIFIC);
-            WriteToSoundPlayerLog("Specific stream resumed", __LINE__);
-        }
-
-        if (g_soundMenuKeyWasActiveBeforePause && g_soundMenuKeyStream) {
-            if (g_soundMenuKeyMode != SoundMenuKeyMode::DISABLED) {
-                ResumeBASSStream(SCRIPT_CHECK);
-                g_soundMenuKeyPaused = false;
-                WriteToSoundPlayerLog("SoundMenuKey stream resumed", __LINE__);
-            } else {
-                WriteToSoundPlayerLog("SoundMenuKey NOT resumed (disabled in INI)", __LINE__);
-            }
-        }
-
-        if (g_effectWasActiveBeforePause && g_effectStream) {
-            ResumeBASSStream(SCRIPT_EFFECT);
-            WriteToSoundPlayerLog("Effect stream resumed", __LINE__);
-        }
-
-        if (g_tagWasActiveBeforePause && g_tagStream) {
-            ResumeBASSStream(SCRIPT_TAG);
-            WriteToSoundPlayerLog("Tag stream resumed", __LINE__);
-        }
-
-        int resumedPositionStreams = 0;
-        for (const auto& [fragment, layers] : g_positionLayersActiveBeforePause) {
-            for (const auto& [layerNum, wasActive] : layers) {
-                if (wasActive) {
-                    auto fragIt = g_positionStreams.find(fragment);
-                    if (fragIt != g_positionStreams.end()) {
-                        auto layerIt = fragIt->second.find(layerNum);
-                        if (layerIt != fragIt->second.end() && layerIt->second && pBASS_ChannelPlay) {
-                            pBASS_ChannelPlay(layerIt->second, FALSE);
-                            resumedPositionStreams++;
-                        }
-                    }
-                }
-            }
-        }
-        
-        if (resumedPositionStreams > 0) {
-            WriteToSoundPlayerLog("Position streams resumed: " + std::to_string(resumedPositionStreams), __LINE__);
-        }
+        WriteToSoundPlayerLog("RESUMING ALL SOUNDS (OStim + Menu groups)", __LINE__);
+        ResumeChannelGroups(kGroupOStim | kGroupMenu, g_pauseFadeMs.load());
+        logger::info("BASS: OStim and Menu groups resumed");
+    }
+}
 
-        logger::info("BASS: All streams resumed");
+// Animation IDs are only stable within one SoundTables generation; after a reload the
+// current family/specific IDs are looked up again by name and throttles start fresh.
+void SyncAnimationState(SceneContext& scene, const SoundTables& tables) {
+    if (scene.animationStateGeneration == tables.generation) return;
+    
+    auto remap = [&tables](const std::string& name) {
+        if (name.empty()) return kNoAnimationId;
+        uint32_t id = tables.FindAnimationId(name);
+        return id != kNoAnimationId ? id : kStaleAnimationId;
+    };
+    
+    scene.currentFamilyId = remap(scene.currentBaseAnimation);
+    scene.currentSpecificId = remap(scene.currentSpecificAnimation);
+    
+    {
+        std::lock_guard<std::mutex> lock(g_throttleMutex);
+        scene.lastPlayTimes.assign(tables.animationEntries.size(), std::chrono::steady_clock::time_point{});
     }
+    
+    scene.animationStateGeneration = tables.generation;
 }
 
-void CheckAndPlaySound(const std::string& animationName) {
+// A mixed scene plays into its own output and leaves the SoundMenuKey to the live one.
+void CheckAndPlaySound(SceneContext& scene, const std::string& animationName) {
     if (!g_isInitialized || g_isShuttingDown.load()) return;
+    SceneOutputScope scope(scene);
 
     try {
         if (!g_bassInitialized) {
@@ -3342,64 +7440,74 @@ void CheckAndPlaySound(const std::string& animationName) {
             }
         }
 
-        std::string baseAnimation = GetAnimationBase(animationName);
+        auto tables = GetSoundTables();
+        SyncAnimationState(scene, *tables);
 
-        if (baseAnimation != g_currentBaseAnimation) {
-            logger::info("Base animation changed from '{}' to '{}'", g_currentBaseAnimation, baseAnimation);
-            
-            auto baseIt = g_animationSoundMap.find(baseAnimation);
-            
-            if (baseIt != g_animationSoundMap.end()) {
-                if (!baseIt->second.soundOptions.empty()) {
-                    int randomIndex = rand() % baseIt->second.soundOptions.size();
-                    const auto& chosen = baseIt->second.soundOptions[randomIndex];
+        uint32_t animationId = tables->FindAnimationId(animationName);
+        uint32_t familyId = animationId != kNoAnimationId
+                                ? tables->animationEntries[animationId].familyId
+                                : tables->FindAnimationId(GetAnimationBaseView(animationName));
+
+        if (familyId != scene.currentFamilyId) {
+            if (familyId != kNoAnimationId) {
+                const auto& family = tables->animationEntries[familyId];
+                const std::string& baseAnimation = tables->animationNames[familyId];
+                logger::info("Base animation changed from '{}' to '{}'", scene.currentBaseAnimation, baseAnimation);
+                
+                if (family.optionCount > 0) {
+                    uint32_t randomIndex = static_cast<uint32_t>(rand()) % family.optionCount;
+                    const auto& chosen = tables->animationOptions[family.optionOffset + randomIndex];
                     
                     logger::info("BASE SOUND: Starting '{}' for animation family '{}'",
                                  chosen.soundFile, baseAnimation);
                     WriteToSoundPlayerLog("BASE SOUND: " + chosen.soundFile +
                                           " (random " + std::to_string(randomIndex + 1) + 
-                                          "/" + std::to_string(baseIt->second.soundOptions.size()) + 
+                                          "/" + std::to_string(family.optionCount) + 
                                           ") for family " + baseAnimation, __LINE__);
                     PlayBASSSound(chosen.soundFile, SCRIPT_BASE, true);
-                    g_currentBaseAnimation = baseAnimation;
+                    scene.currentFamilyId = familyId;
+                    scene.currentBaseAnimation = baseAnimation;
                     
-                    PauseSoundMenuKey();
+                    if (!scene.output) PauseSoundMenuKey();
                 }
             } else {
-                if (!g_currentBaseAnimation.empty()) {
+                if (scene.currentFamilyId != kNoAnimationId) {
+                    std::string baseAnimation(GetAnimationBaseView(animationName));
                     logger::info("No base sound for family '{}', stopping base stream", baseAnimation);
                     WriteToSoundPlayerLog("BASE SOUND STOPPED (no mapping for " + baseAnimation + ")", __LINE__);
                     StopBASSStream(SCRIPT_BASE);
                     
-                    ResumeSoundMenuKey();
+                    if (!scene.output) ResumeSoundMenuKey();
                 }
-                g_currentBaseAnimation = baseAnimation;
+                scene.currentFamilyId = kNoAnimationId;
+                scene.currentBaseAnimation.clear();
             }
         }
 
-        auto specificIt = g_animationSoundMap.find(animationName);
-
-        if (specificIt != g_animationSoundMap.end()) {
-            if (animationName != g_currentSpecificAnimation) {
-                if (!specificIt->second.soundOptions.empty()) {
-                    int randomIndex = rand() % specificIt->second.soundOptions.size();
-                    const auto& chosen = specificIt->second.soundOptions[randomIndex];
+        if (animationId != kNoAnimationId) {
+            const auto& entry = tables->animationEntries[animationId];
+            
+            if (animationId != scene.currentSpecificId) {
+                if (entry.optionCount > 0) {
+                    uint32_t randomIndex = static_cast<uint32_t>(rand()) % entry.optionCount;
+                    const auto& chosen = tables->animationOptions[entry.optionOffset + randomIndex];
                     
                     WriteToSoundPlayerLog("SPECIFIC SOUND: " + chosen.soundFile +
                                           " (random " + std::to_string(randomIndex + 1) + 
-                                          "/" + std::to_string(specificIt->second.soundOptions.size()) + 
+                                          "/" + std::to_string(entry.optionCount) + 
                                           ") for " + animationName, __LINE__);
                     PlayBASSSound(chosen.soundFile, SCRIPT_SPECIFIC, true);
-                    g_currentSpecificAnimation = animationName;
+                    scene.currentSpecificId = animationId;
+                    scene.currentSpecificAnimation = tables->animationNames[animationId];
                 }
             } else {
                 std::lock_guard<std::mutex> lock(g_throttleMutex);
                 auto now = std::chrono::steady_clock::now();
-                auto lastPlayIt = g_lastPlayTime.find(animationName);
+                auto& lastPlay = scene.lastPlayTimes[animationId];
 
-                if (lastPlayIt != g_lastPlayTime.end()) {
-                    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - lastPlayIt->second).count();
-                    int delayRequired = specificIt->second.repeatDelaySeconds;
+                if (lastPlay != std::chrono::steady_clock::time_point{}) {
+                    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - lastPlay).count();
+                    int delayRequired = entry.repeatDelaySeconds;
 
                     if (delayRequired > 0 && elapsed < delayRequired) {
                         WriteToSoundPlayerLog("THROTTLED: sound for " + animationName +
@@ -3408,173 +7516,205 @@ void CheckAndPlaySound(const std::string& animationName) {
                     }
                 }
 
-                if (!specificIt->second.soundOptions.empty()) {
-                    int randomIndex = rand() % specificIt->second.soundOptions.size();
-                    const auto& chosen = specificIt->second.soundOptions[randomIndex];
+                if (entry.optionCount > 0) {
+                    uint32_t randomIndex = static_cast<uint32_t>(rand()) % entry.optionCount;
+                    const auto& chosen = tables->animationOptions[entry.optionOffset + randomIndex];
                     
                     WriteToSoundPlayerLog("SPECIFIC SOUND RESTART: " + chosen.soundFile +
                                          " (random " + std::to_string(randomIndex + 1) + 
-                                         "/" + std::to_string(specificIt->second.soundOptions.size()) + 
+                                         "/" + std::to_string(entry.optionCount) + 
                                          ") for " + animationName + " [delay cleared]", __LINE__);
                     PlayBASSSound(chosen.soundFile, SCRIPT_SPECIFIC, true);
-                    g_lastPlayTime[animationName] = now;
+                    lastPlay = now;
                 }
             }
             
         } else {
-            if (!g_currentSpecificAnimation.empty()) {
+            if (scene.currentSpecificId != kNoAnimationId) {
                 logger::info("No specific sound for '{}', stopping specific stream", animationName);
                 WriteToSoundPlayerLog("SPECIFIC SOUND STOPPED (no mapping)", __LINE__);
                 StopBASSStream(SCRIPT_SPECIFIC);
             }
-            g_currentSpecificAnimation = "";
+            scene.currentSpecificId = kNoAnimationId;
+            scene.currentSpecificAnimation.clear();
         }
         
-        CheckPositionSound(animationName);
+        CheckPositionSound(scene, animationName, *tables);
         
     } catch (...) {
         logger::error("Error in CheckAndPlaySound");
     }
 }
 
-void CheckPositionSound(const std::string& animationName) {
-    if (g_positionSoundMap.empty()) return;
-    
-    std::string animationLower = ToLowerCase(animationName);
-    
-    std::set<std::string> matchedFragments;
-    
-    for (const auto& [fragment, config] : g_positionSoundMap) {
-        std::string fragmentLower = ToLowerCase(fragment);
-        
-        if (animationLower.find(fragmentLower) != std::string::npos) {
-            matchedFragments.insert(fragment);
+void StopPositionFragment(const std::string& fragment) {
+    std::lock_guard<std::mutex> lock(g_bassMutex);
+    auto& positionStreams = Output().positionStreams;
+    auto fragIt = positionStreams.find(fragment);
+    if (fragIt != positionStreams.end()) {
+        for (auto& [layer, stream] : fragIt->second) {
+            if (stream) {
+                Audio()->Stop(stream);
+                Audio()->Free(stream);
+                stream = 0;
+            }
         }
+        positionStreams.erase(fragIt);
     }
-    
-    std::vector<std::string> toRemove;
-    for (const auto& activeFragment : g_activePositionFragments) {
-        if (matchedFragments.find(activeFragment) == matchedFragments.end()) {
-            if (g_positionStreams.find(activeFragment) != g_positionStreams.end()) {
-                for (auto& [layer, stream] : g_positionStreams[activeFragment]) {
-                    if (stream) {
-                        if (pBASS_ChannelStop) pBASS_ChannelStop(stream);
-                        if (pBASS_StreamFree) pBASS_StreamFree(stream);
-                        stream = 0;
-                    }
+    WriteToSoundPlayerLog("POSITION: Stopped fragment '" + fragment + "'", __LINE__);
+}
+
+void StartPositionFragment(const std::string& fragment, const SoundConfigMultiple& config) {
+    if (!config.layers.empty()) {
+        for (const auto& [layerNum, sounds] : config.layers) {
+            if (sounds.empty()) continue;
+            
+            int randomIndex = rand() % sounds.size();
+            const auto& chosen = sounds[randomIndex];
+            
+            fs::path soundPath = FindSoundFile(chosen.soundFile);
+            if (soundPath.empty()) {
+                WriteToSoundPlayerLog("POSITION ERROR: Sound not found: " + chosen.soundFile, __LINE__);
+                continue;
+            }
+            
+            if (!g_bassInitialized) {
+                if (!InitializeBASSLibrary()) continue;
+            }
+            
+            AudioHandle newStream = CreateBASSChannel(soundPath, true);
+            
+            if (!newStream) {
+                int error = Audio()->LastError();
+                WriteToSoundPlayerLog("POSITION ERROR: Stream creation failed, error " + std::to_string(error), __LINE__);
+                continue;
+            }
+            
+            std::lock_guard<std::mutex> lock(g_bassMutex);
+            
+            if (!AdmitVoiceLocked(PositionLayerVoicePriority(layerNum), 0, false,
+                                  "position '" + fragment + "' layer " + std::to_string(layerNum))) {
+                Audio()->Free(newStream);
+                continue;
+            }
+            
+            Audio()->SetLevel(newStream, PositionLayerVolume());
+            
+            if (!Audio()->Play(newStream)) {
+                Audio()->Free(newStream);
+                continue;
+            }
+            
+            Output().positionStreams[fragment][layerNum] = newStream;
+            HoldStreamForPausedGroup(kGroupOStim, newStream);
+            
+            WriteToSoundPlayerLog("POSITION: Playing '" + chosen.soundFile + 
+                                 "' [Fragment: '" + fragment + "', Layer: " + std::to_string(layerNum) + "]", __LINE__);
+            
+            if (layerNum == 0) {
+                std::string displayName = chosen.soundFile;
+                size_t dotPos = displayName.find_last_of('.');
+                if (dotPos != std::string::npos) {
+                    displayName = displayName.substr(0, dotPos);
                 }
-                g_positionStreams.erase(activeFragment);
+                ShowGameNotification("OSoundtracks - \"" + displayName + "\" is played");
             }
-            toRemove.push_back(activeFragment);
-            WriteToSoundPlayerLog("POSITION: Stopped fragment '" + activeFragment + "'", __LINE__);
         }
     }
-    
-    for (const auto& frag : toRemove) {
-        g_activePositionFragments.erase(frag);
-    }
-    
-    for (const auto& fragment : matchedFragments) {
-        bool isNewFragment = (g_activePositionFragments.find(fragment) == g_activePositionFragments.end());
+    else if (!config.soundOptions.empty()) {
+        int randomIndex = rand() % config.soundOptions.size();
+        const auto& chosen = config.soundOptions[randomIndex];
         
-        if (isNewFragment) {
-            const auto& config = g_positionSoundMap[fragment];
+        fs::path soundPath = FindSoundFile(chosen.soundFile);
+        if (!soundPath.empty() && g_bassInitialized) {
+            AudioHandle newStream = CreateBASSChannel(soundPath, true);
             
-            if (!config.layers.empty()) {
-                for (const auto& [layerNum, sounds] : config.layers) {
-                    if (sounds.empty()) continue;
-                    
-                    int randomIndex = rand() % sounds.size();
-                    const auto& chosen = sounds[randomIndex];
-                    
-                    fs::path soundPath = FindSoundFile(chosen.soundFile);
-                    if (soundPath.empty()) {
-                        WriteToSoundPlayerLog("POSITION ERROR: Sound not found: " + chosen.soundFile, __LINE__);
-                        continue;
-                    }
-                    
-                    if (!g_bassInitialized) {
-                        if (!InitializeBASSLibrary()) continue;
-                    }
-                    
-                    std::lock_guard<std::mutex> lock(g_bassMutex);
-                    
-                    HSTREAM newStream = pBASS_StreamCreateFile(
-                        FALSE,
-                        soundPath.wstring().c_str(),
-                        0, 0,
-                        BASS_UNICODE | BASS_SAMPLE_LOOP
-                    );
-                    
-                    if (!newStream) {
-                        int error = pBASS_ErrorGetCode ? pBASS_ErrorGetCode() : -1;
-                        WriteToSoundPlayerLog("POSITION ERROR: Stream creation failed, error " + std::to_string(error), __LINE__);
-                        continue;
-                    }
-                    
-                    float volume = g_volumeControlEnabled.load() ? g_positionVolume.load() : 1.0f;
-                    if (pBASS_ChannelSetAttribute) {
-                        pBASS_ChannelSetAttribute(newStream, BASS_ATTRIB_VOL, volume);
-                    }
-                    
-                    if (!pBASS_ChannelPlay(newStream, FALSE)) {
-                        if (pBASS_StreamFree) pBASS_StreamFree(newStream);
-                        continue;
-                    }
-                    
-                    g_positionStreams[fragment][layerNum] = newStream;
-                    
-                    WriteToSoundPlayerLog("POSITION: Playing '" + chosen.soundFile + 
-                                         "' [Fragment: '" + fragment + "', Layer: " + std::to_string(layerNum) + "]", __LINE__);
-                    
-                    if (layerNum == 0) {
-                        std::string displayName = chosen.soundFile;
-                        size_t dotPos = displayName.find_last_of('.');
-                        if (dotPos != std::string::npos) {
-                            displayName = displayName.substr(0, dotPos);
-                        }
-                        ShowGameNotification("OSoundtracks - \"" + displayName + "\" is played");
-                    }
+            if (newStream) {
+                std::lock_guard<std::mutex> lock(g_bassMutex);
+                
+                if (!AdmitVoiceLocked(PositionLayerVoicePriority(0), 0, false, "position '" + fragment + "'")) {
+                    Audio()->Free(newStream);
+                    return;
                 }
-            }
-            else if (!config.soundOptions.empty()) {
-                int randomIndex = rand() % config.soundOptions.size();
-                const auto& chosen = config.soundOptions[randomIndex];
                 
-                fs::path soundPath = FindSoundFile(chosen.soundFile);
-                if (!soundPath.empty() && g_bassInitialized) {
-                    std::lock_guard<std::mutex> lock(g_bassMutex);
-                    
-                    HSTREAM newStream = pBASS_StreamCreateFile(
-                        FALSE,
-                        soundPath.wstring().c_str(),
-                        0, 0,
-                        BASS_UNICODE | BASS_SAMPLE_LOOP
-                    );
-                    
-                    if (newStream) {
-                        float volume = g_volumeControlEnabled.load() ? g_positionVolume.load() : 1.0f;
-                        if (pBASS_ChannelSetAttribute) {
-                            pBASS_ChannelSetAttribute(newStream, BASS_ATTRIB_VOL, volume);
-                        }
-                        
-                        if (pBASS_ChannelPlay(newStream, FALSE)) {
-                            g_positionStreams[fragment][0] = newStream;
-                            WriteToSoundPlayerLog("POSITION: Playing '" + chosen.soundFile + 
-                                                 "' [Fragment: '" + fragment + "']", __LINE__);
-                        }
-                    }
+                Audio()->SetLevel(newStream, PositionLayerVolume());
+                
+                if (Audio()->Play(newStream)) {
+                    Output().positionStreams[fragment][0] = newStream;
+                    HoldStreamForPausedGroup(kGroupOStim, newStream);
+                    WriteToSoundPlayerLog("POSITION: Playing '" + chosen.soundFile + 
+                                         "' [Fragment: '" + fragment + "']", __LINE__);
                 }
             }
-            
-            g_activePositionFragments.insert(fragment);
         }
     }
 }
 
+// Fragment IDs are only stable within one SoundTables generation; after a JSON reload
+// the active bitset is rebuilt from the fragment names that still have streams.
+void RemapActivePositionFragments(SceneContext& scene, const SoundTables& tables) {
+    scene.activePositionFragments.Resize(tables.positionFragments.size());
+    
+    std::vector<std::string> orphaned;
+    for (const auto& [fragment, layers] : Output().positionStreams) {
+        auto idIt = tables.positionFragmentIds.find(fragment);
+        if (idIt != tables.positionFragmentIds.end()) {
+            scene.activePositionFragments.Set(idIt->second);
+        } else {
+            orphaned.push_back(fragment);
+        }
+    }
+    
+    for (const auto& fragment : orphaned) {
+        StopPositionFragment(fragment);
+    }
+    
+    scene.activePositionGeneration = tables.generation;
+}
+
+void CheckPositionSound(SceneContext& scene, const std::string& animationName, const SoundTables& tables) {
+    if (tables.positionFragments.empty() && Output().positionStreams.empty()) return;
+    
+    uint64_t epoch = Output().positionStreamsEpoch.load();
+    if (scene.positionEpoch != epoch) {
+        scene.activePositionFragments.Clear();
+        scene.positionEpoch = epoch;
+    }
+    
+    if (scene.activePositionGeneration != tables.generation ||
+        scene.activePositionFragments.words.size() != (tables.positionFragments.size() + 63) / 64) {
+        RemapActivePositionFragments(scene, tables);
+    }
+    
+    static FragmentSet matchedFragments;
+    matchedFragments.Resize(tables.positionFragments.size());
+    tables.positionMatcher.Match(animationName, matchedFragments);
+    
+    auto& active = scene.activePositionFragments.words;
+    const auto& matched = matchedFragments.words;
+    
+    for (size_t w = 0; w < active.size(); ++w) {
+        uint64_t stopped = active[w] & ~matched[w];
+        while (stopped) {
+            size_t id = w * 64 + static_cast<size_t>(std::countr_zero(stopped));
+            StopPositionFragment(tables.positionFragments[id]);
+            stopped &= stopped - 1;
+        }
+        
+        uint64_t started = matched[w] & ~active[w];
+        while (started) {
+            size_t id = w * 64 + static_cast<size_t>(std::countr_zero(started));
+            StartPositionFragment(tables.positionFragments[id], *tables.positionConfigs[id]);
+            started &= started - 1;
+        }
+        
+        active[w] = matched[w];
+    }
+}
+
 void PlayMenuSound(const std::string& menuName) {
-    auto soundIt = g_animationSoundMap.find(menuName);
-    if (soundIt == g_animationSoundMap.end()) {
+    auto tables = GetSoundTables();
+    auto soundIt = tables->animation.find(menuName);
+    if (soundIt == tables->animation.end()) {
         return;
     }
 
@@ -3590,13 +7730,13 @@ void PlayMenuSound(const std::string& menuName) {
 }
 
 void StopMenuSound(const std::string& menuName) {
-    if (g_menuStream) {
+    if (GetChannel(SCRIPT_MENU)->IsActive()) {
         StopBASSStream(SCRIPT_MENU);
         WriteToSoundPlayerLog("BASS: Menu stream stopped", __LINE__);
         logger::info("BASS: Stopped menu sound for: {}", menuName);
     }
 
-    if (!g_baseStream && g_soundMenuKeyActive.load()) {
+    if (!GetChannel(SCRIPT_BASE)->IsActive() && g_soundMenuKeyActive.load()) {
         ResumeSoundMenuKey();
     }
 }
@@ -3616,12 +7756,8 @@ void StopAuthorPreview() {
         std::lock_guard<std::mutex> lock(g_bassMutex);
         
         if (g_authorPreviewStream) {
-            if (pBASS_ChannelStop) {
-                pBASS_ChannelStop(g_authorPreviewStream);
-            }
-            if (pBASS_StreamFree) {
-                pBASS_StreamFree(g_authorPreviewStream);
-            }
+            Audio()->Stop(g_authorPreviewStream);
+            Audio()->Free(g_authorPreviewStream);
             g_authorPreviewStream = 0;
         }
     }
@@ -3664,8 +7800,9 @@ void StartPreviewTimer(const std::string& authorName, const std::string& songNam
 }
 
 void PlayAuthorPreview(const std::string& authorName) {
-    auto it = g_soundMenuKeyMap.find(authorName);
-    if (it == g_soundMenuKeyMap.end()) {
+    auto tables = GetSoundTables();
+    auto it = tables->soundMenuKey.find(authorName);
+    if (it == tables->soundMenuKey.end()) {
         WriteToSoundPlayerLog("PREVIEW: Author '" + authorName + "' not found in JSON", __LINE__);
         return;
     }
@@ -3706,111 +7843,256 @@ void PlayAuthorPreview(const std::string& authorName) {
         std::lock_guard<std::mutex> lock(g_bassMutex);
         
         if (g_authorPreviewStream) {
-            if (pBASS_ChannelStop) pBASS_ChannelStop(g_authorPreviewStream);
-            if (pBASS_StreamFree) pBASS_StreamFree(g_authorPreviewStream);
+            Audio()->Stop(g_authorPreviewStream);
+            Audio()->Free(g_authorPreviewStream);
             g_authorPreviewStream = 0;
         }
         
-        g_authorPreviewStream = pBASS_StreamCreateFile(
-            FALSE,
-            soundPath.wstring().c_str(),
-            0, 0,
-            BASS_UNICODE
-        );
+        g_authorPreviewStream = Audio()->OpenStream(soundPath, false);
         
         if (!g_authorPreviewStream) {
-            int error = pBASS_ErrorGetCode ? pBASS_ErrorGetCode() : -1;
+            int error = Audio()->LastError();
             WriteToSoundPlayerLog("PREVIEW ERROR: Failed to create BASS stream, error " + std::to_string(error), __LINE__);
             return;
         }
         
         float previewVolume = 1.0f;
         
-        if (pBASS_ChannelSetAttribute) {
-            pBASS_ChannelSetAttribute(g_authorPreviewStream, BASS_ATTRIB_VOL, previewVolume);
+        Audio()->SetLevel(g_authorPreviewStream, previewVolume);
+        Audio()->SetTrim(g_authorPreviewStream, LoudnessTrimFor(soundPath));
+        
+        if (!Audio()->Play(g_authorPreviewStream)) {
+            int error = Audio()->LastError();
+            WriteToSoundPlayerLog("PREVIEW ERROR: Failed to play stream, error " + std::to_string(error), __LINE__);
+            return;
+        }
+        HoldStreamForPausedGroup(kGroupPreview, g_authorPreviewStream);
+    }
+    
+    g_previewPlaying = true;
+    
+    StartPreviewTimer(authorName, previewSong);
+    
+    std::string displayName = previewSong;
+    size_t dotPos = displayName.find_last_of('.');
+    if (dotPos != std::string::npos) {
+        displayName = displayName.substr(0, dotPos);
+    }
+    
+    ShowGameNotification("OSoundtracks PREVIEW - Author: " + authorName);
+    ShowGameNotification("Song: \"" + displayName + "\" (7s sample)");
+}
+
+// Saved playlist positions, one line per mode/author: key|fingerprint|seed|cursor.
+// A playlist resumes only if its track list still hashes to the same fingerprint.
+std::string SoundMenuKeyStateKey() {
+    switch (g_soundMenuKeyMode) {
+        case SoundMenuKeyMode::ALL_ORDER: return "all_order";
+        case SoundMenuKeyMode::ALL_RANDOM: return "all_random";
+        case SoundMenuKeyMode::ALL_WEIGHTED: return "all_weighted";
+        case SoundMenuKeyMode::AUTHOR_ORDER: return "author_order|" + g_soundMenuKeyAuthor;
+        case SoundMenuKeyMode::AUTHOR_RANDOM: return "author_random|" + g_soundMenuKeyAuthor;
+        default: return "disabled";
+    }
+}
+
+void LoadSoundMenuKeyStates() {
+    g_soundMenuKeyStatesLoaded = true;
+    g_soundMenuKeyStatePath = g_iniPath.parent_path() / "OSoundtracks-SA-Expansion-Sounds-NG-Playlist.txt";
+    
+    std::ifstream file(g_soundMenuKeyStatePath);
+    if (!file.is_open()) {
+        return;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        
+        size_t cursorSep = line.rfind('|');
+        size_t seedSep = cursorSep != std::string::npos && cursorSep > 0 ? line.rfind('|', cursorSep - 1) : std::string::npos;
+        size_t fingerprintSep = seedSep != std::string::npos && seedSep > 0 ? line.rfind('|', seedSep - 1) : std::string::npos;
+        if (fingerprintSep == std::string::npos || fingerprintSep == 0) continue;
+        
+        try {
+            SoundMenuKeyPlaylistState state;
+            state.fingerprint = std::stoull(line.substr(fingerprintSep + 1, seedSep - fingerprintSep - 1));
+            state.seed = std::stoull(line.substr(seedSep + 1, cursorSep - seedSep - 1));
+            state.cursor = std::stoull(line.substr(cursorSep + 1));
+            g_soundMenuKeyStates[line.substr(0, fingerprintSep)] = state;
+        } catch (...) {
+        }
+    }
+}
+
+// Writes the states if an advance changed them since the last save. Takes
+// g_soundMenuKeyMutex only to copy them out.
+void SaveSoundMenuKeyStates() {
+    std::string contents;
+    fs::path statePath;
+    {
+        std::lock_guard<std::mutex> lock(g_soundMenuKeyMutex);
+        if (!g_soundMenuKeyStatesDirty || g_soundMenuKeyStatePath.empty()) return;
+        g_soundMenuKeyStatesDirty = false;
+        statePath = g_soundMenuKeyStatePath;
+        for (const auto& [key, state] : g_soundMenuKeyStates) {
+            contents += key + "|" + std::to_string(state.fingerprint) + "|" + std::to_string(state.seed) + "|" +
+                        std::to_string(state.cursor) + "\n";
         }
-        
-        if (!pBASS_ChannelPlay(g_authorPreviewStream, FALSE)) {
-            int error = pBASS_ErrorGetCode ? pBASS_ErrorGetCode() : -1;
-            WriteToSoundPlayerLog("PREVIEW ERROR: Failed to play stream, error " + std::to_string(error), __LINE__);
-            return;
+    }
+    
+    try {
+        fs::path tempPath = statePath;
+        tempPath += ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc | std::ios::binary);
+            if (!file.is_open()) return;
+            file << contents;
+        }
+        fs::rename(tempPath, statePath);
+    } catch (...) {
+        logger::warn("Could not save SoundMenuKey playlist state");
+    }
+}
+
+// Caller holds g_soundMenuKeyMutex.
+void ResetSoundMenuKeyPlaylist(const SoundTables& tables) {
+    g_soundMenuKeyGeneration = tables.generation;
+    g_soundMenuKeyReserved = false;
+    g_soundMenuKeyFirstTrack = 0;
+    uint32_t count = 0;
+    
+    if (g_soundMenuKeyMode == SoundMenuKeyMode::AUTHOR_ORDER || g_soundMenuKeyMode == SoundMenuKeyMode::AUTHOR_RANDOM) {
+        auto it = tables.soundMenuKeyRanges.find(g_soundMenuKeyAuthor);
+        if (it != tables.soundMenuKeyRanges.end()) {
+            g_soundMenuKeyFirstTrack = it->second.first;
+            count = it->second.second;
+        } else {
+            WriteToSoundPlayerLog("SoundMenuKey: Author '" + g_soundMenuKeyAuthor + "' not found in JSON", __LINE__);
         }
+    } else if (g_soundMenuKeyMode != SoundMenuKeyMode::DISABLED) {
+        count = static_cast<uint32_t>(tables.soundMenuKeyTracks.size());
     }
     
-    g_previewPlaying = true;
+    uint64_t fingerprint = 1469598103934665603ull;
+    for (uint32_t id = 0; id < count; ++id) {
+        for (char c : tables.soundMenuKeyTracks[g_soundMenuKeyFirstTrack + id]) {
+            fingerprint = (fingerprint ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        fingerprint = (fingerprint ^ 0xFF) * 1099511628211ull;
+    }
+    g_soundMenuKeyFingerprint = fingerprint;
     
-    StartPreviewTimer(authorName, previewSong);
+    PlaylistOrder order = PlaylistOrder::Sequential;
+    std::vector<double> weights;
+    if (g_soundMenuKeyMode == SoundMenuKeyMode::ALL_RANDOM || g_soundMenuKeyMode == SoundMenuKeyMode::AUTHOR_RANDOM) {
+        order = PlaylistOrder::Shuffle;
+    } else if (g_soundMenuKeyMode == SoundMenuKeyMode::ALL_WEIGHTED) {
+        // Every author gets the same share of airtime regardless of library size.
+        order = PlaylistOrder::Weighted;
+        weights.resize(count);
+        for (const auto& [author, range] : tables.soundMenuKeyRanges) {
+            for (uint32_t id = range.first; id < range.first + range.second; ++id) {
+                weights[id] = 1.0 / range.second;
+            }
+        }
+    }
     
-    std::string displayName = previewSong;
-    size_t dotPos = displayName.find_last_of('.');
-    if (dotPos != std::string::npos) {
-        displayName = displayName.substr(0, dotPos);
+    g_soundMenuKeyStateKey = SoundMenuKeyStateKey();
+    auto saved = g_soundMenuKeyStates.find(g_soundMenuKeyStateKey);
+    if (saved != g_soundMenuKeyStates.end() && saved->second.fingerprint == fingerprint && count > 0) {
+        g_soundMenuKeyPlaylist.Reset(count, order, saved->second.seed, g_soundMenuKeyNoRepeat.load(), weights);
+        g_soundMenuKeyPlaylist.Restore(saved->second.cursor);
+        WriteToSoundPlayerLog("SoundMenuKey: Playlist resumed with " + std::to_string(count) + " tracks at " +
+                             std::to_string(saved->second.cursor % count) + "/" + std::to_string(count), __LINE__);
+        return;
     }
     
-    ShowGameNotification("OSoundtracks PREVIEW - Author: " + authorName);
-    ShowGameNotification("Song: \"" + displayName + "\" (7s sample)");
+    std::random_device rd;
+    uint64_t seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    g_soundMenuKeyPlaylist.Reset(count, order, seed, g_soundMenuKeyNoRepeat.load(), weights);
+    WriteToSoundPlayerLog("SoundMenuKey: Playlist built with " + std::to_string(count) + " tracks", __LINE__);
 }
 
 void BuildSoundMenuKeyPlaylist() {
+    auto tables = GetSoundTables();
     std::lock_guard<std::mutex> lock(g_soundMenuKeyMutex);
-    g_soundMenuKeyPlaylist.clear();
-    g_soundMenuKeyCurrentIndex = 0;
     
-    if (g_soundMenuKeyMode == SoundMenuKeyMode::DISABLED) {
-        return;
+    if (!g_soundMenuKeyStatesLoaded) {
+        LoadSoundMenuKeyStates();
+    }
+    ResetSoundMenuKeyPlaylist(*tables);
+}
+
+// Makes the next advance rebuild the playlist from the current mode, as a sound table
+// reload does, without touching the track that is playing.
+void InvalidateSoundMenuKeyPlaylist() {
+    std::lock_guard<std::mutex> lock(g_soundMenuKeyMutex);
+    g_soundMenuKeyGeneration = ~uint64_t{0};
+}
+
+// With reserve set (the gapless preload) the draw stays provisional until
+// ReleaseSoundMenuKeyReservation; a manual advance meanwhile draws the same track again.
+std::string AdvanceSoundMenuKeyPlaylist(size_t& position, size_t& total, bool reserve) {
+    auto tables = GetSoundTables();
+    std::lock_guard<std::mutex> lock(g_soundMenuKeyMutex);
+    
+    if (g_soundMenuKeyPlaylist.Size() == 0 || !g_soundMenuKeyActive.load()) {
+        return std::string();
     }
     
-    if (g_soundMenuKeyMode == SoundMenuKeyMode::ALL_ORDER || g_soundMenuKeyMode == SoundMenuKeyMode::ALL_RANDOM) {
-        for (const auto& [author, songs] : g_soundMenuKeyMap) {
-            for (const auto& song : songs) {
-                g_soundMenuKeyPlaylist.push_back(song.soundFile);
-            }
-        }
-    } else if (g_soundMenuKeyMode == SoundMenuKeyMode::AUTHOR_ORDER || g_soundMenuKeyMode == SoundMenuKeyMode::AUTHOR_RANDOM) {
-        auto it = g_soundMenuKeyMap.find(g_soundMenuKeyAuthor);
-        if (it != g_soundMenuKeyMap.end()) {
-            for (const auto& song : it->second) {
-                g_soundMenuKeyPlaylist.push_back(song.soundFile);
-            }
-        } else {
-            WriteToSoundPlayerLog("SoundMenuKey: Author '" + g_soundMenuKeyAuthor + "' not found in JSON", __LINE__);
+    if (tables->generation != g_soundMenuKeyGeneration) {
+        ResetSoundMenuKeyPlaylist(*tables);
+        if (g_soundMenuKeyPlaylist.Size() == 0) {
+            return std::string();
         }
     }
     
-    if (g_soundMenuKeyMode == SoundMenuKeyMode::ALL_RANDOM || g_soundMenuKeyMode == SoundMenuKeyMode::AUTHOR_RANDOM) {
-        std::random_device rd;
-        std::mt19937 g(rd());
-        std::shuffle(g_soundMenuKeyPlaylist.begin(), g_soundMenuKeyPlaylist.end(), g);
+    if (g_soundMenuKeyReserved) {
+        g_soundMenuKeyPlaylist.Unwind();
     }
+    g_soundMenuKeyReserved = reserve;
+    
+    uint32_t id = g_soundMenuKeyPlaylist.Next();
+    position = g_soundMenuKeyPlaylist.Position();
+    total = g_soundMenuKeyPlaylist.Size();
+    
+    g_soundMenuKeyStates[g_soundMenuKeyStateKey] = {g_soundMenuKeyFingerprint, g_soundMenuKeyPlaylist.Seed(),
+                                                    g_soundMenuKeyPlaylist.Cursor()};
+    g_soundMenuKeyStatesDirty = true;
     
-    WriteToSoundPlayerLog("SoundMenuKey: Playlist built with " + std::to_string(g_soundMenuKeyPlaylist.size()) + " tracks", __LINE__);
+    return tables->soundMenuKeyTracks[g_soundMenuKeyFirstTrack + id];
 }
 
-void PlayNextSoundMenuKeyTrack() {
+// Settles the preload's provisional draw: kept if the track was played, otherwise
+// handed back so the playlist does not skip it. No-op if a manual advance took it.
+void ReleaseSoundMenuKeyReservation(bool played) {
     std::lock_guard<std::mutex> lock(g_soundMenuKeyMutex);
-    
-    if (g_soundMenuKeyPlaylist.empty() || !g_soundMenuKeyActive.load()) {
+    if (!g_soundMenuKeyReserved) return;
+    g_soundMenuKeyReserved = false;
+    if (played) return;
+    
+    g_soundMenuKeyPlaylist.Unwind();
+    g_soundMenuKeyStates[g_soundMenuKeyStateKey] = {g_soundMenuKeyFingerprint, g_soundMenuKeyPlaylist.Seed(),
+                                                    g_soundMenuKeyPlaylist.Cursor()};
+    g_soundMenuKeyStatesDirty = true;
+}
+
+void PlayNextSoundMenuKeyTrack() {
+    size_t position = 0;
+    size_t total = 0;
+    std::string trackToPlay = AdvanceSoundMenuKeyPlaylist(position, total);
+    if (trackToPlay.empty()) {
         return;
     }
     
-    if (g_soundMenuKeyCurrentIndex >= g_soundMenuKeyPlaylist.size()) {
-        g_soundMenuKeyCurrentIndex = 0;
-        if (g_soundMenuKeyMode == SoundMenuKeyMode::ALL_RANDOM || g_soundMenuKeyMode == SoundMenuKeyMode::AUTHOR_RANDOM) {
-            std::random_device rd;
-            std::mt19937 g(rd());
-            std::shuffle(g_soundMenuKeyPlaylist.begin(), g_soundMenuKeyPlaylist.end(), g);
-        }
-    }
-    
-    std::string trackToPlay = g_soundMenuKeyPlaylist[g_soundMenuKeyCurrentIndex];
-    g_soundMenuKeyCurrentIndex++;
     g_currentSoundMenuKeyTrack = trackToPlay;
     
     PlayBASSSound(trackToPlay, SCRIPT_CHECK, false);
     
     WriteToSoundPlayerLog("SoundMenuKey: Playing '" + trackToPlay + "' (" + 
-                         std::to_string(g_soundMenuKeyCurrentIndex) + "/" + 
-                         std::to_string(g_soundMenuKeyPlaylist.size()) + ")", __LINE__);
+                         std::to_string(position) + "/" + 
+                         std::to_string(total) + ")", __LINE__);
 }
 
 void StartSoundMenuKey() {
@@ -3826,7 +8108,7 @@ void StartSoundMenuKey() {
     
     BuildSoundMenuKeyPlaylist();
     
-    if (g_soundMenuKeyPlaylist.empty()) {
+    if (g_soundMenuKeyPlaylist.Size() == 0) {
         WriteToSoundPlayerLog("SoundMenuKey: No tracks available", __LINE__);
         return;
     }
@@ -3834,7 +8116,6 @@ void StartSoundMenuKey() {
     g_soundMenuKeyActive = true;
     g_soundMenuKeyPaused = false;
     PlayNextSoundMenuKeyTrack();
-    StartSoundMenuKeyMonitor();
     
     WriteToSoundPlayerLog("SoundMenuKey: Started", __LINE__);
 }
@@ -3844,11 +8125,11 @@ void StopSoundMenuKey() {
         return;
     }
     
-    StopSoundMenuKeyMonitor();
     StopBASSStream(SCRIPT_CHECK);
     g_soundMenuKeyActive = false;
     g_soundMenuKeyPaused = false;
     g_currentSoundMenuKeyTrack = "";
+    SaveSoundMenuKeyStates();
     
     WriteToSoundPlayerLog("SoundMenuKey: Stopped", __LINE__);
 }
@@ -3875,57 +8156,129 @@ void ResumeSoundMenuKey() {
     WriteToSoundPlayerLog("SoundMenuKey: Resumed", __LINE__);
 }
 
-void SoundMenuKeyMonitorThreadFunction() {
-    WriteToSoundPlayerLog("SoundMenuKey: Monitor thread started", __LINE__);
-    
-    while (g_soundMenuKeyMonitorActive.load() && !g_isShuttingDown.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        
-        if (!g_soundMenuKeyActive.load()) {
+// ========================================
+// Timed Game Tasks
+// ========================================
+// Game-side steps that have to be spaced out (the music mute pre-wake, the refresh
+// pulses) are scheduled here instead of sleeping on the caller's thread. One thread
+// waits for the earliest due task and hands it to the SKSE task interface, so the step
+// itself runs on the game thread between frames.
+
+struct TimedGameTask {
+    std::chrono::steady_clock::time_point due;
+    uint64_t order = 0;
+    std::function<void()> run;
+};
+
+// Heap comparator: the earliest task, then the first scheduled, sits on top.
+bool TimedGameTaskLater(const TimedGameTask& a, const TimedGameTask& b) {
+    return a.due != b.due ? a.due > b.due : a.order > b.order;
+}
+
+static std::mutex g_timedTasksMutex;
+static std::condition_variable g_timedTasksCondition;
+static std::vector<TimedGameTask> g_timedTasks;
+static uint64_t g_timedTaskOrder = 0;
+static bool g_timedTasksActive = false;
+static std::thread g_timedTaskThread;
+
+void TimedGameTaskThreadFunction() {
+    std::unique_lock<std::mutex> lock(g_timedTasksMutex);
+    while (g_timedTasksActive) {
+        if (g_timedTasks.empty()) {
+            g_timedTasksCondition.wait(lock);
             continue;
         }
-        
-        if (g_soundMenuKeyPaused.load()) {
+        auto due = g_timedTasks.front().due;
+        if (std::chrono::steady_clock::now() < due) {
+            g_timedTasksCondition.wait_until(lock, due);
             continue;
         }
-        
-        if (g_soundMenuKeyStream && pBASS_ChannelIsActive) {
-            DWORD status = pBASS_ChannelIsActive(g_soundMenuKeyStream);
-            
-            if (status == BASS_ACTIVE_STOPPED) {
-                WriteToSoundPlayerLog("SoundMenuKey: Track finished, playing next", __LINE__);
-                PlayNextSoundMenuKeyTrack();
-            }
+
+        std::pop_heap(g_timedTasks.begin(), g_timedTasks.end(), TimedGameTaskLater);
+        std::function<void()> task = std::move(g_timedTasks.back().run);
+        g_timedTasks.pop_back();
+        lock.unlock();
+
+        if (auto* tasks = SKSE::GetTaskInterface()) {
+            tasks->AddTask([task = std::move(task)]() {
+                try {
+                    task();
+                } catch (...) {
+                    logger::error("Error in timed game task");
+                }
+            });
         }
+        lock.lock();
     }
-    
-    WriteToSoundPlayerLog("SoundMenuKey: Monitor thread stopped", __LINE__);
 }
 
-void StartSoundMenuKeyMonitor() {
-    if (g_soundMenuKeyMonitorActive.load()) {
-        return;
+void ScheduleGameTask(std::chrono::milliseconds delay, std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(g_timedTasksMutex);
+    if (g_isShuttingDown.load()) return;
+    if (!g_timedTasksActive) {
+        g_timedTasksActive = true;
+        g_timedTaskThread = std::thread(TimedGameTaskThreadFunction);
     }
-    
-    g_soundMenuKeyMonitorActive = true;
-    g_soundMenuKeyMonitorThread = std::thread(SoundMenuKeyMonitorThreadFunction);
-    WriteToSoundPlayerLog("SoundMenuKey: Monitor started", __LINE__);
+    g_timedTasks.push_back({std::chrono::steady_clock::now() + delay, ++g_timedTaskOrder, std::move(task)});
+    std::push_heap(g_timedTasks.begin(), g_timedTasks.end(), TimedGameTaskLater);
+    g_timedTasksCondition.notify_one();
 }
 
-void StopSoundMenuKeyMonitor() {
-    if (!g_soundMenuKeyMonitorActive.load()) {
-        return;
+// Tasks that are not due yet are dropped.
+void StopTimedGameTasks() {
+    {
+        std::lock_guard<std::mutex> lock(g_timedTasksMutex);
+        if (!g_timedTasksActive) return;
+        g_timedTasksActive = false;
+        g_timedTasks.clear();
     }
-    
-    g_soundMenuKeyMonitorActive = false;
-    
-    if (g_soundMenuKeyMonitorThread.joinable()) {
-        g_soundMenuKeyMonitorThread.join();
+    g_timedTasksCondition.notify_one();
+    if (g_timedTaskThread.joinable()) {
+        g_timedTaskThread.join();
     }
-    
-    WriteToSoundPlayerLog("SoundMenuKey: Monitor stopped", __LINE__);
 }
 
+// ========================================
+// Game Music Mute
+// ========================================
+// See GameMusic.h. The music types are indexed once at kDataLoaded; muting swaps each
+// type's tracks with an empty array kept in g_gameMusic, so only the array headers
+// move. Every step runs as a timed game task. Mute and restore both bump
+// g_musicMuteGeneration, so steps of the other one still waiting in the queue drop out.
+
+static constexpr std::chrono::milliseconds kMusicMuteStep(75);
+
+class SkyrimGameMusic : public IGameMusic {
+public:
+    size_t IndexMusicTypes() override {
+        types.clear();
+        saved.clear();
+        if (auto* dataHandler = RE::TESDataHandler::GetSingleton()) {
+            for (auto* musicType : dataHandler->GetFormArray<RE::BGSMusicType>()) {
+                if (musicType) {
+                    types.push_back(musicType);
+                }
+            }
+        }
+        saved.resize(types.size());
+        return types.size();
+    }
+
+    size_t TrackCount(size_t type) const override { return types[type]->tracks.size(); }
+
+    void DetachTracks(size_t type) override { std::swap(types[type]->tracks, saved[type]); }
+
+    void ReattachTracks(size_t type) override { std::swap(types[type]->tracks, saved[type]); }
+
+private:
+    std::vector<RE::BGSMusicType*> types;
+    std::vector<RE::BSTArray<RE::BSIMusicTrack*>> saved;
+};
+
+static SkyrimGameMusic g_gameMusic;
+static MusicMuter g_musicMuter(g_gameMusic);
+
 void MuteGameMusic() {
     if (!g_muteGameMusicDuringOStim.load()) {
         return;
@@ -3949,56 +8302,43 @@ void MuteGameMusic() {
         return;
     }
     
-    WriteToSoundPlayerLog("Pre-waking audio engine via console command...", __LINE__);
-    WriteToSoundPlayerLog("Using music code: " + g_muteMusicCode, __LINE__);
-    ExecuteConsoleCommand("addmusic " + g_muteMusicCode);
-    std::this_thread::sleep_for(std::chrono::milliseconds(75));
-    
-    auto* dataHandler = RE::TESDataHandler::GetSingleton();
-    if (!dataHandler) {
-        WriteToSoundPlayerLog("ERROR: TESDataHandler not available", __LINE__);
-        WriteToSoundPlayerLog("========================================", __LINE__);
-        return;
-    }
+    g_musicTracksCleared = true;
+    uint64_t generation = ++g_musicMuteGeneration;
+    std::string musicCode = g_muteMusicCode;
     
-    int mutedCount = 0;
-    int skippedCount = 0;
+    WriteToSoundPlayerLog("Pre-waking audio engine via console command...", __LINE__);
+    WriteToSoundPlayerLog("Using music code: " + musicCode, __LINE__);
+    ScheduleGameTask(std::chrono::milliseconds(0), [musicCode]() { ExecuteConsoleCommand("addmusic " + musicCode); });
     
-    for (auto* musicType : dataHandler->GetFormArray<RE::BGSMusicType>()) {
-        if (!musicType) {
-            continue;
-        }
+    ScheduleGameTask(kMusicMuteStep, [generation, musicCode]() {
+        if (generation != g_musicMuteGeneration.load()) return;
         
-        if (musicType->tracks.empty()) {
-            skippedCount++;
-            continue;
+        auto counts = g_musicMuter.DetachAll();
+        if (counts.muted == 0) {
+            g_musicTracksCleared = false;
+            WriteToSoundPlayerLog("WARNING: No music types found to mute", __LINE__);
+            WriteToSoundPlayerLog("========================================", __LINE__);
+            return;
         }
         
-        g_originalMusicTracks[musicType] = musicType->tracks;
-        
-        musicType->tracks.clear();
-        
-        mutedCount++;
-    }
-    
-    if (mutedCount > 0) {
-        g_musicTracksCleared = true;
         g_gameMusicMuted = true;
-        WriteToSoundPlayerLog("MUSIC MUTED: " + std::to_string(mutedCount) + " types silenced, " + std::to_string(skippedCount) + " empty skipped", __LINE__);
-        
-        std::this_thread::sleep_for(std::chrono::milliseconds(75));
-        
-        ExecuteConsoleCommand("removemusic " + g_muteMusicCode);
-        WriteToSoundPlayerLog("Audio engine cleanup command executed", __LINE__);
+        WriteToSoundPlayerLog("MUSIC MUTED: " + std::to_string(counts.muted) + " types silenced, " +
+                                  std::to_string(counts.skipped) + " empty skipped",
+                              __LINE__);
         
-        ForceAudioRefresh();
-        WriteToSoundPlayerLog("========================================", __LINE__);
-    } else {
-        WriteToSoundPlayerLog("WARNING: No music types found to mute", __LINE__);
-        WriteToSoundPlayerLog("========================================", __LINE__);
-    }
+        ScheduleGameTask(kMusicMuteStep, [generation, musicCode]() {
+            if (generation != g_musicMuteGeneration.load()) return;
+            
+            ExecuteConsoleCommand("removemusic " + musicCode);
+            WriteToSoundPlayerLog("Audio engine cleanup command executed", __LINE__);
+            
+            ForceAudioRefresh();
+            WriteToSoundPlayerLog("========================================", __LINE__);
+        });
+    });
 }
 
+// Deactivate now, reactivate 50 ms later from a timed task.
 void ForceAudioRefresh() {
     HWND hwndJuego = FindWindow(nullptr, L"Skyrim Special Edition");
     if (!hwndJuego) {
@@ -4006,8 +8346,7 @@ void ForceAudioRefresh() {
     }
     if (hwndJuego) {
         SendMessage(hwndJuego, WM_ACTIVATEAPP, 0, 0);
-        Sleep(50);
-        SendMessage(hwndJuego, WM_ACTIVATEAPP, 1, 0);
+        ScheduleGameTask(std::chrono::milliseconds(50), [hwndJuego]() { SendMessage(hwndJuego, WM_ACTIVATEAPP, 1, 0); });
     }
 }
 
@@ -4027,6 +8366,8 @@ void RestoreGameMusic() {
     if (!g_musicTracksCleared) {
         return;
     }
+    g_musicTracksCleared = false;
+    uint64_t generation = ++g_musicMuteGeneration;
     
     WriteToSoundPlayerLog("========================================", __LINE__);
     WriteToSoundPlayerLog("RESTORING GAME MUSIC: Reloading music tracks to BGSMusicType", __LINE__);
@@ -4044,37 +8385,37 @@ void RestoreGameMusic() {
         WriteToSoundPlayerLog("MUTE SNAPSHOT: Using entry (snapshot) value for restoration", __LINE__);
     }
 
-    int restoredCount = 0;
+    std::string musicCode = g_muteMusicCode;
+    bool refreshWithCode = !musicCode.empty() && snapshotMuteSetting;
     
-    for (auto& [musicType, originalTracks] : g_originalMusicTracks) {
-        if (musicType) {
-            musicType->tracks = originalTracks;
-            
-            restoredCount++;
-        }
-    }
-    
-    g_originalMusicTracks.clear();
-    g_musicTracksCleared = false;
-    g_gameMusicMuted = false;
-    
-    WriteToSoundPlayerLog("MUSIC RESTORED: " + std::to_string(restoredCount) + " music types restored", __LINE__);
-    
-    std::this_thread::sleep_for(std::chrono::milliseconds(75));
-    
-    ForceAudioRefresh();
-    
-    WriteToSoundPlayerLog("Forcing audio engine refresh via console commands...", __LINE__);
-    if (!g_muteMusicCode.empty() && g_muteGameMusicDuringOStim_snapshot.load()) {
-        ExecuteConsoleCommand("addmusic " + g_muteMusicCode);
-        std::this_thread::sleep_for(std::chrono::milliseconds(75));
-        ExecuteConsoleCommand("removemusic " + g_muteMusicCode);
-        WriteToSoundPlayerLog("Audio engine refresh commands executed with snapshot code: " + g_muteMusicCode, __LINE__);
-    } else {
-        WriteToSoundPlayerLog("Audio engine refresh skipped (snapshot disabled or code empty)", __LINE__);
-    }
+    // The reattach always runs: a mute that follows still detaches again after it.
+    ScheduleGameTask(std::chrono::milliseconds(0), []() {
+        size_t restoredCount = g_musicMuter.ReattachAll();
+        g_gameMusicMuted = false;
+        WriteToSoundPlayerLog("MUSIC RESTORED: " + std::to_string(restoredCount) + " music types restored", __LINE__);
+    });
     
-    WriteToSoundPlayerLog("========================================", __LINE__);
+    ScheduleGameTask(kMusicMuteStep, [generation, musicCode, refreshWithCode]() {
+        if (generation != g_musicMuteGeneration.load()) return;
+        
+        ForceAudioRefresh();
+        
+        WriteToSoundPlayerLog("Forcing audio engine refresh via console commands...", __LINE__);
+        if (!refreshWithCode) {
+            WriteToSoundPlayerLog("Audio engine refresh skipped (snapshot disabled or code empty)", __LINE__);
+            WriteToSoundPlayerLog("========================================", __LINE__);
+            return;
+        }
+        
+        ExecuteConsoleCommand("addmusic " + musicCode);
+        ScheduleGameTask(kMusicMuteStep, [generation, musicCode]() {
+            if (generation != g_musicMuteGeneration.load()) return;
+            
+            ExecuteConsoleCommand("removemusic " + musicCode);
+            WriteToSoundPlayerLog("Audio engine refresh commands executed with snapshot code: " + musicCode, __LINE__);
+            WriteToSoundPlayerLog("========================================", __LINE__);
+        });
+    });
 }
 
 class GameEventProcessor : public RE::BSTEventSink<RE::TESActivateEvent>,
@@ -4123,8 +8464,8 @@ public:
 
             std::string menuName = event->menuName.c_str();
 
-            auto menuSoundIt = g_animationSoundMap.find(menuName);
-            if (menuSoundIt != g_animationSoundMap.end()) {
+            auto tables = GetSoundTables();
+            if (tables->animation.find(menuName) != tables->animation.end()) {
                 if (event->opening) {
                     PlayMenuSound(menuName);
                 } else {
@@ -4215,15 +8556,342 @@ public:
         return RE::BSEventNotifyControl::kContinue;
     }
 
-    RE::BSEventNotifyControl ProcessEvent(const RE::TESWaitStopEvent* event,
-                                           RE::BSTEventSource<RE::TESWaitStopEvent>*) override {
-        if (g_pauseMonitoring.load()) {
-            return RE::BSEventNotifyControl::kContinue;
+    RE::BSEventNotifyControl ProcessEvent(const RE::TESWaitStopEvent* event,
+                                           RE::BSTEventSource<RE::TESWaitStopEvent>*) override {
+        if (g_pauseMonitoring.load()) {
+            return RE::BSEventNotifyControl::kContinue;
+        }
+
+        return RE::BSEventNotifyControl::kContinue;
+    }
+};
+
+// Reads the clock from the first bracketed block: "[HH:MM:SS.mmm]", "[HH:MM:SS:mmm]"
+// or a full "[YYYY-MM-DD HH:MM:SS.mmm]" spdlog stamp. Milliseconds are optional.
+bool ParseOStimTimestamp(const std::string& line, int64_t& ms) {
+    size_t open = line.find_first_not_of(" \t");
+    if (open == std::string::npos || line[open] != '[') return false;
+    size_t close = line.find(']', open);
+    if (close == std::string::npos) return false;
+    
+    std::string_view block(line.data() + open + 1, close - open - 1);
+    auto digits = [&block](size_t at, size_t count) {
+        int value = 0;
+        for (size_t i = at; i < at + count; ++i) {
+            if (i >= block.size() || !std::isdigit(static_cast<unsigned char>(block[i]))) return -1;
+            value = value * 10 + (block[i] - '0');
+        }
+        return value;
+    };
+    
+    for (size_t i = 0; i + 8 <= block.size(); ++i) {
+        if (block[i + 2] != ':' || block[i + 5] != ':') continue;
+        int hours = digits(i, 2);
+        int minutes = digits(i + 3, 2);
+        int seconds = digits(i + 6, 2);
+        if (hours < 0 || minutes < 0 || seconds < 0) continue;
+        
+        int millis = 0;
+        if (i + 9 < block.size() && (block[i + 8] == '.' || block[i + 8] == ':')) {
+            size_t count = 0;
+            while (i + 9 + count < block.size() && count < 3 &&
+                   std::isdigit(static_cast<unsigned char>(block[i + 9 + count]))) {
+                count++;
+            }
+            millis = count > 0 ? digits(i + 9, count) : 0;
+            for (size_t pad = count; pad < 3; ++pad) millis *= 10;
+        }
+        ms = ((static_cast<int64_t>(hours) * 60 + minutes) * 60 + seconds) * 1000 + millis;
+        return true;
+    }
+    return false;
+}
+
+// ========================================
+// Scene Selection
+// ========================================
+// Monitor thread only. Picks the SceneContext that drives the live channels and hands
+// them over when the pick changes, and gives mixed NPC scenes their own outputs.
+
+SceneContext& GetScene(int thread) {
+    auto [it, inserted] = g_scenes.try_emplace(thread);
+    if (inserted) {
+        it->second.thread = thread;
+        WriteToSoundPlayerLog("SCENE: OStim thread " + std::to_string(thread) + " started", __LINE__);
+    }
+    return it->second;
+}
+
+bool IsMixedScene(const SceneContext& scene) {
+    return scene.thread != kPlayerSceneThread && g_scenePolicy.load() == ScenePolicy::NpcDucked;
+}
+
+SceneContext* PickAudibleScene() {
+    auto player = g_scenes.find(kPlayerSceneThread);
+    if (g_scenePolicy.load() != ScenePolicy::Latest) {
+        return player != g_scenes.end() ? &player->second : nullptr;
+    }
+    
+    SceneContext* latest = nullptr;
+    for (auto& [thread, scene] : g_scenes) {
+        if (!latest || scene.lastChangeTick > latest->lastChangeTick) latest = &scene;
+    }
+    return latest;
+}
+
+bool AnySceneHeard() {
+    if (g_audibleScene) return true;
+    for (const auto& [thread, scene] : g_scenes) {
+        if (scene.output) return true;
+    }
+    return false;
+}
+
+// Stops what the scene put on its channels and drops its picks, so it starts over if
+// it is heard again. Its node and throttles are kept.
+void ReleaseSceneOutput(SceneContext& scene) {
+    SceneOutputScope scope(scene);
+    if (scene.currentFamilyId != kNoAnimationId) StopBASSStream(SCRIPT_BASE);
+    if (scene.currentSpecificId != kNoAnimationId) StopBASSStream(SCRIPT_SPECIFIC);
+    
+    std::vector<std::string> fragments;
+    for (const auto& [fragment, layers] : Output().positionStreams) fragments.push_back(fragment);
+    for (const auto& fragment : fragments) StopPositionFragment(fragment);
+    
+    scene.currentFamilyId = kNoAnimationId;
+    scene.currentSpecificId = kNoAnimationId;
+    scene.currentBaseAnimation.clear();
+    scene.currentSpecificAnimation.clear();
+    scene.activePositionFragments.Clear();
+}
+
+// Game music and SoundMenuKey follow whether any scene is heard at all.
+void BeginSceneAudio() {
+    if (g_firstAnimationDetected) return;
+    WriteToSoundPlayerLog("First animation detected, muting game music immediately", __LINE__);
+    MuteGameMusic();
+    g_firstAnimationDetected = true;
+    
+    auto tables = GetSoundTables();
+    WriteToSoundPlayerLog("Using sound mappings snapshot #" + std::to_string(tables->generation) + " (" +
+                              std::to_string(tables->animation.size()) + " mappings)",
+                          __LINE__);
+    StartSoundMenuKey();
+}
+
+void EndSceneAudio() {
+    RestoreGameMusic();
+    StopSoundMenuKey();
+    StopAllSounds();
+    g_firstAnimationDetected = false;
+}
+
+void SetAudibleScene(SceneContext* scene) {
+    if (scene == g_audibleScene) return;
+    if (g_audibleScene) ReleaseSceneOutput(*g_audibleScene);
+    g_audibleScene = scene;
+    
+    if (!scene) {
+        WriteToSoundPlayerLog("SCENE: No scene is audible", __LINE__);
+        return;
+    }
+    WriteToSoundPlayerLog("SCENE: Thread " + std::to_string(scene->thread) + " is audible (policy " +
+                         ScenePolicyName(g_scenePolicy.load()) + ")", __LINE__);
+    if (!scene->lastAnimation.empty()) {
+        CheckAndPlaySound(*scene, scene->lastAnimation);
+    }
+}
+
+// Starts a mixed scene on its own output at SceneDuckVolume, or brings one that already
+// plays to the current SceneDuckVolume.
+void MixScene(SceneContext& scene) {
+    float gain = g_sceneDuckVolume.load();
+    if (scene.output) {
+        if (scene.output->sceneGain.exchange(gain) != gain) {
+            SceneOutputScope scope(scene);
+            UpdateAllBASSVolumes();
+        }
+        return;
+    }
+    
+    scene.output = new AudioOutput();
+    scene.output->sceneGain = gain;
+    {
+        std::lock_guard<std::mutex> lock(g_bassMutex);
+        g_sceneOutputs.push_back(scene.output);
+    }
+    BeginSceneAudio();
+    WriteToSoundPlayerLog("SCENE: Thread " + std::to_string(scene.thread) + " is mixed under the player's at " +
+                         std::to_string(static_cast<int>(gain * 100)) + "%", __LINE__);
+    if (!scene.lastAnimation.empty()) {
+        CheckAndPlaySound(scene, scene.lastAnimation);
+    }
+}
+
+// Stops a mixed scene and gives up its output; the audio thread frees it.
+void UnmixScene(SceneContext& scene) {
+    if (!scene.output) return;
+    ReleaseSceneOutput(scene);
+    ReleaseAudioOutput(scene.output);
+    scene.output = nullptr;
+    WriteToSoundPlayerLog("SCENE: Thread " + std::to_string(scene.thread) + " is no longer mixed", __LINE__);
+}
+
+// Also reapplies ScenePolicy and SceneDuckVolume after an INI change. Scenes leave their
+// output before the audible one is picked, so none plays on two at once.
+void UpdateAudibleScene() {
+    for (auto& [thread, scene] : g_scenes) {
+        if (!IsMixedScene(scene)) UnmixScene(scene);
+    }
+    
+    SceneContext* next = PickAudibleScene();
+    if (next) BeginSceneAudio();
+    SetAudibleScene(next);
+    
+    for (auto& [thread, scene] : g_scenes) {
+        if (IsMixedScene(scene)) MixScene(scene);
+    }
+    if (!AnySceneHeard() && g_firstAnimationDetected) {
+        EndSceneAudio();
+    }
+}
+
+// A stop line without a thread number closes every scene. When nothing is heard any more
+// the old full stop runs, also for a thread that was never seen.
+void CloseScene(int thread) {
+    if (thread < 0) {
+        SetAudibleScene(nullptr);
+        for (auto& [sceneThread, scene] : g_scenes) UnmixScene(scene);
+        g_scenes.clear();
+    } else {
+        auto it = g_scenes.find(thread);
+        if (it != g_scenes.end()) {
+            if (&it->second == g_audibleScene) SetAudibleScene(nullptr);
+            UnmixScene(it->second);
+            g_scenes.erase(it);
+        }
+    }
+    
+    if (PickAudibleScene() || AnySceneHeard()) {
+        UpdateAudibleScene();
+    } else {
+        SetAudibleScene(nullptr);
+        EndSceneAudio();
+    }
+}
+
+// Forgets every scene (new game, log truncated). The live channels are left alone; mixed
+// scenes' outputs are released, as nothing would stop them otherwise.
+void ForgetScenes() {
+    for (auto& [thread, scene] : g_scenes) {
+        if (scene.output) ReleaseAudioOutput(scene.output);
+    }
+    g_scenes.clear();
+    g_audibleScene = nullptr;
+}
+
+// Classifies one OStim.log line in either the official or the non-official format.
+// Shared by the live monitor and the replay benchmark so both see the same events.
+enum class OStimLineKind { None, Warning, ThreadStop, Animation };
+
+struct OStimLine {
+    OStimLineKind kind = OStimLineKind::None;
+    const char* detail = "";
+    std::string animation;
+    int thread = kPlayerSceneThread;  // -1 on a stop line that names no thread
+};
+
+// Reads the number in "thread N" starting the search at `from`; -1 if there is none.
+int ParseOStimThreadId(const std::string& line, size_t from) {
+    size_t pos = line.find("thread ", from);
+    if (pos == std::string::npos) return -1;
+    pos += 7;
+    int thread = 0;
+    size_t digits = 0;
+    while (pos < line.size() && std::isdigit(static_cast<unsigned char>(line[pos])) && digits < 6) {
+        thread = thread * 10 + (line[pos++] - '0');
+        digits++;
+    }
+    return digits ? thread : -1;
+}
+
+// "thread N changed to node X": true with N and X filled in.
+bool ParseNodeChange(const std::string& line, int& thread, std::string& animation) {
+    size_t nodePos = line.find(" changed to node ");
+    if (nodePos == std::string::npos || nodePos + 17 >= line.length()) return false;
+    size_t threadPos = line.rfind("thread ", nodePos);
+    if (threadPos == std::string::npos) return false;
+    int parsed = ParseOStimThreadId(line, threadPos);
+    if (parsed < 0) return false;
+    thread = parsed;
+    animation = line.substr(nodePos + 17);
+    return true;
+}
+
+OStimLine ParseOStimLine(const std::string& line) {
+    OStimLine result;
+    
+    if (line.find("[warning]") != std::string::npos) {
+        result.kind = OStimLineKind::Warning;
+        return result;
+    }
+    
+    size_t first = line.find_first_not_of(" \t\r\n");
+    if (first != std::string::npos && line.compare(first, 3, "[W]") == 0) {
+        result.kind = OStimLineKind::Warning;
+        return result;
+    }
+
+    if (line.find("[Thread.cpp:634]") != std::string::npos && line.find("closing thread") != std::string::npos) {
+        result.kind = OStimLineKind::ThreadStop;
+        result.detail = "OStim thread closing (official format)";
+    } else if (line.find("[ThreadManager.cpp:174]") != std::string::npos && line.find("trying to stop thread") != std::string::npos) {
+        result.kind = OStimLineKind::ThreadStop;
+        result.detail = "OStim trying to stop thread (official format)";
+    } else if (line.find("[I]") != std::string::npos && line.find("closing thread") != std::string::npos) {
+        result.kind = OStimLineKind::ThreadStop;
+        result.detail = "OStim thread closing (non-official format)";
+    } else if (line.find("[I]") != std::string::npos && line.find("trying to stop thread") != std::string::npos) {
+        result.kind = OStimLineKind::ThreadStop;
+        result.detail = "OStim trying to stop thread (non-official format)";
+    }
+
+    if (result.kind == OStimLineKind::ThreadStop) {
+        result.thread = ParseOStimThreadId(line, 0);
+        return result;
+    }
+
+    std::string animationName;
+    bool official = line.find("[info]") != std::string::npos;
+    bool nonOfficial = line.find("[I]") != std::string::npos;
+
+    // Node changes come from every OStim thread; UI transitions only from the player's.
+    if (((official && line.find("[Thread.cpp:195]") != std::string::npos) || nonOfficial) &&
+        ParseNodeChange(line, result.thread, animationName)) {
+        // thread and node filled in
+    } else if (official && line.find("[OStimMenu.h:48]") != std::string::npos && line.find("UI_TransitionRequest") != std::string::npos) {
+        size_t lastOpenBrace = line.rfind('{');
+        size_t lastCloseBrace = line.rfind('}');
+
+        if (lastOpenBrace != std::string::npos && lastCloseBrace != std::string::npos && lastCloseBrace > lastOpenBrace) {
+            animationName = line.substr(lastOpenBrace + 1, lastCloseBrace - lastOpenBrace - 1);
         }
+    } else if (nonOfficial && line.find("UI_TransitionRequest") != std::string::npos) {
+        size_t lastOpenBrace = line.rfind('{');
+        size_t lastCloseBrace = line.rfind('}');
 
-        return RE::BSEventNotifyControl::kContinue;
+        if (lastOpenBrace != std::string::npos && lastCloseBrace != std::string::npos && lastCloseBrace > lastOpenBrace) {
+            animationName = line.substr(lastOpenBrace + 1, lastCloseBrace - lastOpenBrace - 1);
+        }
     }
-};
+
+    animationName.erase(animationName.find_last_not_of(" \n\r\t") + 1);
+    if (!animationName.empty()) {
+        result.kind = OStimLineKind::Animation;
+        result.animation = std::move(animationName);
+    }
+    return result;
+}
 
 void ProcessOStimLog() {
     try {
@@ -4231,10 +8899,14 @@ void ProcessOStimLog() {
             return;
         }
 
-        if (g_pauseMonitoring.load()) {
+        if (g_pauseMonitoring.load() || g_replayRunning.load()) {
             return;
         }
 
+        if (g_scenePolicyChanged.exchange(false)) {
+            UpdateAudibleScene();
+        }
+
         if (!g_initialDelayComplete) {
             auto currentTime = std::chrono::steady_clock::now();
             auto elapsedSeconds =
@@ -4272,7 +8944,7 @@ void ProcessOStimLog() {
         if (currentFileSize < g_lastFileSize) {
             g_lastOStimLogPosition = 0;
             g_processedLines.clear();
-            g_lastAnimation = "";
+            ForgetScenes();
             g_firstAnimationDetected = false;
             logger::info("OStim.log was truncated, resetting position");
             WriteToSoundPlayerLog("OStim.log reset detected - restarting monitoring", __LINE__);
@@ -4294,15 +8966,14 @@ void ProcessOStimLog() {
         }
 
         std::string line;
+        int64_t pollClockMs = LocalMillisOfDay();
+        uint64_t pollMicros = MonotonicMicros();
 
         while (std::getline(ostimLog, line)) {
-            if (line.find("[warning]") != std::string::npos) {
-                continue;
-            }
-            
-            std::string trimmedLine = line;
-            trimmedLine.erase(0, trimmedLine.find_first_not_of(" \t\r\n"));
-            if (!trimmedLine.empty() && trimmedLine[0] == '[' && trimmedLine.length() > 2 && trimmedLine[1] == 'W' && trimmedLine[2] == ']') {
+            uint64_t readMicros = MonotonicMicros();
+            OStimLine parsed = ParseOStimLine(line);
+            uint64_t classifiedMicros = MonotonicMicros();
+            if (parsed.kind == OStimLineKind::Warning) {
                 continue;
             }
 
@@ -4313,105 +8984,66 @@ void ProcessOStimLog() {
                 continue;
             }
 
-            bool isThreadStop = false;
-
-            if (line.find("[Thread.cpp:634]") != std::string::npos && line.find("closing thread") != std::string::npos) {
-                isThreadStop = true;
-                WriteToSoundPlayerLog("DETECTED: OStim thread closing (official format)", __LINE__);
-            } else if (line.find("[ThreadManager.cpp:174]") != std::string::npos && line.find("trying to stop thread") != std::string::npos) {
-                isThreadStop = true;
-                WriteToSoundPlayerLog("DETECTED: OStim trying to stop thread (official format)", __LINE__);
-            } else if (line.find("[I]") != std::string::npos && line.find("closing thread") != std::string::npos) {
-                isThreadStop = true;
-                WriteToSoundPlayerLog("DETECTED: OStim thread closing (non-official format)", __LINE__);
-            } else if (line.find("[I]") != std::string::npos && line.find("trying to stop thread") != std::string::npos) {
-                isThreadStop = true;
-                WriteToSoundPlayerLog("DETECTED: OStim trying to stop thread (non-official format)", __LINE__);
-            }
-
-            if (isThreadStop) {
+            if (parsed.kind == OStimLineKind::ThreadStop) {
+                WriteToSoundPlayerLog(std::string("DETECTED: ") + parsed.detail + " (thread " +
+                                     (parsed.thread >= 0 ? std::to_string(parsed.thread) : std::string("?")) + ")", __LINE__);
                 g_processedLines.insert(hashStr);
-                RestoreGameMusic();
-                StopSoundMenuKey();
-                StopAllSounds();
-                g_firstAnimationDetected = false;
+                CloseScene(parsed.thread);
                 continue;
             }
 
-            bool isAnimationLine = false;
-            std::string animationName;
-
-            if (line.find("[info]") != std::string::npos && line.find("[Thread.cpp:195]") != std::string::npos && line.find("thread 0 changed to node") != std::string::npos) {
-                size_t nodePos = line.find("changed to node ");
-                if (nodePos != std::string::npos) {
-                    size_t startPos = nodePos + 16;
-                    if (startPos < line.length()) {
-                        animationName = line.substr(startPos);
-                        isAnimationLine = true;
-                    }
-                }
-            } else if (line.find("[info]") != std::string::npos && line.find("[OStimMenu.h:48]") != std::string::npos && line.find("UI_TransitionRequest") != std::string::npos) {
-                size_t lastOpenBrace = line.rfind('{');
-                size_t lastCloseBrace = line.rfind('}');
-
-                if (lastOpenBrace != std::string::npos && lastCloseBrace != std::string::npos && lastCloseBrace > lastOpenBrace) {
-                    animationName = line.substr(lastOpenBrace + 1, lastCloseBrace - lastOpenBrace - 1);
-                    if (!animationName.empty()) {
-                        isAnimationLine = true;
-                    }
-                }
-            } else if (line.find("[I]") != std::string::npos && line.find("thread 0 changed to node") != std::string::npos) {
-                size_t nodePos = line.find("changed to node ");
-                if (nodePos != std::string::npos) {
-                    size_t startPos = nodePos + 16;
-                    if (startPos < line.length()) {
-                        animationName = line.substr(startPos);
-                        isAnimationLine = true;
-                    }
-                }
-            } else if (line.find("[I]") != std::string::npos && line.find("UI_TransitionRequest") != std::string::npos) {
-                size_t lastOpenBrace = line.rfind('{');
-                size_t lastCloseBrace = line.rfind('}');
-
-                if (lastOpenBrace != std::string::npos && lastCloseBrace != std::string::npos && lastCloseBrace > lastOpenBrace) {
-                    animationName = line.substr(lastOpenBrace + 1, lastCloseBrace - lastOpenBrace - 1);
-                    if (!animationName.empty()) {
-                        isAnimationLine = true;
-                    }
-                }
-            }
-
-            if (isAnimationLine && !animationName.empty()) {
-                animationName.erase(animationName.find_last_not_of(" \n\r\t") + 1);
+            std::string& animationName = parsed.animation;
 
+            if (parsed.kind == OStimLineKind::Animation) {
                 g_processedLines.insert(hashStr);
 
-                if (animationName == g_lastAnimation) {
+                SceneContext& scene = GetScene(parsed.thread);
+                if (animationName == scene.lastAnimation) {
                     continue;
                 }
 
-                g_lastAnimation = animationName;
+                std::string previousAnimation = scene.lastAnimation;
+                scene.lastAnimation = animationName;
+                scene.lastChangeTick = ++g_sceneChangeTick;
 
                 if (g_processedLines.size() > 500) {
                     g_processedLines.clear();
                 }
 
+                bool mixed = IsMixedScene(scene);
+                if (!mixed && PickAudibleScene() != &scene) {
+                    WriteToSoundPlayerLog("SCENE: Thread " + std::to_string(scene.thread) + " at {" + animationName +
+                                         "} (not audible)", __LINE__);
+                    continue;
+                }
+
                 std::string formattedAnimation = "{" + animationName + "}";
-                WriteToSoundPlayerLog(formattedAnimation, __LINE__, true);
+                if (mixed) {
+                    WriteToSoundPlayerLog("SCENE: Thread " + std::to_string(scene.thread) + " at " + formattedAnimation +
+                                         " (mixed)", __LINE__);
+                } else {
+                    WriteToSoundPlayerLog(formattedAnimation, __LINE__, true);
+                }
 
-                if (!g_firstAnimationDetected) {
-                    WriteToSoundPlayerLog("First animation detected, muting game music immediately",
-                                          __LINE__);
-                    
-                    MuteGameMusic();
-                    g_firstAnimationDetected = true;
-                    
-                    WriteToSoundPlayerLog("Loading sound mappings in background...", __LINE__);
-                    LoadSoundMappings();
-                    StartSoundMenuKey();
+                int64_t stampMs = 0;
+                if (ParseOStimTimestamp(line, stampMs)) {
+                    int64_t nowMs = pollClockMs + static_cast<int64_t>((readMicros - pollMicros) / 1000);
+                    int64_t lagMs = ((nowMs - stampMs) % kMillisPerDay + kMillisPerDay) % kMillisPerDay;
+                    if (lagMs <= kMaxAppendLagMs) {
+                        g_latencyHistograms[OSoundtracksAPI::kStageAppendToRead].Record(
+                            static_cast<uint64_t>(lagMs) * 1000);
+                    }
                 }
+                RecordLatency(OSoundtracksAPI::kStageReadToClassified, readMicros, classifiedMicros);
 
-                CheckAndPlaySound(animationName);
+                t_transitionStamps = {readMicros, classifiedMicros};
+                if (g_audibleScene == &scene || scene.output) {
+                    CheckAndPlaySound(scene, animationName);
+                } else {
+                    UpdateAudibleScene();
+                }
+                t_transitionStamps = {};
+                OnAnimationTransition(previousAnimation, animationName);
             }
         }
 
@@ -4449,7 +9081,14 @@ void MonitoringThreadFunction() {
 
     while (g_monitoringActive && !g_isShuttingDown.load()) {
         g_monitorCycles++;
-        ProcessOStimLog();
+        uint64_t cycles = ReadThreadCycles();
+        {
+            // Held for the whole cycle, so a starting replay can wait out the one in flight.
+            std::lock_guard<std::mutex> cycleLock(g_monitorCycleMutex);
+            ProcessOStimLog();
+        }
+        g_monitorCpuCycles.fetch_add(ReadThreadCycles() - cycles, std::memory_order_relaxed);
+        g_monitorTimedCycles.fetch_add(1, std::memory_order_relaxed);
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
     }
 
@@ -4463,7 +9102,7 @@ void StartMonitoringThread() {
         g_lastOStimLogPosition = 0;
         g_lastFileSize = 0;
         g_processedLines.clear();
-        g_lastAnimation = "";
+        ForgetScenes();
         g_firstAnimationDetected = false;
         g_initialDelayComplete = false;
         g_monitorThread = std::thread(MonitoringThreadFunction);
@@ -4485,6 +9124,458 @@ void StopMonitoringThread() {
     }
 }
 
+// ========================================
+// OStim Session Replay Benchmark
+// ========================================
+// Replays a recorded OStim.log, or a synthetic walk over the loaded SoundTables, through
+// ParseOStimLine and CheckAndPlaySound the way the monitor would, into its own
+// AudioOutput on a null backend, so live channels, handles and g_audio are never
+// touched. Each transition records when its line was delivered, when the
+// first Play command was posted and when the backend was asked to start a stream, plus
+// CPU cycles and heap allocations on the delivering thread and on the audio thread.
+// Started from [Benchmark] ReplaySession while no scene is running; the live monitor
+// skips its cycles until the replay is finished. Game music, menu sounds, the
+// SoundMenuKey and the author preview keep playing, and in-game notifications are
+// suppressed.
+
+static constexpr int64_t kReplayDefaultGapMs = 1500;
+static constexpr int64_t kReplaySyntheticGapMs = 3000;
+static constexpr uint32_t kReplaySyntheticTransitions = 200;
+static constexpr uint32_t kReplaySyntheticSceneLength = 25;
+static constexpr const char* kReplaySessionFolder = "Benchmark_OSoundtracks";
+
+struct ReplayEvent {
+    int64_t atMs = 0;
+    OStimLineKind kind = OStimLineKind::None;
+    std::string animation;
+};
+
+struct ReplayTransition {
+    std::chrono::steady_clock::time_point detected;
+    std::chrono::steady_clock::time_point command;
+    std::chrono::steady_clock::time_point started;
+    uint64_t detectCycles = 0;
+    uint64_t detectAllocations = 0;
+    uint64_t audioCycles = 0;
+    uint64_t audioAllocations = 0;
+};
+
+// Null backend that stamps the transition a Play belongs to.
+class BenchmarkAudioBackend : public NullAudioBackend {
+public:
+    const char* Name() const override { return "benchmark"; }
+    bool Play(AudioHandle handle) override;
+};
+
+static BenchmarkAudioBackend g_benchmarkBackend;
+static AudioOutput g_replayOutput{&g_benchmarkBackend};
+static std::vector<ReplayTransition> g_replayTransitions;
+static std::atomic<bool> g_replayActive(false);
+static std::thread g_replayThread;
+
+// Caller holds g_replayMutex.
+ReplayTransition* FindReplayTransition(uint32_t traceId) {
+    return traceId > 0 && traceId <= g_replayTransitions.size() ? &g_replayTransitions[traceId - 1] : nullptr;
+}
+
+void NoteReplayCommand(uint32_t traceId) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(g_replayMutex);
+    ReplayTransition* transition = FindReplayTransition(traceId);
+    if (transition && transition->command == std::chrono::steady_clock::time_point{}) {
+        transition->command = now;
+    }
+}
+
+void NoteReplayAudioWork(uint32_t traceId, uint64_t cycles, uint64_t allocations) {
+    std::lock_guard<std::mutex> lock(g_replayMutex);
+    if (ReplayTransition* transition = FindReplayTransition(traceId)) {
+        transition->audioCycles += cycles;
+        transition->audioAllocations += allocations;
+    }
+}
+
+bool BenchmarkAudioBackend::Play(AudioHandle handle) {
+    if (t_replayTraceId) {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(g_replayMutex);
+        ReplayTransition* transition = FindReplayTransition(t_replayTraceId);
+        if (transition && transition->started == std::chrono::steady_clock::time_point{}) {
+            transition->started = now;
+        }
+    }
+    return NullAudioBackend::Play(handle);
+}
+
+// A seeded random walk over the mapped animation names, with some nodes carrying a
+// position fragment, some unmapped, and a thread stop every scene.
+void BuildSyntheticReplay(uint32_t transitions, std::vector<ReplayEvent>& events) {
+    auto tables = GetSoundTables();
+    const auto& names = tables->animationNames;
+    const auto& fragments = tables->positionFragments;
+    
+    std::mt19937 rng(42);
+    int64_t at = 0;
+    for (uint32_t i = 0; i < transitions; ++i) {
+        if (i > 0 && i % kReplaySyntheticSceneLength == 0) {
+            events.push_back({at, OStimLineKind::ThreadStop, ""});
+            at += kReplaySyntheticGapMs;
+        }
+        
+        uint32_t roll = rng() % 100;
+        std::string animation;
+        if (names.empty() || roll >= 85) {
+            animation = "OSoundtracksReplay_Unmapped_" + std::to_string(i);
+        } else if (roll >= 70 && !fragments.empty()) {
+            animation = names[rng() % names.size()] + "-" + fragments[rng() % fragments.size()];
+        } else {
+            animation = names[rng() % names.size()];
+        }
+        
+        events.push_back({at, OStimLineKind::Animation, std::move(animation)});
+        at += kReplaySyntheticGapMs;
+    }
+}
+
+// "synthetic" or "synthetic:N" builds a walk; anything else is an OStim.log copy looked
+// up as given, then in the canned session folder next to the DLL, then in SKSE logs.
+bool LoadReplaySession(const std::string& session, std::vector<ReplayEvent>& events, std::string& description) {
+    std::string lowered = ToLowerCase(session);
+    if (lowered.rfind("synthetic", 0) == 0) {
+        uint32_t transitions = kReplaySyntheticTransitions;
+        size_t colon = lowered.find(':');
+        if (colon != std::string::npos) {
+            try {
+                transitions = static_cast<uint32_t>(std::clamp(std::stoi(lowered.substr(colon + 1)), 1, 100000));
+            } catch (...) {
+                WriteToSoundPlayerLog("REPLAY: Invalid synthetic length '" + session + "', using " +
+                                     std::to_string(transitions), __LINE__);
+            }
+        }
+        
+        if (!WaitForSoundTables(std::chrono::seconds(30))) {
+            WriteToSoundPlayerLog("REPLAY: Sound mappings not loaded, synthetic session uses unmapped nodes only", __LINE__);
+        }
+        BuildSyntheticReplay(transitions, events);
+        description = "synthetic (" + std::to_string(transitions) + " transitions, seed 42)";
+        return true;
+    }
+    
+    fs::path sessionPath(session);
+    if (sessionPath.is_relative()) {
+        auto paths = GetAllSKSELogsPaths();
+        std::vector<fs::path> candidates = {g_dllDirectory / kReplaySessionFolder / sessionPath,
+                                            paths.primary / sessionPath, paths.secondary / sessionPath};
+        for (const auto& candidate : candidates) {
+            if (!candidate.empty() && fs::exists(candidate)) {
+                sessionPath = candidate;
+                break;
+            }
+        }
+    }
+    
+    std::ifstream file(sessionPath);
+    if (!file.is_open()) {
+        WriteToSoundPlayerLog("REPLAY ERROR: Session not found: " + session, __LINE__);
+        return false;
+    }
+    
+    std::string line;
+    int64_t clock = 0;
+    int64_t dayOffset = 0;
+    int64_t lastStamp = -1;
+    while (std::getline(file, line)) {
+        OStimLine parsed = ParseOStimLine(line);
+        if (parsed.kind != OStimLineKind::Animation && parsed.kind != OStimLineKind::ThreadStop) continue;
+        // The replay drives a single scene; NPC threads are left out like the player policy does.
+        if (parsed.thread > kPlayerSceneThread) continue;
+        
+        int64_t stamp = 0;
+        if (ParseOStimTimestamp(line, stamp)) {
+            if (lastStamp >= 0 && stamp < lastStamp) {
+                dayOffset += 24LL * 60 * 60 * 1000;
+            }
+            lastStamp = stamp;
+            clock = stamp + dayOffset;
+        } else if (!events.empty()) {
+            clock += kReplayDefaultGapMs;
+        }
+        
+        events.push_back({clock, parsed.kind, std::move(parsed.animation)});
+    }
+    
+    description = sessionPath.filename().string();
+    return !events.empty();
+}
+
+// Returns once every command made so far has run, or false after the timeout.
+bool WaitForAudioCommands(std::chrono::milliseconds timeout) {
+    uint64_t target = g_audioCommandSequence.load(std::memory_order_acquire);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (g_audioCommandsExecuted.load(std::memory_order_acquire) < target) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void ResetReplayAnimationState(SceneContext& scene) {
+    std::lock_guard<std::mutex> lock(g_throttleMutex);
+    scene = SceneContext{};
+}
+
+double ReplayPercentile(std::vector<double>& values, double percentile) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * values.size()));
+    return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+}
+
+std::string FormatReplayRow(const std::string& label, std::vector<double> values, int precision) {
+    std::ostringstream row;
+    row << std::left << std::setw(34) << label << std::right << std::fixed << std::setprecision(precision);
+    if (values.empty()) {
+        row << std::setw(10) << "-" << std::setw(10) << "-" << std::setw(10) << "-" << std::setw(10) << "-"
+            << std::setw(10) << "-" << "   (n=0)";
+        return row.str();
+    }
+    double sum = 0.0;
+    for (double value : values) sum += value;
+    row << std::setw(10) << sum / values.size() << std::setw(10) << ReplayPercentile(values, 50.0)
+        << std::setw(10) << ReplayPercentile(values, 90.0) << std::setw(10) << ReplayPercentile(values, 99.0)
+        << std::setw(10) << values.back() << "   (n=" << values.size() << ")";
+    return row.str();
+}
+
+void WriteReplayReport(const std::string& description, float speed, uint32_t loops, size_t events,
+                       const std::vector<ReplayTransition>& transitions, double wallSeconds,
+                       uint64_t monitorCycles, uint64_t monitorCount) {
+    auto millis = [](auto from, auto to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    
+    std::vector<double> toCommand, commandToStart, toStart;
+    std::vector<double> detectCycles, audioCycles, detectAllocations, audioAllocations;
+    size_t withAudio = 0;
+    for (const auto& transition : transitions) {
+        bool commanded = transition.command != std::chrono::steady_clock::time_point{};
+        bool started = transition.started != std::chrono::steady_clock::time_point{};
+        if (commanded) toCommand.push_back(millis(transition.detected, transition.command));
+        if (commanded && started) commandToStart.push_back(millis(transition.command, transition.started));
+        if (started) {
+            toStart.push_back(millis(transition.detected, transition.started));
+            withAudio++;
+        }
+        detectCycles.push_back(transition.detectCycles / 1000.0);
+        audioCycles.push_back(transition.audioCycles / 1000.0);
+        detectAllocations.push_back(static_cast<double>(transition.detectAllocations));
+        audioAllocations.push_back(static_cast<double>(transition.audioAllocations));
+    }
+    
+    std::ostringstream speedText;
+    if (speed > 0.0f) {
+        speedText << std::fixed << std::setprecision(2) << speed << "x";
+    } else {
+        speedText << "back-to-back";
+    }
+    
+    std::vector<std::string> lines = {
+        "OSoundtracks Replay Benchmark - " + GetCurrentTimeString(),
+        "Session: " + description + " (" + std::to_string(events) + " events x " + std::to_string(loops) +
+            " loops), speed: " + speedText.str() + ", backend: " + g_benchmarkBackend.Name(),
+        "Transitions: " + std::to_string(transitions.size()) + ", with audio: " + std::to_string(withAudio) +
+            ", wall time: " + std::to_string(static_cast<int>(wallSeconds * 1000.0)) + " ms",
+        "",
+        std::string(34, ' ') + "       avg       p50       p90       p99       max",
+        "Latency (ms)",
+        FormatReplayRow("  detect -> Play command", toCommand, 3),
+        FormatReplayRow("  Play command -> stream start", commandToStart, 3),
+        FormatReplayRow("  detect -> stream start", toStart, 3),
+        "CPU per transition (kcycles)",
+        FormatReplayRow("  detect path", detectCycles, 1),
+        FormatReplayRow("  audio thread", audioCycles, 1),
+    };
+    if (kCountHeapAllocations) {
+        lines.push_back("Allocations per transition");
+        lines.push_back(FormatReplayRow("  detect path", detectAllocations, 1));
+        lines.push_back(FormatReplayRow("  audio thread", audioAllocations, 1));
+    } else {
+        lines.push_back("Allocations per transition: not counted (build with OSOUNDTRACKS_BENCHMARK_ALLOCS=ON)");
+    }
+    lines.push_back("");
+    
+    if (monitorCount > 0) {
+        std::ostringstream monitor;
+        monitor << "Monitor thread: " << std::fixed << std::setprecision(1)
+                << (monitorCycles / 1000.0) / monitorCount << " kcycles per OStim.log poll (" << monitorCount
+                << " polls since start)";
+        lines.push_back(monitor.str());
+    } else {
+        lines.push_back("Monitor thread: no polls recorded yet");
+    }
+    
+    try {
+        fs::path reportPath = GetAllSKSELogsPaths().primary / "OSoundtracks-SA-Expansion-Sounds-NG-Benchmark.log";
+        std::ofstream report(reportPath, std::ios::out | std::ios::app);
+        for (const auto& line : lines) {
+            report << line << "\n";
+        }
+        report << "\n";
+        WriteToSoundPlayerLog("REPLAY: Report written to " + reportPath.string(), __LINE__);
+    } catch (...) {
+        logger::error("Error writing replay benchmark report");
+    }
+    
+    for (const auto& line : lines) {
+        if (!line.empty()) WriteToSoundPlayerLog("REPLAY: " + line, __LINE__);
+    }
+}
+
+void ReplayThreadFunction(std::string session, float speed, uint32_t loops) {
+    std::vector<ReplayEvent> events;
+    std::string description;
+    if (!LoadReplaySession(session, events, description)) {
+        g_replayActive = false;
+        return;
+    }
+    
+    // Live monitor cost so far; polls during the replay return early and would skew it.
+    uint64_t monitorCycles = g_monitorCpuCycles.load(std::memory_order_relaxed);
+    uint64_t monitorCount = g_monitorTimedCycles.load(std::memory_order_relaxed);
+    
+    // Later monitor cycles see the flag; taking the cycle lock once waits out the one in
+    // flight, so the check below cannot miss a scene it is just starting.
+    g_replayRunning = true;
+    { std::lock_guard<std::mutex> cycleLock(g_monitorCycleMutex); }
+    
+    if (g_firstAnimationDetected) {
+        WriteToSoundPlayerLog("REPLAY: Skipped - an OStim scene is running", __LINE__);
+        g_replayRunning = false;
+        g_replayActive = false;
+        return;
+    }
+    // The play path still checks that the live audio library is up.
+    if (!InitializeBASSLibrary()) {
+        WriteToSoundPlayerLog("REPLAY: Skipped - audio backend unavailable", __LINE__);
+        g_replayRunning = false;
+        g_replayActive = false;
+        return;
+    }
+    
+    g_benchmarkBackend.Initialize();
+    t_audioOutput = &g_replayOutput;
+    {
+        std::lock_guard<std::mutex> lock(g_replayMutex);
+        g_replayTransitions.clear();
+        g_replayTransitions.reserve(events.size() * loops);
+    }
+    SceneContext scene;
+    
+    WriteToSoundPlayerLog("REPLAY: Starting " + description + " - " + std::to_string(events.size()) + " events x " +
+                         std::to_string(loops), __LINE__);
+    
+    auto runStart = std::chrono::steady_clock::now();
+    for (uint32_t loop = 0; loop < loops && g_replayActive.load() && !g_isShuttingDown.load(); ++loop) {
+        auto origin = std::chrono::steady_clock::now();
+        int64_t firstMs = events.front().atMs;
+        std::string previous;
+        
+        for (const auto& event : events) {
+            if (!g_replayActive.load() || g_isShuttingDown.load()) break;
+            
+            if (speed > 0.0f) {
+                auto due = origin + std::chrono::microseconds(static_cast<int64_t>((event.atMs - firstMs) * 1000.0 / speed));
+                while (g_replayActive.load() && std::chrono::steady_clock::now() < due) {
+                    std::this_thread::sleep_until(std::min(due, std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+                }
+            } else {
+                WaitForAudioCommands(std::chrono::seconds(2));
+            }
+            
+            if (event.kind == OStimLineKind::ThreadStop) {
+                StopAllSounds();
+                ResetReplayAnimationState(scene);
+                previous.clear();
+                continue;
+            }
+            
+            if (event.animation == previous) continue;
+            previous = event.animation;
+            
+            uint32_t traceId = 0;
+            {
+                std::lock_guard<std::mutex> lock(g_replayMutex);
+                g_replayTransitions.emplace_back();
+                g_replayTransitions.back().detected = std::chrono::steady_clock::now();
+                traceId = static_cast<uint32_t>(g_replayTransitions.size());
+            }
+            
+            t_replayTraceId = traceId;
+            uint64_t cycles = ReadThreadCycles();
+            uint64_t allocations = HeapAllocations();
+            CheckAndPlaySound(scene, event.animation);
+            cycles = ReadThreadCycles() - cycles;
+            allocations = HeapAllocations() - allocations;
+            t_replayTraceId = 0;
+            
+            std::lock_guard<std::mutex> lock(g_replayMutex);
+            if (ReplayTransition* transition = FindReplayTransition(traceId)) {
+                transition->detectCycles = cycles;
+                transition->detectAllocations = allocations;
+            }
+        }
+        
+        StopAllSounds();
+        ResetReplayAnimationState(scene);
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+    
+    WaitForAudioCommands(std::chrono::seconds(5));
+    t_audioOutput = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_bassMutex);
+        g_benchmarkBackend.Shutdown();
+    }
+    
+    std::vector<ReplayTransition> transitions;
+    {
+        std::lock_guard<std::mutex> lock(g_replayMutex);
+        transitions.swap(g_replayTransitions);
+    }
+    g_replayRunning = false;
+    
+    WriteReplayReport(description, speed, loops, events.size(), transitions, wallSeconds, monitorCycles, monitorCount);
+    g_replayActive = false;
+}
+
+void StartReplayBenchmark() {
+    if (g_replayActive.load() || g_isShuttingDown.load()) return;
+    
+    std::string session;
+    float speed = 1.0f;
+    uint32_t loops = 1;
+    {
+        std::lock_guard<std::mutex> lock(g_replayMutex);
+        session = g_replaySession;
+        speed = g_replaySpeed;
+        loops = g_replayLoops;
+    }
+    if (session.empty()) return;
+    
+    if (g_replayThread.joinable()) {
+        g_replayThread.join();
+    }
+    g_replayActive = true;
+    g_replayThread = std::thread(ReplayThreadFunction, session, speed, loops);
+}
+
+void StopReplayBenchmark() {
+    g_replayActive = false;
+    if (g_replayThread.joinable()) {
+        g_replayThread.join();
+    }
+}
+
 std::string GetDocumentsPath() {
     try {
         wchar_t path[MAX_PATH] = {0};
@@ -4632,10 +9723,8 @@ std::string GetGamePath() {
     }
 }
 
-bool LoadSoundMappings() {
+bool ResolveSoundMappingsPath() {
     try {
-        g_animationSoundMap.clear();
-
         logger::info("==============================================");
         logger::info("SOUND MAPPINGS DETECTION - Enhanced Mode");
         logger::info("==============================================");
@@ -4767,6 +9856,27 @@ bool LoadSoundMappings() {
             return false;
         }
 
+        g_soundMappingsJsonPath = jsonPath;
+        return true;
+
+    } catch (const std::exception& e) {
+        logger::error("Error resolving sound mappings path: {}", e.what());
+        return false;
+    }
+}
+
+bool LoadSoundMappings() {
+    try {
+        fs::path jsonPath = g_soundMappingsJsonPath;
+        if (jsonPath.empty() || !fs::exists(jsonPath)) {
+            logger::error("JSON configuration file not found in any location!");
+            WriteToSoundPlayerLog("ERROR: JSON not found in standard or DLL-relative paths", __LINE__);
+            return false;
+        }
+
+        auto tables = std::make_unique<SoundTables>();
+        tables->jsonWriteTime = fs::last_write_time(jsonPath);
+
         std::ifstream file(jsonPath);
         if (!file.is_open()) {
             logger::error("Could not open JSON file");
@@ -4852,7 +9962,7 @@ bool LoadSoundMappings() {
                 }
             }
             
-            auto& config = g_animationSoundMap[animationName];
+            auto& config = tables->animation[animationName];
             config.soundOptions.push_back(SoundOption(soundFile, listNumber));
             config.repeatDelaySeconds = repeatDelay;
 
@@ -4899,7 +10009,7 @@ bool LoadSoundMappings() {
                     
                     std::string soundFile = content.substr(soundQuoteStart + 1, soundQuoteEnd - soundQuoteStart - 1);
                     
-                    auto& config = g_positionSoundMap[fragmentName];
+                    auto& config = tables->position[fragmentName];
                     config.soundOptions.push_back(SoundOption(soundFile, 1));
                     config.repeatDelaySeconds = 0;
                     
@@ -4922,10 +10032,10 @@ bool LoadSoundMappings() {
             }
         }
         
-        WriteToSoundPlayerLog("Loaded " + std::to_string(g_animationSoundMap.size()) + " sound mappings from JSON",
+        WriteToSoundPlayerLog("Loaded " + std::to_string(tables->animation.size()) + " sound mappings from JSON",
                               __LINE__);
 
-        for (const auto& [anim, config] : g_animationSoundMap) {
+        for (const auto& [anim, config] : tables->animation) {
             std::string delayInfo = (config.repeatDelaySeconds == 0) ? "loop" : std::to_string(config.repeatDelaySeconds) + "s delay";
             std::string soundList;
             for (size_t i = 0; i < config.soundOptions.size(); ++i) {
@@ -4935,9 +10045,32 @@ bool LoadSoundMappings() {
             WriteToSoundPlayerLog("  " + anim + " -> " + soundList + " [" + delayInfo + "]", __LINE__);
         }
         
-        if (!g_positionSoundMap.empty()) {
-            WriteToSoundPlayerLog("Loaded " + std::to_string(g_positionSoundMap.size()) + " position fragment mappings", __LINE__);
-            for (const auto& [fragment, config] : g_positionSoundMap) {
+        for (const auto& [name, config] : tables->animation) {
+            AnimationEntry entry;
+            entry.optionOffset = static_cast<uint32_t>(tables->animationOptions.size());
+            entry.optionCount = static_cast<uint32_t>(config.soundOptions.size());
+            entry.repeatDelaySeconds = config.repeatDelaySeconds;
+            tables->animationOptions.insert(tables->animationOptions.end(), config.soundOptions.begin(),
+                                            config.soundOptions.end());
+            tables->animationIds.emplace(name, static_cast<uint32_t>(tables->animationNames.size()));
+            tables->animationNames.push_back(name);
+            tables->animationEntries.push_back(entry);
+        }
+        for (size_t id = 0; id < tables->animationEntries.size(); ++id) {
+            tables->animationEntries[id].familyId =
+                tables->FindAnimationId(GetAnimationBaseView(tables->animationNames[id]));
+        }
+
+        for (const auto& [fragment, config] : tables->position) {
+            tables->positionFragmentIds[fragment] = static_cast<uint32_t>(tables->positionFragments.size());
+            tables->positionFragments.push_back(fragment);
+            tables->positionConfigs.push_back(&config);
+        }
+        tables->positionMatcher.Build(tables->positionFragments);
+
+        if (!tables->position.empty()) {
+            WriteToSoundPlayerLog("Loaded " + std::to_string(tables->position.size()) + " position fragment mappings", __LINE__);
+            for (const auto& [fragment, config] : tables->position) {
                 std::string soundList;
                 for (size_t i = 0; i < config.soundOptions.size(); ++i) {
                     soundList += config.soundOptions[i].soundFile;
@@ -5004,7 +10137,7 @@ bool LoadSoundMappings() {
                     }
                     
                     if (!authorSongs.empty()) {
-                        g_soundMenuKeyMap[authorName] = authorSongs;
+                        tables->soundMenuKey[authorName] = authorSongs;
                         logger::info("Loaded SoundMenuKey author: {} with {} songs", authorName, authorSongs.size());
                     }
                     
@@ -5021,8 +10154,19 @@ bool LoadSoundMappings() {
                 }
             }
             
-            WriteToSoundPlayerLog("Loaded " + std::to_string(g_soundMenuKeyMap.size()) + " SoundMenuKey authors", __LINE__);
-            for (const auto& [author, songs] : g_soundMenuKeyMap) {
+            WriteToSoundPlayerLog("Loaded " + std::to_string(tables->soundMenuKey.size()) + " SoundMenuKey authors", __LINE__);
+            
+            // Track IDs follow sorted author order so they stay stable across reloads.
+            std::vector<std::string> authors;
+            for (const auto& [author, songs] : tables->soundMenuKey) authors.push_back(author);
+            std::sort(authors.begin(), authors.end());
+            for (const auto& author : authors) {
+                const auto& songs = tables->soundMenuKey[author];
+                tables->soundMenuKeyRanges[author] = {static_cast<uint32_t>(tables->soundMenuKeyTracks.size()),
+                                                      static_cast<uint32_t>(songs.size())};
+                for (const auto& song : songs) tables->soundMenuKeyTracks.push_back(song.soundFile);
+            }
+            for (const auto& [author, songs] : tables->soundMenuKey) {
                 std::string songList;
                 for (size_t i = 0; i < songs.size(); ++i) {
                     songList += songs[i].soundFile;
@@ -5032,11 +10176,21 @@ bool LoadSoundMappings() {
             }
         }
 
-        if (!g_animationSoundMap.empty()) {
+        if (!tables->animation.empty()) {
             WriteToSoundPlayerLog("Sound mappings loaded successfully for BASS Audio", __LINE__);
         }
 
-        return !g_animationSoundMap.empty();
+        bool loaded = !tables->animation.empty();
+
+        {
+            std::lock_guard<std::mutex> lock(g_soundTablesPublishMutex);
+            tables->generation = g_soundTablesGeneration.load() + 1;
+            g_soundTables.Publish(std::move(tables));
+            g_soundTablesGeneration = g_soundTablesGeneration.load() + 1;
+        }
+        g_soundTablesPublished.notify_all();
+
+        return loaded;
 
     } catch (const std::exception& e) {
         logger::error("Error loading sound mappings: {}", e.what());
@@ -5044,6 +10198,68 @@ bool LoadSoundMappings() {
     }
 }
 
+RcuReadGuard<SoundTables> GetSoundTables() { return g_soundTables.Read(); }
+
+bool WaitForSoundTables(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(g_soundTablesPublishMutex);
+    return g_soundTablesPublished.wait_for(lock, timeout, [] { return g_soundTablesGeneration.load() > 0; });
+}
+
+void MappingsLoaderThreadFunction() {
+    WriteToSoundPlayerLog("Sound mappings loader started: " + g_soundMappingsJsonPath.string(), __LINE__);
+
+    fs::file_time_type lastSeenWriteTime{};
+    try {
+        lastSeenWriteTime = fs::last_write_time(g_soundMappingsJsonPath);
+    } catch (...) {
+    }
+
+    auto loadStart = std::chrono::steady_clock::now();
+    LoadSoundMappings();
+    auto loadMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - loadStart).count();
+    WriteToSoundPlayerLog("Sound mappings snapshot published in " + std::to_string(loadMs) + "ms", __LINE__);
+    QueueLoudnessAnalysis();
+
+    while (g_mappingsLoaderActive.load() && !g_isShuttingDown.load()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        g_soundTables.Reclaim();
+
+        try {
+            if (!fs::exists(g_soundMappingsJsonPath)) {
+                continue;
+            }
+
+            auto currentModTime = fs::last_write_time(g_soundMappingsJsonPath);
+            if (currentModTime != lastSeenWriteTime) {
+                lastSeenWriteTime = currentModTime;
+                WriteToSoundPlayerLog("JSON file changed, rebuilding sound mappings snapshot...", __LINE__);
+                LoadSoundMappings();
+                QueueLoudnessAnalysis();
+            }
+        } catch (...) {
+        }
+    }
+
+    logger::info("Sound mappings loader stopped");
+}
+
+void StartMappingsLoader() {
+    if (!g_mappingsLoaderActive.load()) {
+        g_mappingsLoaderActive = true;
+        g_mappingsLoaderThread = std::thread(MappingsLoaderThreadFunction);
+    }
+}
+
+void StopMappingsLoader() {
+    if (g_mappingsLoaderActive.load()) {
+        g_mappingsLoaderActive = false;
+        if (g_mappingsLoaderThread.joinable()) {
+            g_mappingsLoaderThread.join();
+        }
+    }
+}
+
 void PlayStartupSound() {
     if (!g_startupSoundEnabled.load()) {
         logger::info("Startup sound is disabled in INI");
@@ -5051,8 +10267,14 @@ void PlayStartupSound() {
         return;
     }
 
-    auto startIt = g_animationSoundMap.find("Start");
-    if (startIt != g_animationSoundMap.end() && !startIt->second.soundOptions.empty()) {
+    if (!WaitForSoundTables(std::chrono::seconds(5))) {
+        WriteToSoundPlayerLog("Sound mappings not ready yet, skipping startup sound", __LINE__);
+        return;
+    }
+
+    auto tables = GetSoundTables();
+    auto startIt = tables->animation.find("Start");
+    if (startIt != tables->animation.end() && !startIt->second.soundOptions.empty()) {
         std::string soundFile = startIt->second.soundOptions[0].soundFile;
         WriteToSoundPlayerLog("PLAYING STARTUP SOUND (BASS): " + soundFile, __LINE__);
         
@@ -5069,22 +10291,19 @@ void PlayStartupSound() {
             return;
         }
         
-        HSTREAM tempStream = pBASS_StreamCreateFile(FALSE, soundPath.wstring().c_str(), 0, 0, BASS_UNICODE);
+        IAudioBackend* audio = g_audio;
+        AudioHandle tempStream = audio->OpenStream(soundPath, false);
         if (tempStream) {
             float volume = g_volumeControlEnabled.load() ? g_menuVolume.load() : 1.0f;
-            if (pBASS_ChannelSetAttribute) {
-                pBASS_ChannelSetAttribute(tempStream, BASS_ATTRIB_VOL, volume);
-            }
-            pBASS_ChannelPlay(tempStream, FALSE);
+            audio->SetLevel(tempStream, volume);
+            audio->Play(tempStream);
             
-            std::thread([tempStream]() {
+            std::thread([audio, tempStream]() {
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                while (pBASS_ChannelIsActive && pBASS_ChannelIsActive(tempStream) == BASS_ACTIVE_PLAYING) {
+                while (audio->Activity(tempStream) == AudioActivity::Playing) {
                     std::this_thread::sleep_for(std::chrono::milliseconds(100));
                 }
-                if (pBASS_StreamFree) {
-                    pBASS_StreamFree(tempStream);
-                }
+                audio->Free(tempStream);
                 WriteToSoundPlayerLog("BASS: Startup sound stream freed", __LINE__);
             }).detach();
             
@@ -5164,26 +10383,11 @@ void InitializePlugin() {
 
         g_iniPath = fs::path(g_gamePath) / "Data" / "SKSE" / "Plugins" / "OSoundtracks-SA-Expansion-Sounds-NG.ini";
 
+        StartSoundPlayerLogger();
+
         auto paths = GetAllSKSELogsPaths();
         if (!paths.primary.empty()) {
-            std::vector<fs::path> logFolders = { paths.primary, paths.secondary };
-            
-            for (const auto& folder : logFolders) {
-                try {
-                    auto soundPlayerLogPath = folder / "OSoundtracks-SA-Expansion-Sounds-NG-Sound-Player.log";
-                    std::ofstream clearLog(soundPlayerLogPath, std::ios::trunc);
-                    clearLog.close();
-
-                    auto heartbeatLogPath = folder / "OSoundtracks-SA-Expansion-Sounds-NG-Animations-Game.log";
-                    std::ofstream clearHeartbeat(heartbeatLogPath, std::ios::trunc);
-                    clearHeartbeat.close();
-
-                    auto actionsLogPath = folder / "OSoundtracks-SA-Expansion-Sounds-NG-Actions.log";
-                    std::ofstream clearActions(actionsLogPath, std::ios::trunc);
-                    clearActions.close();
-                } catch (...) {
-                }
-            }
+            OpenTailLogs();
 
             fs::path ostimLogPath = paths.primary / "OStim.log";
             bool foundInPrimary = fs::exists(ostimLogPath);
@@ -5233,7 +10437,16 @@ void InitializePlugin() {
         WriteToActionsLog("Monitoring game events: Menu.", __LINE__);
         WriteToActionsLog("", __LINE__);
 
-        if (LoadSoundMappings()) {
+        StopPrefetcher();
+        StopLoudnessAnalyzer();
+        StopMappingsLoader();
+        StopSoundIndexWatcher();
+        StartAudioWorker();
+
+        if (ResolveSoundMappingsPath()) {
+            StartMappingsLoader();
+            StartSoundIndexWatcher();
+
             if (g_usingDllPath) {
                 g_iniPath = g_dllDirectory / "OSoundtracks-SA-Expansion-Sounds-NG.ini";
                 logger::info("Updated INI path to DLL-relative: {}", g_iniPath.string());
@@ -5251,13 +10464,16 @@ void InitializePlugin() {
             LoadIniSettings();
             ProcessBackupUpdate();
             StartIniMonitoring();
+            StartPrefetcher();
+            StartLoudnessAnalyzer();
             
             g_isInitialized = true;
             WriteToSoundPlayerLog("PLUGIN INITIALIZED WITH BASS AUDIO SYSTEM", __LINE__);
             WriteToSoundPlayerLog("Note: BASS streams will be created when animations are detected", __LINE__);
+            StartReplayBenchmark();
         } else {
-            logger::error("Failed to load sound mappings from JSON");
-            WriteToSoundPlayerLog("ERROR: Failed to load sound mappings from JSON", __LINE__);
+            logger::error("Failed to locate sound mappings JSON");
+            WriteToSoundPlayerLog("ERROR: Failed to locate sound mappings JSON", __LINE__);
             g_isInitialized = true;
         }
 
@@ -5297,17 +10513,27 @@ void ShutdownPlugin() {
         g_previewTimerActive = false;
     }
 
+    StopReplayBenchmark();
+    StopPrefetcher();
+    StopLoudnessAnalyzer();
     StopAllSounds();
+    StopAudioWorker();
+    SaveSoundMenuKeyStates();
+    StopNowPlayingNotifier();
     StopMonitoringThread();
     StopIniMonitoring();
+    StopMappingsLoader();
+    StopSoundIndexWatcher();
     StopHeartbeatThread();
+    StopTimedGameTasks();
+    CloseTailLogs();
 
-    if (g_soundPlayerLog.is_open()) {
+    if (g_logWriterActive.load()) {
         WriteToSoundPlayerLog("========================================", __LINE__);
         WriteToSoundPlayerLog("Plugin shutdown complete at: " + GetCurrentTimeString(), __LINE__);
         WriteToSoundPlayerLog("========================================", __LINE__);
-        g_soundPlayerLog.close();
     }
+    StopSoundPlayerLogger();
 
     logger::info("Plugin shutdown complete");
 }
@@ -5321,9 +10547,7 @@ void MessageListener(SKSE::MessagingInterface::Message* message) {
             g_lastOStimLogPosition = 0;
             g_lastFileSize = 0;
             g_processedLines.clear();
-            g_lastAnimation = "";
-            g_currentBaseAnimation = "";
-            g_currentSpecificAnimation = "";
+            ForgetScenes();
             g_firstAnimationDetected = false;
             g_initialDelayComplete = false;
             g_scriptsInitialized = false;
@@ -5331,8 +10555,9 @@ void MessageListener(SKSE::MessagingInterface::Message* message) {
             g_activationMessageShown = false;
             g_pauseMonitoring = false;
             
+            ++g_musicMuteGeneration;
+            g_musicMuter.ReattachAll();
             g_musicTracksCleared = false;
-            g_originalMusicTracks.clear();
             g_gameMusicMuted = false;
 
             WriteToSoundPlayerLog("NEW GAME: All flags reset, ready for fresh initialization", __LINE__);
@@ -5377,6 +10602,12 @@ void MessageListener(SKSE::MessagingInterface::Message* message) {
                 WriteToActionsLog("Event monitoring system active", __LINE__);
             }
 
+            {
+                size_t musicTypes = g_musicMuter.BuildIndex();
+                WriteToSoundPlayerLog("Indexed " + std::to_string(musicTypes) + " music types for game music mute",
+                                      __LINE__);
+            }
+
             logger::info("Running initial sound test...");
             TestPlaySound();
             break;
@@ -0,0 +1,152 @@
+#include "FragmentMatcher.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TestSupport.h"
+
+// FragmentMatcher against the lowercase-and-find loop it replaced in CheckPositionSound,
+// on a library of about 5k fragments, with the timing of both reported.
+
+namespace {
+    std::string Lower(std::string text) {
+        for (auto& ch : text) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        return text;
+    }
+
+    // The old matcher: every fragment lowercased and searched for in the lowercased name.
+    FragmentSet LinearScan(const std::vector<std::string>& fragments, const std::string& name) {
+        FragmentSet matches;
+        matches.Resize(fragments.size());
+        std::string lowerName = Lower(name);
+        for (size_t id = 0; id < fragments.size(); ++id) {
+            if (lowerName.find(Lower(fragments[id])) != std::string::npos) matches.Set(id);
+        }
+        return matches;
+    }
+
+    // Fragments and names shaped like OStim scene and node IDs: mixed-case words joined
+    // by underscores and digits. Fixed seed, so failures reproduce.
+    struct Library {
+        std::vector<std::string> fragments;
+        std::vector<std::string> names;
+    };
+
+    Library MakeLibrary(size_t fragmentCount, size_t nameCount) {
+        std::mt19937 random(1234);
+        const char* words[] = {"Missionary", "Doggy", "Cowgirl", "Kiss", "Hug", "Standing", "Sitting", "Lying",
+                               "BJ", "HJ", "Spoon", "Lift", "Wall", "Bed", "Chair", "Table", "Slow", "Fast",
+                               "Start", "Climax", "Idle", "Intro", "Outro", "Male", "Female", "Mf", "Ff"};
+        auto word = [&] { return std::string(words[random() % std::size(words)]); };
+        auto letters = [&](size_t count) {
+            std::string text;
+            for (size_t i = 0; i < count; ++i) {
+                char ch = static_cast<char>('a' + random() % 26);
+                text += random() % 3 ? ch : static_cast<char>(std::toupper(ch));
+            }
+            return text;
+        };
+
+        Library library;
+        for (size_t i = 0; i < fragmentCount; ++i) {
+            switch (i % 4) {
+                case 0: library.fragments.push_back(word() + "_" + letters(2 + random() % 4)); break;
+                case 1: library.fragments.push_back(letters(3 + random() % 6)); break;
+                case 2: library.fragments.push_back(word() + std::to_string(random() % 10)); break;
+                default: library.fragments.push_back(Lower(word() + word())); break;
+            }
+        }
+        for (size_t i = 0; i < nameCount; ++i) {
+            std::string name = "OStim_" + word() + "_" + word();
+            // Every other name embeds a library fragment with its case flipped.
+            if (i % 2 == 0) {
+                std::string fragment = library.fragments[random() % library.fragments.size()];
+                for (auto& ch : fragment) ch = static_cast<char>(std::isupper(static_cast<unsigned char>(ch))
+                                                                     ? std::tolower(static_cast<unsigned char>(ch))
+                                                                     : std::toupper(static_cast<unsigned char>(ch)));
+                name += "_" + fragment;
+            }
+            name += "_" + letters(4) + std::to_string(i);
+            library.names.push_back(std::move(name));
+        }
+        return library;
+    }
+
+    double MicrosSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST(SmallCases) {
+    std::vector<std::string> fragments = {"he", "she", "his", "hers", "Doggy", "gy_", "x"};
+    FragmentMatcher matcher;
+    matcher.Build(fragments);
+    CHECK(matcher.FragmentCount() == fragments.size());
+
+    for (const char* name : {"ushers", "OStim_DOGGY_3", "doggy_his", "", "nothing", "X"}) {
+        FragmentSet expected = LinearScan(fragments, name);
+        FragmentSet matches;
+        matches.Resize(fragments.size());
+        matcher.Match(name, matches);
+        if (matches.words != expected.words) {
+            std::printf("  mismatch for '%s'\n", name);
+            CHECK(matches.words == expected.words);
+        }
+    }
+
+    FragmentMatcher empty;
+    empty.Build({});
+    FragmentSet none;
+    empty.Match("anything", none);
+    CHECK(none.words.empty());
+}
+
+TEST(FiveThousandFragmentsMatchTheLinearScan) {
+    Library library = MakeLibrary(5000, 1000);
+
+    auto buildStart = std::chrono::steady_clock::now();
+    FragmentMatcher matcher;
+    matcher.Build(library.fragments);
+    double buildMicros = MicrosSince(buildStart);
+
+    std::vector<FragmentSet> expected;
+    expected.reserve(library.names.size());
+    auto linearStart = std::chrono::steady_clock::now();
+    for (const auto& name : library.names) expected.push_back(LinearScan(library.fragments, name));
+    double linearMicros = MicrosSince(linearStart);
+
+    FragmentSet matches;
+    matches.Resize(library.fragments.size());
+    size_t mismatches = 0;
+    size_t matchedNames = 0;
+    double matchMicros = 0.0;
+    for (size_t i = 0; i < library.names.size(); ++i) {
+        matches.Clear();
+        auto matchStart = std::chrono::steady_clock::now();
+        matcher.Match(library.names[i], matches);
+        matchMicros += MicrosSince(matchStart);
+        if (matches.words != expected[i].words) {
+            if (mismatches++ == 0) std::printf("  first mismatch: '%s'\n", library.names[i].c_str());
+        }
+        for (uint64_t word : matches.words) {
+            if (word) {
+                matchedNames++;
+                break;
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+    // The generated names must actually exercise matches, not just agree on nothing.
+    CHECK(matchedNames >= library.names.size() / 2);
+
+    // Reported only; timings on shared machines are too noisy to assert.
+    size_t count = library.names.size();
+    std::printf("  %zu fragments, %zu names (%zu with matches)\n", library.fragments.size(), count, matchedNames);
+    std::printf("  build %.2f ms, automaton %.2f us/name, linear scan %.1f us/name\n", buildMicros / 1000.0,
+                matchMicros / count, linearMicros / count);
+}
+
+int main() { return RunTests(); }
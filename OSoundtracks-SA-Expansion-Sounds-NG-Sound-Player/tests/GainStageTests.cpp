@@ -0,0 +1,185 @@
+#include "GainStage.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "TestSupport.h"
+
+// GainStage: level ramps, the limiter ceiling, and the SSE2 kernels against the scalar
+// loops they replace.
+
+namespace {
+    constexpr uint32_t kSampleRate = 48000;
+
+    std::vector<float> Sine(size_t frames, uint32_t channels, float amplitude, size_t offset = 0) {
+        std::vector<float> samples(frames * channels);
+        for (size_t i = 0; i < frames; ++i) {
+            float v = amplitude * std::sin(static_cast<float>(offset + i) * 0.05f);
+            for (uint32_t c = 0; c < channels; ++c) samples[i * channels + c] = c % 2 ? -v : v;
+        }
+        return samples;
+    }
+
+    // Runs `input` through a fresh stage in blocks of `block` frames, calling
+    // `atFrame(stage, frame)` before each block.
+    template <class Hook>
+    std::vector<float> Run(std::vector<float> input, uint32_t channels, size_t block, float level, Hook atFrame) {
+        GainStage stage;
+        stage.Prepare(kSampleRate, channels);
+        stage.SetLevel(level);
+        size_t frames = input.size() / channels;
+        for (size_t done = 0; done < frames; done += block) {
+            atFrame(stage, done);
+            stage.Process(input.data() + done * channels, std::min(block, frames - done));
+        }
+        return input;
+    }
+
+    float MaxAbs(const std::vector<float>& samples) {
+        float peak = 0.0f;
+        for (float v : samples) peak = std::max(peak, std::fabs(v));
+        return peak;
+    }
+
+    float MaxDiff(const std::vector<float>& a, const std::vector<float>& b) {
+        float diff = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i) diff = std::max(diff, std::fabs(a[i] - b[i]));
+        return diff;
+    }
+}
+
+TEST(LevelAtOrBelowOneIsExactAndAddsNoLatency) {
+    auto input = Sine(4800, 2, 0.9f);
+    auto output = Run(input, 2, 480, 1.0f, [](GainStage&, size_t) {});
+    CHECK(MaxDiff(input, output) == 0.0f);
+
+    GainStage stage;
+    stage.Prepare(kSampleRate, 2);
+    stage.SetLevel(0.5f);
+    CHECK(stage.LatencyFrames() == 0);
+}
+
+TEST(RampIsContinuousAcrossBlocks) {
+    // A constant signal shows the gain curve directly; a level change mid-stream must
+    // glide in equal steps whatever the block size.
+    const size_t frames = 9600;
+    std::vector<float> dc(frames, 0.5f);
+    auto change = [](GainStage& stage, size_t frame) {
+        if (frame >= 1000) stage.SetLevel(0.2f);
+    };
+    auto small = Run(dc, 1, 37, 1.0f, change);
+    auto large = Run(dc, 1, 1000, 1.0f, [](GainStage& stage, size_t frame) {
+        if (frame >= 1000) stage.SetLevel(0.2f);
+    });
+
+    const size_t rampFrames = static_cast<size_t>(kSampleRate * GainStage::kRampMs / 1000.0f);
+    const float step = 0.5f * 0.8f / static_cast<float>(rampFrames);
+    // The 37-frame run sees the change at the first block boundary after frame 1000.
+    size_t start = (1000 + 36) / 37 * 37;
+    float largest = 0.0f;
+    for (size_t i = 1; i < frames; ++i) {
+        CHECK(small[i] <= small[i - 1] + 1e-6f);
+        largest = std::max(largest, small[i - 1] - small[i]);
+    }
+    CHECK(largest <= step * 1.001f);
+    CHECK(std::fabs(small[start - 1] - 0.5f) < 1e-6f);
+    CHECK(std::fabs(small[start + rampFrames] - 0.1f) < 1e-6f);
+    CHECK(std::fabs(small.back() - 0.1f) < 1e-6f);
+
+    // Same curve, shifted by where each run picked the change up.
+    for (size_t i = 0; i + start < frames && i + 1000 < frames; ++i) {
+        CHECK(std::fabs(small[start + i] - large[1000 + i]) < 1e-5f);
+    }
+}
+
+TEST(LimiterHoldsTheCeilingAtLevelTwo) {
+    for (uint32_t channels : {1u, 2u}) {
+        auto output = Run(Sine(48000, channels, 1.0f), channels, 256, 2.0f, [](GainStage&, size_t) {});
+        CHECK(MaxAbs(output) <= LookAheadLimiter::kCeiling + 1e-6f);
+        // Still loud: the limiter pulls peaks down, not the whole signal.
+        CHECK(MaxAbs(output) > LookAheadLimiter::kCeiling * 0.95f);
+    }
+
+    // Engaging mid-stream cross-fades into the limiter without passing the ceiling. The
+    // input stays under it, since at level 1 the stage is bypassed.
+    auto output = Run(Sine(48000, 2, 0.95f), 2, 64, 1.0f, [](GainStage& stage, size_t frame) {
+        if (frame == 6400) stage.SetLevel(2.0f);
+        if (frame == 24000) stage.SetLevel(0.8f);
+    });
+    CHECK(MaxAbs(output) <= LookAheadLimiter::kCeiling + 1e-6f);
+}
+
+TEST(LatencyIsReportedWhileLimiting) {
+    GainStage stage;
+    stage.Prepare(kSampleRate, 2);
+    stage.SetLevel(2.0f);
+    CHECK(stage.LatencyFrames() == static_cast<uint32_t>(kSampleRate * LookAheadLimiter::kLookaheadMs / 1000.0f));
+}
+
+TEST(VectorKernelsMatchScalarLoops) {
+#ifndef OSOUNDTRACKS_GAIN_SSE
+    std::printf("  (SSE2 not available, comparing the scalar build)\n");
+#endif
+    // Odd frame count so the scalar tail after the vector loop is covered too.
+    const size_t frames = 1027;
+    for (uint32_t channels : {1u, 2u}) {
+        auto input = Sine(frames, channels, 1.3f);
+        std::vector<float> gains(frames);
+        for (size_t i = 0; i < frames; ++i) gains[i] = 1.0f - static_cast<float>(i) / frames;
+
+        auto ramp = input;
+        auto rampExpected = input;
+        ApplyGainRamp(ramp.data(), frames, channels, 0.25f, 0.001f);
+        for (size_t i = 0; i < frames; ++i) {
+            float gain = 0.25f + 0.001f * static_cast<float>(i);
+            for (uint32_t c = 0; c < channels; ++c) rampExpected[i * channels + c] *= gain;
+        }
+        CHECK(MaxDiff(ramp, rampExpected) == 0.0f);
+
+        auto curve = input;
+        auto curveExpected = input;
+        ApplyGainCurve(curve.data(), frames, channels, gains.data());
+        for (size_t i = 0; i < frames; ++i) {
+            for (uint32_t c = 0; c < channels; ++c) curveExpected[i * channels + c] *= gains[i];
+        }
+        CHECK(MaxDiff(curve, curveExpected) == 0.0f);
+
+        std::vector<float> peaks(frames);
+        std::vector<float> peaksExpected(frames, 0.0f);
+        FramePeaks(input.data(), frames, channels, peaks.data());
+        for (size_t i = 0; i < frames; ++i) {
+            for (uint32_t c = 0; c < channels; ++c) {
+                peaksExpected[i] = std::max(peaksExpected[i], std::fabs(input[i * channels + c]));
+            }
+        }
+        CHECK(MaxDiff(peaks, peaksExpected) == 0.0f);
+    }
+}
+
+TEST(Throughput) {
+    // Ten seconds of stereo through the limiter (level 2) and the plain gain (level 0.5),
+    // in mixer-sized blocks. Reported only; timings on shared machines are too noisy to assert.
+    const size_t block = 512;
+    const size_t frames = kSampleRate * 10;
+    for (float level : {2.0f, 0.5f}) {
+        GainStage stage;
+        stage.Prepare(kSampleRate, 2);
+        stage.SetLevel(level);
+        auto input = Sine(block, 2, 1.0f);
+        auto buffer = input;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t done = 0; done < frames; done += block) {
+            buffer = input;
+            stage.Process(buffer.data(), block);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double framesPerSecond = frames / std::max(seconds, 1e-9);
+        std::printf("  level %.1f: %.1f Mframes/s (%.0fx realtime)\n", level, framesPerSecond / 1e6,
+                    framesPerSecond / kSampleRate);
+    }
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,117 @@
+#include "GameMusic.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "TestSupport.h"
+
+// MusicMuter against a fake game: mute, restore, double mute and re-indexing.
+
+namespace {
+    // Music types are plain track lists. Detach swaps a type's list with an empty one
+    // kept aside, like the plugin does with the BSTArray, and counts contract breaks.
+    class FakeGameMusic : public IGameMusic {
+    public:
+        explicit FakeGameMusic(std::vector<std::vector<int>> types) : types(std::move(types)) {}
+
+        size_t IndexMusicTypes() override {
+            indexCalls++;
+            aside.assign(types.size(), {});
+            held.assign(types.size(), false);
+            return types.size();
+        }
+
+        size_t TrackCount(size_t type) const override { return types[type].size(); }
+
+        void DetachTracks(size_t type) override {
+            if (held[type]) misuse++;
+            types[type].swap(aside[type]);
+            held[type] = true;
+        }
+
+        void ReattachTracks(size_t type) override {
+            if (!held[type]) misuse++;
+            types[type].swap(aside[type]);
+            held[type] = false;
+        }
+
+        std::vector<std::vector<int>> types;
+        std::vector<std::vector<int>> aside;
+        std::vector<bool> held;
+        int indexCalls = 0;
+        int misuse = 0;
+    };
+}
+
+TEST(MuteEmptiesTypesWithTracksAndRestoreBringsThemBack) {
+    std::vector<std::vector<int>> original = {{1, 2}, {}, {3}, {4, 5, 6}};
+    FakeGameMusic game(original);
+    MusicMuter muter(game);
+    CHECK(muter.BuildIndex() == 4);
+
+    auto counts = muter.DetachAll();
+    CHECK(counts.muted == 3);
+    CHECK(counts.skipped == 1);
+    CHECK(muter.IsMuted());
+    for (const auto& tracks : game.types) CHECK(tracks.empty());
+
+    CHECK(muter.ReattachAll() == 3);
+    CHECK(!muter.IsMuted());
+    CHECK(game.types == original);
+    CHECK(game.misuse == 0);
+}
+
+TEST(DoubleMuteKeepsTheOriginalTracks) {
+    std::vector<std::vector<int>> original = {{1}, {2, 3}};
+    FakeGameMusic game(original);
+    MusicMuter muter(game);
+    muter.BuildIndex();
+
+    CHECK(muter.DetachAll().muted == 2);
+    // A second mute would otherwise set the empty arrays aside and lose the tracks.
+    auto again = muter.DetachAll();
+    CHECK(again.muted == 0);
+    CHECK(again.skipped == 0);
+
+    CHECK(muter.ReattachAll() == 2);
+    CHECK(muter.ReattachAll() == 0);
+    CHECK(game.types == original);
+    CHECK(game.misuse == 0);
+}
+
+TEST(ReindexWhileMutedRestoresFirst) {
+    std::vector<std::vector<int>> original = {{1}, {2}};
+    FakeGameMusic game(original);
+    MusicMuter muter(game);
+    muter.BuildIndex();
+    muter.DetachAll();
+
+    // A new data load: the old positions are restored before the list is rebuilt.
+    CHECK(muter.BuildIndex() == 2);
+    CHECK(!muter.IsMuted());
+    CHECK(game.types == original);
+    CHECK(game.indexCalls == 2);
+
+    // The new index picks up types added since.
+    game.types.push_back({7, 8});
+    CHECK(muter.BuildIndex() == 3);
+    CHECK(muter.DetachAll().muted == 3);
+    CHECK(muter.ReattachAll() == 3);
+    CHECK(game.types[2] == std::vector<int>({7, 8}));
+    CHECK(game.misuse == 0);
+}
+
+TEST(MuteBeforeIndexBuildsItOnce) {
+    FakeGameMusic game({{1}, {}});
+    MusicMuter muter(game);
+
+    CHECK(muter.DetachAll().muted == 1);
+    CHECK(muter.IndexedTypes() == 2);
+    muter.ReattachAll();
+    muter.DetachAll();
+    muter.ReattachAll();
+    CHECK(game.indexCalls == 1);
+    CHECK(game.misuse == 0);
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,119 @@
+#include "LoudnessMeter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "TestSupport.h"
+
+// LoudnessMeter against the EBU Tech 3341 reference signals: integrated loudness of a
+// steady tone, the absolute and relative gates, channel weights, and true peak.
+
+namespace {
+    constexpr uint32_t kSampleRate = 48000;
+    constexpr double kPi = 3.14159265358979323846;
+
+    // `seconds` of a sine at `frequency` and `dbfs` peak on the channels in `active`
+    // (bit per channel), silence on the others, fed in 1000-frame blocks.
+    void Feed(LoudnessMeter& meter, uint32_t channels, uint32_t active, double frequency, double dbfs,
+              double seconds, double phase = 0.0) {
+        const double amplitude = std::pow(10.0, dbfs / 20.0);
+        const size_t frames = static_cast<size_t>(seconds * kSampleRate);
+        std::vector<float> block;
+        for (size_t done = 0; done < frames; done += 1000) {
+            size_t count = std::min<size_t>(1000, frames - done);
+            block.assign(count * channels, 0.0f);
+            for (size_t i = 0; i < count; ++i) {
+                double t = static_cast<double>(done + i) / kSampleRate;
+                float v = static_cast<float>(amplitude * std::sin(2.0 * kPi * frequency * t + phase));
+                for (uint32_t c = 0; c < channels; ++c) {
+                    if (active & (1u << c)) block[i * channels + c] = v;
+                }
+            }
+            meter.Add(block.data(), count);
+        }
+    }
+
+    void FeedSilence(LoudnessMeter& meter, uint32_t channels, double seconds) {
+        Feed(meter, channels, 0, 1000.0, 0.0, seconds);
+    }
+
+    bool Near(double value, double expected, double tolerance) {
+        if (std::fabs(value - expected) <= tolerance) return true;
+        std::printf("  %.3f, expected %.3f +- %.3f\n", value, expected, tolerance);
+        return false;
+    }
+}
+
+TEST(StereoSineMatchesTheEbuReference) {
+    // Tech 3341 case 1: 1 kHz stereo sine at -23 dBFS reads -23.0 LUFS (+-0.1). The
+    // meter is linear, so -20 dBFS reads -20.0.
+    for (double dbfs : {-23.0, -20.0}) {
+        LoudnessMeter meter;
+        CHECK(meter.Prepare(kSampleRate, 2));
+        Feed(meter, 2, 0b11, 1000.0, dbfs, 20.0);
+        CHECK(Near(meter.IntegratedLufs(), dbfs, 0.1));
+    }
+}
+
+TEST(MonoCountsAsDualMono) {
+    LoudnessMeter meter;
+    CHECK(meter.Prepare(kSampleRate, 1));
+    Feed(meter, 1, 0b1, 1000.0, -23.0, 20.0);
+    CHECK(Near(meter.IntegratedLufs(), -23.0, 0.1));
+}
+
+TEST(SilenceIsGated) {
+    LoudnessMeter meter;
+    CHECK(meter.Prepare(kSampleRate, 2));
+    FeedSilence(meter, 2, 5.0);
+    CHECK(meter.IntegratedLufs() == LoudnessMeter::kSilence);
+
+    // Tech 3341 case 4: the -72 dBFS parts fall under the absolute gate, the -36 dBFS
+    // parts under the relative one, and silence around it all changes nothing.
+    CHECK(meter.Prepare(kSampleRate, 2));
+    FeedSilence(meter, 2, 5.0);
+    Feed(meter, 2, 0b11, 1000.0, -72.0, 10.0);
+    Feed(meter, 2, 0b11, 1000.0, -36.0, 10.0);
+    Feed(meter, 2, 0b11, 1000.0, -23.0, 60.0);
+    Feed(meter, 2, 0b11, 1000.0, -36.0, 10.0);
+    Feed(meter, 2, 0b11, 1000.0, -72.0, 10.0);
+    FeedSilence(meter, 2, 5.0);
+    CHECK(Near(meter.IntegratedLufs(), -23.0, 0.1));
+}
+
+TEST(SurroundChannelsAreWeighted) {
+    // 5.1 in WAVE order: L R C LFE Ls Rs.
+    auto measure = [](uint32_t active) {
+        LoudnessMeter meter;
+        CHECK(meter.Prepare(kSampleRate, 6));
+        Feed(meter, 6, active, 1000.0, -20.0, 5.0);
+        return meter.IntegratedLufs();
+    };
+    double front = measure(0b000001);
+    double surround = measure(0b010000);
+    CHECK(Near(surround - front, 10.0 * std::log10(1.41), 0.01));
+    CHECK(measure(0b001000) == LoudnessMeter::kSilence);
+
+    LoudnessMeter meter;
+    CHECK(!meter.Prepare(kSampleRate, 9));
+    CHECK(!meter.Prepare(kSampleRate, 0));
+}
+
+TEST(TruePeakFindsTheInterSampleOvershoot) {
+    // A sine at a quarter of the sample rate, 45 degrees off the sample grid: every
+    // sample sits at 0.707 of the amplitude, the peaks fall between samples.
+    LoudnessMeter meter;
+    CHECK(meter.Prepare(kSampleRate, 2));
+    Feed(meter, 2, 0b11, kSampleRate / 4.0, -6.0, 1.0, kPi / 4.0);
+    double samplePeak = -6.0 + 20.0 * std::log10(std::sqrt(0.5));
+    std::printf("  sample peak %.2f dBFS, true peak %.2f dBTP\n", samplePeak, meter.TruePeakDb());
+    CHECK(Near(meter.TruePeakDb(), -6.0, 0.5));
+    CHECK(meter.TruePeakDb() > samplePeak + 2.5);
+
+    CHECK(meter.Prepare(kSampleRate, 2));
+    FeedSilence(meter, 2, 1.0);
+    CHECK(std::isinf(meter.TruePeakDb()) && meter.TruePeakDb() < 0.0);
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,235 @@
+#include "AudioBackend.h"
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "TestSupport.h"
+
+// OfflineAudioBackend driven by hand (realtime = false): end syncs chain the next
+// stream frame-exactly, volume slides are linear, and a fade-out pause holds the
+// position, as the transition and group pause code expect.
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr uint32_t kSampleRate = 48000;
+
+    fs::path TestDir() {
+        fs::path dir = fs::temp_directory_path() / "osoundtracks-offline-tests";
+        fs::create_directories(dir);
+        return dir;
+    }
+
+    // Writes interleaved float samples as a WAV file.
+    fs::path WriteSamples(const char* name, const std::vector<float>& samples, uint16_t channels) {
+        fs::path file = TestDir() / name;
+        std::ofstream out(file, std::ios::binary);
+        auto put16 = [&](uint16_t v) { out.write(reinterpret_cast<const char*>(&v), 2); };
+        auto put32 = [&](uint32_t v) { out.write(reinterpret_cast<const char*>(&v), 4); };
+        uint32_t bytes = static_cast<uint32_t>(samples.size() * sizeof(float));
+        out.write("RIFF", 4);
+        put32(36 + bytes);
+        out.write("WAVEfmt ", 8);
+        put32(16);
+        put16(3);
+        put16(channels);
+        put32(kSampleRate);
+        put32(kSampleRate * channels * sizeof(float));
+        put16(static_cast<uint16_t>(channels * sizeof(float)));
+        put16(32);
+        out.write("data", 4);
+        put32(bytes);
+        out.write(reinterpret_cast<const char*>(samples.data()), bytes);
+        return file;
+    }
+
+    // A clip whose every frame is `frame` (one value per channel).
+    fs::path WriteClip(const char* name, const std::vector<float>& frame, size_t frames) {
+        std::vector<float> samples;
+        samples.reserve(frame.size() * frames);
+        for (size_t i = 0; i < frames; ++i) samples.insert(samples.end(), frame.begin(), frame.end());
+        return WriteSamples(name, samples, static_cast<uint16_t>(frame.size()));
+    }
+
+    // The stereo output of a finished render, interleaved.
+    std::vector<float> ReadRender(const fs::path& file) {
+        std::ifstream in(file, std::ios::binary);
+        in.seekg(0, std::ios::end);
+        size_t bytes = static_cast<size_t>(in.tellg()) - 44;
+        std::vector<float> samples(bytes / sizeof(float));
+        in.seekg(44);
+        in.read(reinterpret_cast<char*>(samples.data()), static_cast<std::streamsize>(samples.size() * sizeof(float)));
+        return samples;
+    }
+
+    // Sync callbacks are plain function pointers, so the chained test keeps its state here.
+    OfflineAudioBackend* g_backend = nullptr;
+    AudioHandle g_next = 0;
+    uint64_t g_endedAt = 0;
+
+    void StartNext(AudioHandle) {
+        g_endedAt = g_backend->RenderedFrames();
+        g_backend->Play(g_next);
+    }
+
+    // Renders clip A (1000 frames of 0.25) followed from its end sync by clip B (0.5),
+    // with A at the given level, and returns the left channel.
+    std::vector<float> RenderChain(float level) {
+        fs::path output = TestDir() / "chain.wav";
+        OfflineAudioBackend backend(output, kSampleRate, false);
+        CHECK(backend.Initialize());
+        g_backend = &backend;
+
+        AudioHandle first = backend.OpenStream(WriteClip("a.wav", {0.25f}, 1000), false);
+        g_next = backend.OpenStream(WriteClip("b.wav", {0.5f}, 1000), false);
+        CHECK(first != 0 && g_next != 0);
+        backend.SetLevel(first, level);
+        CHECK(backend.SyncEnd(first, StartNext));
+        backend.Play(first);
+        g_endedAt = 0;
+        backend.Render(3000);
+        backend.Shutdown();
+        g_backend = nullptr;
+
+        auto stereo = ReadRender(output);
+        std::vector<float> left(stereo.size() / 2);
+        for (size_t i = 0; i < left.size(); ++i) left[i] = stereo[i * 2];
+        return left;
+    }
+}
+
+TEST(EndSyncStartsTheNextStreamOnTheFollowingFrame) {
+    auto left = RenderChain(1.0f);
+    CHECK(left.size() == 3000);
+    CHECK(g_endedAt == 1000);
+    for (size_t i = 0; i < left.size(); ++i) {
+        float expected = i < 1000 ? 0.25f : i < 2000 ? 0.5f : 0.0f;
+        if (left[i] != expected) {
+            std::printf("  frame %zu: %f, expected %f\n", i, left[i], expected);
+            CHECK(left[i] == expected);
+            break;
+        }
+    }
+}
+
+TEST(EndSyncWaitsForTheLimiterDelay) {
+    // Above 100% the limiter delays the stream by its look-ahead; the tail is flushed
+    // and the end sync fires after it, so the next stream still follows without overlap.
+    const size_t latency = static_cast<size_t>(kSampleRate * LookAheadLimiter::kLookaheadMs / 1000.0f);
+    auto left = RenderChain(2.0f);
+    CHECK(g_endedAt == 1000 + latency);
+    CHECK(left[latency - 1] == 0.0f);
+    CHECK(left[1000 + latency - 1] > 0.0f);
+    CHECK(left[1000 + latency] == 0.5f);
+    CHECK(left[2000 + latency - 1] == 0.5f);
+    CHECK(left[2000 + latency] == 0.0f);
+}
+
+TEST(CrossfadeSlidesAreLinear) {
+    // A on the left and B on the right, so each channel shows one voice's volume.
+    fs::path output = TestDir() / "crossfade.wav";
+    OfflineAudioBackend backend(output, kSampleRate, false);
+    CHECK(backend.Initialize());
+    AudioHandle outgoing = backend.OpenStream(WriteClip("left.wav", {0.5f, 0.0f}, 4800), true);
+    AudioHandle incoming = backend.OpenStream(WriteClip("right.wav", {0.0f, 0.5f}, 4800), true);
+
+    backend.Play(outgoing);
+    backend.Render(1000);
+    const uint32_t fadeMs = 100;
+    const size_t fadeFrames = kSampleRate * fadeMs / 1000;
+    backend.FadeOutAndFree(outgoing, fadeMs);
+    backend.SetVolume(incoming, 0.0f);
+    backend.Play(incoming);
+    backend.SlideVolume(incoming, 1.0f, fadeMs);
+    backend.Render(fadeFrames + 1000);
+    CHECK(backend.Activity(outgoing) == AudioActivity::Stopped);
+    CHECK(backend.Activity(incoming) == AudioActivity::Playing);
+    backend.Shutdown();
+
+    auto stereo = ReadRender(output);
+    CHECK(stereo.size() == (fadeFrames + 2000) * 2);
+    const float step = 0.5f / static_cast<float>(fadeFrames);
+    float worst = 0.0f;
+    for (size_t i = 0; i < fadeFrames; ++i) {
+        float left = stereo[(1000 + i) * 2];
+        float right = stereo[(1000 + i) * 2 + 1];
+        worst = std::max(worst, std::fabs(left - (0.5f - step * static_cast<float>(i))));
+        worst = std::max(worst, std::fabs(right - step * static_cast<float>(i)));
+        worst = std::max(worst, std::fabs(left + right - 0.5f));
+    }
+    // The volume advances by one float step per frame, so rounding adds up over the
+    // fade; 1e-4 is still far below anything audible.
+    CHECK(worst < 1e-4f);
+    CHECK(stereo[(1000 + fadeFrames) * 2] == 0.0f);
+    CHECK(stereo[(1000 + fadeFrames) * 2 + 1] == 0.5f);
+}
+
+TEST(FadeOutAndPauseKeepsThePosition) {
+    // Mono clip whose value encodes the frame, so the output shows both the volume and
+    // where in the clip playback is.
+    const size_t clipFrames = 8000;
+    auto source = [](size_t frame) { return 0.1f + static_cast<float>(frame) * 1e-5f; };
+    std::vector<float> samples(clipFrames);
+    for (size_t i = 0; i < clipFrames; ++i) samples[i] = source(i);
+
+    fs::path output = TestDir() / "pause.wav";
+    OfflineAudioBackend backend(output, kSampleRate, false);
+    CHECK(backend.Initialize());
+    AudioHandle stream = backend.OpenStream(WriteSamples("ramp.wav", samples, 1), false);
+    CHECK(stream != 0);
+
+    backend.Play(stream);
+    backend.Render(1000);
+    const uint32_t fadeMs = 50;
+    const size_t fadeFrames = kSampleRate * fadeMs / 1000;
+    backend.FadeOutAndPause(stream, fadeMs);
+    backend.Render(fadeFrames);
+    CHECK(backend.Activity(stream) == AudioActivity::Paused);
+    const double pausedAt = backend.Position(stream);
+    CHECK(std::fabs(pausedAt - static_cast<double>(1000 + fadeFrames) / kSampleRate) < 1e-9);
+
+    // Paused: silence, and the clip does not move.
+    backend.Render(500);
+    CHECK(backend.Activity(stream) == AudioActivity::Paused);
+    CHECK(backend.Position(stream) == pausedAt);
+
+    // Resuming at the level the fade left gives silence while the clip moves on; the
+    // group resume then ramps back up from there.
+    backend.Play(stream);
+    backend.Render(100);
+    backend.SetVolume(stream, 1.0f);
+    backend.Render(100);
+    CHECK(backend.Activity(stream) == AudioActivity::Playing);
+    backend.Shutdown();
+
+    auto stereo = ReadRender(output);
+    CHECK(stereo.size() == (1000 + fadeFrames + 700) * 2);
+    const float step = 1.0f / static_cast<float>(fadeFrames);
+    float worst = 0.0f;
+    for (size_t i = 0; i < fadeFrames; ++i) {
+        float volume = stereo[(1000 + i) * 2] / source(1000 + i);
+        worst = std::max(worst, std::fabs(volume - (1.0f - step * static_cast<float>(i))));
+    }
+    CHECK(worst < 1e-4f);
+    CHECK(stereo[(1000 + fadeFrames - 1) * 2] < source(1000 + fadeFrames) * step * 1.01f);
+    for (size_t i = 1000 + fadeFrames; i < 1000 + fadeFrames + 600; ++i) {
+        if (stereo[i * 2] != 0.0f) {
+            std::printf("  frame %zu: %f, expected silence\n", i, stereo[i * 2]);
+            CHECK(stereo[i * 2] == 0.0f);
+            break;
+        }
+    }
+    // The first audible frame after the resume is the one after the 100 silent ones.
+    size_t resumed = 1000 + fadeFrames + 600;
+    CHECK(stereo[resumed * 2] == source(1000 + fadeFrames + 100));
+}
+
+int main() {
+    int result = RunTests();
+    std::error_code ec;
+    fs::remove_all(TestDir(), ec);
+    return result;
+}
@@ -0,0 +1,115 @@
+#include "PlaylistEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "TestSupport.h"
+
+// PlaylistEngine: the shuffle is a permutation per cycle at any size, the no-repeat
+// window holds across cycle boundaries, and weighted draws follow the weights.
+
+namespace {
+    // Sizes around powers of two, where the Feistel domain is widest relative to the
+    // playlist and cycle-walking does the most work.
+    constexpr uint32_t kSizes[] = {1, 2, 3, 5, 7, 10, 17, 63, 65, 100, 257, 1000, 1025};
+}
+
+TEST(ShuffleVisitsEveryTrackOncePerCycle) {
+    for (uint32_t size : kSizes) {
+        for (uint64_t seed : {1ull, 42ull, 0x9E3779B97F4A7C15ull}) {
+            PlaylistEngine engine;
+            engine.Reset(size, PlaylistOrder::Shuffle, seed, 0);
+            size_t sameOrder = 0;
+            for (int cycle = 0; cycle < 4; ++cycle) {
+                std::vector<int> seen(size, 0);
+                bool inOrder = true;
+                for (uint32_t i = 0; i < size; ++i) {
+                    uint32_t id = engine.Next();
+                    CHECK(id < size);
+                    if (id < size) seen[id]++;
+                    inOrder = inOrder && id == i;
+                }
+                bool bijection = true;
+                for (int count : seen) bijection = bijection && count == 1;
+                if (!bijection) {
+                    std::printf("  size %u seed %llu cycle %d is not a permutation\n", size,
+                                static_cast<unsigned long long>(seed), cycle);
+                    CHECK(bijection);
+                }
+                if (inOrder) sameOrder++;
+            }
+            // Anything but tiny playlists must actually be shuffled.
+            if (size >= 10) CHECK(sameOrder == 0);
+        }
+    }
+}
+
+TEST(ShuffleResumesFromTheCursor) {
+    PlaylistEngine engine;
+    engine.Reset(100, PlaylistOrder::Shuffle, 7, 4);
+    for (int i = 0; i < 150; ++i) engine.Next();
+    PlaylistEngine resumed;
+    resumed.Reset(100, PlaylistOrder::Shuffle, 7, 4);
+    resumed.Restore(engine.Cursor());
+    for (int i = 0; i < 200; ++i) CHECK(resumed.Next() == engine.Next());
+}
+
+TEST(NoTrackRepeatsWithinTheWindow) {
+    for (PlaylistOrder order : {PlaylistOrder::Shuffle, PlaylistOrder::Weighted}) {
+        for (uint32_t size : {4u, 10u, 17u, 48u, 100u}) {
+            for (uint32_t window : {1u, 3u, 8u, PlaylistEngine::kMaxNoRepeat}) {
+                // Shuffle limits the window to a third of the playlist so every cycle can
+                // still be fixed up; weighted draws can use all but one track.
+                uint32_t effective = order == PlaylistOrder::Shuffle ? std::min(window, size / 3)
+                                                                     : std::min(window, size - 1);
+                std::vector<double> weights(size);
+                for (uint32_t i = 0; i < size; ++i) weights[i] = 1.0 + (i % 5) * 3.0;
+
+                PlaylistEngine engine;
+                engine.Reset(size, order, 1234 + size, window, weights);
+                std::vector<uint32_t> played;
+                size_t violations = 0;
+                for (uint32_t i = 0; i < size * 20; ++i) {
+                    uint32_t id = engine.Next();
+                    size_t from = played.size() - std::min<size_t>(effective, played.size());
+                    for (size_t j = from; j < played.size(); ++j) {
+                        if (played[j] == id) violations++;
+                    }
+                    played.push_back(id);
+                }
+                if (violations) {
+                    std::printf("  %s size %u window %u: %zu repeats\n",
+                                order == PlaylistOrder::Shuffle ? "shuffle" : "weighted", size, window, violations);
+                    CHECK(violations == 0);
+                }
+            }
+        }
+    }
+}
+
+TEST(WeightedPicksFollowTheWeights) {
+    const std::vector<double> weights = {1.0, 2.0, 3.0, 4.0, 0.0, 10.0, 0.5};
+    double total = 0.0;
+    for (double weight : weights) total += weight;
+
+    PlaylistEngine engine;
+    engine.Reset(static_cast<uint32_t>(weights.size()), PlaylistOrder::Weighted, 99, 0, weights);
+    const size_t draws = 200000;
+    std::vector<size_t> counts(weights.size(), 0);
+    for (size_t i = 0; i < draws; ++i) counts[engine.Next()]++;
+
+    for (size_t id = 0; id < weights.size(); ++id) {
+        double expected = weights[id] / total;
+        double observed = static_cast<double>(counts[id]) / draws;
+        // Binomial standard deviation is at most 0.0011 here; allow about 4 of them.
+        if (std::fabs(observed - expected) > 0.005) {
+            std::printf("  track %zu: %.4f of draws, expected %.4f\n", id, observed, expected);
+            CHECK(std::fabs(observed - expected) <= 0.005);
+        }
+    }
+    CHECK(counts[4] == 0);
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Minimal test runner shared by the test executables: TEST registers a case, CHECK
+// records a failure and lets the case continue, and RunTests returns the exit code.
+struct TestCase {
+    const char* name;
+    std::function<void()> body;
+};
+
+inline std::vector<TestCase>& TestRegistry() {
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+inline int& TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, std::function<void()> body) { TestRegistry().push_back({name, std::move(body)}); }
+};
+
+#define TEST(name)                                               \
+    static void name();                                          \
+    static TestRegistrar name##_registrar(#name, name);          \
+    static void name()
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);      \
+            ++TestFailures();                                                         \
+        }                                                                             \
+    } while (0)
+
+inline int RunTests() {
+    for (const TestCase& test : TestRegistry()) {
+        int before = TestFailures();
+        std::printf("%s\n", test.name);
+        test.body();
+        std::printf("  %s\n", TestFailures() == before ? "ok" : "FAILED");
+    }
+    std::printf("%zu tests, %d failed checks\n", TestRegistry().size(), TestFailures());
+    return TestFailures() == 0 ? 0 : 1;
+}